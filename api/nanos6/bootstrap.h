@@ -52,6 +52,20 @@ void nanos6_init(void);
 // This function is used to shut down the runtime
 void nanos6_shutdown(void);
 
+//! \brief Check whether this process must run the main function
+//! 
+//! In cluster mode only the master node runs main. The rest of nodes only run
+//! the tasks that are offloaded to them until the master node finishes.
+//! 
+//! \returns true if this process must run the main function
+int nanos6_can_run_main(void);
+
+//! \brief Register a function that the runtime calls when a process that does not run main must finish
+//! 
+//! \param[in] completion_callback the function to call
+//! \param[in] completion_args a parameter that is passed to the completion callback
+void nanos6_register_completion_callback(void (*completion_callback)(void *), void *completion_args);
+
 //! \brief Initialize memory interception
 //! 
 //! This function initializes the memory allocation interception. The first parameter contains the original
@@ -0,0 +1,89 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef NANOS6_CLUSTER_H
+#define NANOS6_CLUSTER_H
+
+#include <stddef.h>
+
+#include "major.h"
+
+
+#pragma GCC visibility push(default)
+
+
+// NOTE: The full version depends also on nanos6_major_api
+//       That is:   nanos6_major_api . nanos6_cluster_api
+enum nanos6_cluster_api_t { nanos6_cluster_api = 1 };
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! \brief How the memory of a distributed allocation is spread among the cluster nodes
+typedef enum {
+	//! \brief Each node holds one contiguous block of roughly the same size
+	nanos6_block_distribution = 0,
+	
+	//! \brief Consecutive pages belong to consecutive nodes
+	nanos6_cyclic_distribution,
+	
+	//! \brief Consecutive blocks of a given size belong to consecutive nodes
+	nanos6_cyclic_block_distribution
+} nanos6_data_distribution_t;
+
+
+//! \brief Allocate memory that is distributed among the cluster nodes
+//!
+//! The memory is at the same addresses in all the nodes, so it can be
+//! accessed by the tasks that run on any of them. Each part of it has a
+//! home node, given by the distribution policy, which the runtime uses to
+//! decide where the tasks that access it run.
+//!
+//! It can only be called from the master node. Without cluster support it
+//! is equivalent to malloc.
+//!
+//! \param[in] size the size of the allocation in bytes
+//! \param[in] policy how the memory is spread among the nodes
+//! \param[in] block_size the size of the blocks of the
+//! nanos6_cyclic_block_distribution policy, ignored by the rest
+//!
+//! \returns the start of the allocation, or NULL if there is no memory left
+void *nanos6_dmalloc(size_t size, nanos6_data_distribution_t policy, size_t block_size);
+
+//! \brief Release an allocation of nanos6_dmalloc
+//!
+//! \param[in] ptr the start of the allocation
+//! \param[in] size the size that was passed to nanos6_dmalloc
+void nanos6_dfree(void *ptr, size_t size);
+
+//! \brief Allocate memory whose home is the current cluster node
+//!
+//! Like the distributed memory, it can be accessed by the tasks that run
+//! on any node. Without cluster support it is equivalent to malloc.
+//!
+//! \param[in] size the size of the allocation in bytes
+//!
+//! \returns the start of the allocation, or NULL if there is no memory left
+void *nanos6_lmalloc(size_t size);
+
+//! \brief Release an allocation of nanos6_lmalloc
+//!
+//! \param[in] ptr the start of the allocation
+//! \param[in] size the size that was passed to nanos6_lmalloc
+void nanos6_lfree(void *ptr, size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#pragma GCC visibility pop
+
+
+#endif /* NANOS6_CLUSTER_H */
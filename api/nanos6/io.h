@@ -0,0 +1,72 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef NANOS6_IO_H
+#define NANOS6_IO_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "major.h"
+
+
+#pragma GCC visibility push(default)
+
+
+// NOTE: The full version depends also on nanos6_major_api
+//       That is:   nanos6_major_api . nanos6_io_api
+enum nanos6_io_api_t { nanos6_io_api = 1 };
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! \brief Read from a file without blocking the current task
+//!
+//! Starts reading size bytes at the given offset of the file into the
+//! buffer and returns right away. The task can finish its body before the
+//! read completes, but its dependencies are not released until then. Hence,
+//! the successor tasks can use the data, but the task itself must not.
+//!
+//! The buffer must remain valid until the read completes. When called
+//! outside of a task, or if the runtime cannot submit the request
+//! asynchronously, the read is performed before returning.
+//!
+//! \param[in] fd the file descriptor
+//! \param[out] buffer where to store the data
+//! \param[in] size the number of bytes to read
+//! \param[in] offset the position in the file
+//! \param[out] result if not NULL, it receives the value that pread would
+//! have returned, or minus the error number if it failed, once the read
+//! has completed
+void nanos6_io_read(int fd, void *buffer, size_t size, off_t offset, ssize_t *result);
+
+//! \brief Write to a file without blocking the current task
+//!
+//! Like nanos6_io_read, but it writes size bytes from the buffer at the
+//! given offset of the file. The buffer must not be modified until the
+//! write completes, that is, until the successors of the task run.
+//!
+//! \param[in] fd the file descriptor
+//! \param[in] buffer the data to write
+//! \param[in] size the number of bytes to write
+//! \param[in] offset the position in the file
+//! \param[out] result if not NULL, it receives the value that pwrite would
+//! have returned, or minus the error number if it failed, once the write
+//! has completed
+void nanos6_io_write(int fd, void const *buffer, size_t size, off_t offset, ssize_t *result);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#pragma GCC visibility pop
+
+
+#endif /* NANOS6_IO_H */
@@ -0,0 +1,83 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef NANOS6_NUMA_H
+#define NANOS6_NUMA_H
+
+#include <stddef.h>
+
+#include "major.h"
+
+
+#pragma GCC visibility push(default)
+
+
+// NOTE: The full version depends also on nanos6_major_api
+//       That is:   nanos6_major_api . nanos6_numa_api
+enum nanos6_numa_api_t { nanos6_numa_api = 1 };
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//! \brief How the memory of an allocation is placed among the NUMA nodes
+typedef enum {
+	//! \brief All the memory is placed in the NUMA node of the CPU that allocates it
+	nanos6_numa_local_policy = 0,
+	
+	//! \brief All the memory is placed in a given NUMA node
+	nanos6_numa_node_policy,
+	
+	//! \brief Consecutive pages are placed in consecutive NUMA nodes
+	nanos6_numa_interleaved_policy,
+	
+	//! \brief Consecutive blocks of a given size are placed in consecutive NUMA nodes
+	nanos6_numa_block_policy
+} nanos6_numa_policy_t;
+
+
+//! \brief Allocate memory placed in the NUMA nodes according to a policy
+//!
+//! The runtime keeps track of the NUMA node of each part of the allocation,
+//! so the NUMA-aware schedulers can run the tasks close to their data. The
+//! NUMA nodes are numbered as in the runtime information, from 0 to the
+//! number of NUMA nodes minus 1.
+//!
+//! \param[in] size the size of the allocation in bytes
+//! \param[in] policy how the memory is placed among the NUMA nodes
+//! \param[in] node the NUMA node of the nanos6_numa_node_policy, ignored by the rest
+//! \param[in] block_size the size of the blocks of the nanos6_numa_block_policy,
+//! which is rounded up to the page size, ignored by the rest
+//!
+//! \returns the start of the allocation, or NULL if there is no memory left
+void *nanos6_numa_alloc(size_t size, nanos6_numa_policy_t policy, size_t node, size_t block_size);
+
+//! \brief Release an allocation of nanos6_numa_alloc
+//!
+//! \param[in] ptr the start of the allocation
+void nanos6_numa_free(void *ptr);
+
+//! \brief Get the NUMA node in which an address of an allocation of nanos6_numa_alloc is placed
+//!
+//! \param[in] address the address
+//!
+//! \returns the NUMA node, or -1 if the address does not belong to an allocation of nanos6_numa_alloc
+int nanos6_numa_get_home_node(void const *address);
+
+//! \brief Get the number of NUMA nodes that the runtime uses
+unsigned int nanos6_numa_get_node_count(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#pragma GCC visibility pop
+
+
+#endif /* NANOS6_NUMA_H */
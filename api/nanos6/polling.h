@@ -62,8 +62,46 @@ typedef int (*nanos6_polling_service_t)(void *service_data);
 void nanos6_register_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data);
 
 
+//! \brief Register a polling service that the runtime must call with a given period
+//! 
+//! Works like nanos6_register_polling_service, except that the runtime calls
+//! the function approximately every period microseconds instead of with the
+//! default period of the runtime. Longer periods reduce the overhead of the
+//! services that do not need to react quickly.
+//! 
+//! \param[in] service_name a string that identifies the kind of service that will
+//! be serviced
+//! \param[in] service the function that the runtime should call periodically
+//! \param service_data an opaque pointer to data that is passed to the service
+//! function
+//! \param[in] period the minimum time between calls in microseconds
+void nanos6_register_periodic_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data, unsigned long period);
+
+
+//! \brief Register a polling service that the runtime must call when a file
+//! descriptor is readable
+//! 
+//! Works like nanos6_register_polling_service, except that the runtime only
+//! calls the function after the file descriptor becomes readable, for instance
+//! an eventfd, a pipe or a socket. Until then, the runtime can sleep instead
+//! of polling. The function is called from the leader thread of the runtime and
+//! must consume the events of the file descriptor, since otherwise it will be
+//! called again immediately. The file descriptor must remain open while the
+//! service is registered.
+//! 
+//! \param[in] service_name a string that identifies the kind of service that will
+//! be serviced
+//! \param[in] service the function that the runtime should call when the file
+//! descriptor is readable
+//! \param service_data an opaque pointer to data that is passed to the service
+//! function
+//! \param[in] fd the file descriptor that triggers the calls
+void nanos6_register_fd_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data, int fd);
+
+
 //! \brief Unregister a function and parameter of that function previously
-//! registered through a call to nanos6_register_polling_service.
+//! registered through a call to nanos6_register_polling_service or one of its
+//! variants.
 //! 
 //! Unregister a service instance identified by the service_function and
 //! service_data previously registered through a call to
@@ -29,6 +29,22 @@ extern "C" {
 void nanos6_taskwait(char const *invocation_source);
 
 
+//! \brief Block the control flow of the current task until the children that access some data have released it
+//!
+//! Unlike nanos6_taskwait, it only waits for the children whose accesses
+//! conflict with the accesses registered by register_depinfo, which are
+//! specified with the same functions as the dependencies of a task. That
+//! is, a read access waits for the children that write the data and a
+//! write access also waits for the ones that read it. The rest of the
+//! children keep running.
+//!
+//! \param[in] register_depinfo a function that registers the accesses through the
+//! nanos6_register_region_*_depinfo functions with the handler that it receives
+//! \param[in] args_block an opaque pointer that is passed to register_depinfo
+//! \param[in] invocation_source A string that identifies the source code location of the invocation
+void nanos6_taskwait_on(void (*register_depinfo)(void *args_block, void *handler), void *args_block, char const *invocation_source);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,703 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "Color.hpp"
+#include "GraphStreamRecords.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+using namespace Instrument::Graph;
+using namespace Instrument::Graph::Stream;
+
+
+enum task_flags_t {
+	on_critical_path = 1,
+	has_strong_access = 2,
+	has_strong_write = 4
+};
+
+
+//! \brief Information about each task, kept in a temporary file so that it does not need to fit in memory
+struct task_entry_t {
+	int32_t _parent;
+	int32_t _type;
+	int32_t _flags;
+	int32_t _criticalPredecessor;
+	uint64_t _startTime;
+	//! \brief Execution time not spent inside taskwaits
+	uint64_t _duration;
+	//! \brief Length of the longest chain of dependencies between siblings that ends in this task
+	uint64_t _pathLength;
+	//! \brief Longest path that ends in this task or in a reader that can run concurrently with it
+	uint64_t _readerPathLength;
+	int32_t _readerPathTask;
+};
+
+
+enum dependency_kind_t {
+	no_dependency,
+	//! \brief Two consecutive readers, which can run concurrently
+	reader_to_reader,
+	//! \brief A writer after a group of readers
+	reader_to_writer,
+	regular_dependency
+};
+
+
+class TaskTable {
+	int _fd;
+	task_entry_t *_entries;
+	size_t _capacity;
+	size_t _size;
+	
+	void grow(size_t minimum)
+	{
+		size_t newCapacity = (_capacity == 0 ? 1024 * 1024 : _capacity);
+		while (newCapacity < minimum) {
+			newCapacity *= 2;
+		}
+		
+		if (_entries != nullptr) {
+			munmap(_entries, _capacity * sizeof(task_entry_t));
+		}
+		
+		if (ftruncate(_fd, newCapacity * sizeof(task_entry_t)) != 0) {
+			std::cerr << "Error: cannot extend the temporary task table: " << strerror(errno) << std::endl;
+			exit(1);
+		}
+		
+		void *mapping = mmap(nullptr, newCapacity * sizeof(task_entry_t), PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+		if (mapping == MAP_FAILED) {
+			std::cerr << "Error: cannot map the temporary task table: " << strerror(errno) << std::endl;
+			exit(1);
+		}
+		
+		// The new part of the file reads as zeros
+		_entries = (task_entry_t *) mapping;
+		_capacity = newCapacity;
+	}
+
+public:
+	TaskTable(std::string const &directory)
+		: _fd(-1), _entries(nullptr), _capacity(0), _size(0)
+	{
+		std::string pattern = directory + "/nanos6-graph-XXXXXX";
+		std::vector<char> filename(pattern.begin(), pattern.end());
+		filename.push_back('\0');
+		
+		_fd = mkstemp(filename.data());
+		if (_fd == -1) {
+			std::cerr << "Error: cannot create a temporary file in " << directory << ": " << strerror(errno) << std::endl;
+			exit(1);
+		}
+		unlink(filename.data());
+	}
+	
+	~TaskTable()
+	{
+		if (_entries != nullptr) {
+			munmap(_entries, _capacity * sizeof(task_entry_t));
+		}
+		close(_fd);
+	}
+	
+	bool contains(int32_t taskId) const
+	{
+		return (taskId >= 0) && ((size_t) taskId < _size);
+	}
+	
+	task_entry_t &operator[](int32_t taskId)
+	{
+		return _entries[taskId];
+	}
+	
+	//! \brief Get the entry of a new task
+	task_entry_t &add(int32_t taskId)
+	{
+		if ((size_t) taskId >= _capacity) {
+			grow(taskId + 1);
+		}
+		
+		// The task identifiers are consecutive, but not necessarily created in order
+		for (size_t gap = _size; gap < (size_t) taskId; gap++) {
+			_entries[gap]._parent = -1;
+			_entries[gap]._type = -1;
+		}
+		if ((size_t) taskId >= _size) {
+			_size = taskId + 1;
+		}
+		
+		task_entry_t &entry = _entries[taskId];
+		memset(&entry, 0, sizeof(entry));
+		entry._criticalPredecessor = -1;
+		entry._readerPathTask = taskId;
+		
+		return entry;
+	}
+	
+	size_t size() const
+	{
+		return _size;
+	}
+};
+
+
+class StreamReader {
+	FILE *_file;
+	std::vector<std::string> &_taskTypeNames;
+
+public:
+	StreamReader(std::string const &filename, std::vector<std::string> &taskTypeNames)
+		: _file(nullptr), _taskTypeNames(taskTypeNames)
+	{
+		_file = fopen(filename.c_str(), "r");
+		if (_file == nullptr) {
+			std::cerr << "Error: cannot open " << filename << ": " << strerror(errno) << std::endl;
+			exit(1);
+		}
+		setvbuf(_file, nullptr, _IOFBF, 4 * 1024 * 1024);
+		
+		stream_header_t header;
+		if ((fread(&header, sizeof(header), 1, _file) != 1) || !header.isValid()) {
+			std::cerr << "Error: " << filename << " is not a graph stream of this version of Nanos6" << std::endl;
+			exit(1);
+		}
+	}
+	
+	~StreamReader()
+	{
+		fclose(_file);
+	}
+	
+	//! \brief Get the next record that is not part of a task type definition
+	bool next(record_t &record)
+	{
+		while (fread(&record, sizeof(record), 1, _file) == 1) {
+			if (record._type != task_type_record) {
+				return true;
+			}
+			
+			std::vector<char> name(getNameRecords(record._related) * sizeof(record_t) + 1, '\0');
+			if (fread(name.data(), sizeof(record_t), getNameRecords(record._related), _file) != getNameRecords(record._related)) {
+				break;
+			}
+			
+			if ((size_t) record._taskId >= _taskTypeNames.size()) {
+				_taskTypeNames.resize(record._taskId + 1);
+			}
+			_taskTypeNames[record._taskId] = std::string(name.data(), record._related);
+		}
+		
+		return false;
+	}
+};
+
+
+//! \brief Write an output stream directly to a FILE, which may be a pipe
+class FileStreamBuffer : public std::streambuf {
+	FILE *_output;
+
+protected:
+	int overflow(int c)
+	{
+		if (c != EOF) {
+			fputc(c, _output);
+		}
+		return c;
+	}
+	
+	std::streamsize xsputn(char const *s, std::streamsize n)
+	{
+		return fwrite(s, 1, n, _output);
+	}
+
+public:
+	FileStreamBuffer(FILE *output)
+		: _output(output)
+	{
+	}
+};
+
+
+struct Options {
+	std::string _input;
+	std::string _output;
+	std::string _temporaryDirectory;
+	bool _collapseByType;
+	bool _showCriticalPath;
+	int _maxPasses;
+	
+	Options()
+		: _collapseByType(false), _showCriticalPath(false), _maxPasses(16)
+	{
+		char const *tmpdir = getenv("TMPDIR");
+		_temporaryDirectory = (tmpdir != nullptr ? tmpdir : "/tmp");
+	}
+};
+
+
+static void usage(char const *argv0)
+{
+	std::cerr << "Usage: " << argv0 << " [-o <output>] [-t] [-p] [-n <passes>] [-T <directory>] <graph stream>" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "Analyzes the file generated by the graph variant of Nanos6 when it runs with NANOS6_GRAPH_STREAM=true." << std::endl;
+	std::cerr << "The file is processed sequentially and the information of the tasks is kept in a temporary file." << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "\t-o <output>\twrite the graph in DOT format, or in PDF format if the name ends in .pdf" << std::endl;
+	std::cerr << "\t-t\tcollapse the tasks of the same type into a single node" << std::endl;
+	std::cerr << "\t-p\tlist the tasks of the critical path" << std::endl;
+	std::cerr << "\t-n <passes>\tmaximum number of passes to compute the critical path (defaults to 16)" << std::endl;
+	std::cerr << "\t-T <directory>\tdirectory for the temporary files (defaults to TMPDIR or /tmp)" << std::endl;
+}
+
+
+static std::string const &getTypeName(std::vector<std::string> const &taskTypeNames, int32_t type)
+{
+	static std::string const unknown("unknown");
+	
+	if ((type < 0) || ((size_t) type >= taskTypeNames.size())) {
+		return unknown;
+	}
+	
+	return taskTypeNames[type];
+}
+
+
+static std::string escape(std::string const &text)
+{
+	std::string result;
+	for (char c : text) {
+		if ((c == '"') || (c == '\\')) {
+			result.push_back('\\');
+		}
+		result.push_back(c);
+	}
+	
+	return result;
+}
+
+
+//! \brief Classify a link between two accesses
+//!
+//! Like the in-memory graph, only the links between tasks of the same task group are considered.
+//! The links that reach tasks with only weak accesses do not delay them.
+static dependency_kind_t getDependencyKind(TaskTable &tasks, record_t const &record)
+{
+	if ((record._type != dependency_record)
+		|| !tasks.contains(record._taskId) || !tasks.contains(record._related)
+		|| (record._taskId == record._related)
+	) {
+		return no_dependency;
+	}
+	
+	task_entry_t &source = tasks[record._related];
+	task_entry_t &sink = tasks[record._taskId];
+	if ((source._type < 0) || (sink._type < 0) || (source._parent != sink._parent) || !(sink._flags & has_strong_access)) {
+		return no_dependency;
+	}
+	
+	if (record._value & read_only_access) {
+		return (sink._flags & has_strong_write) ? reader_to_writer : reader_to_reader;
+	}
+	
+	return regular_dependency;
+}
+
+
+//! \brief Collect the tasks and their execution times
+static void loadTasks(Options const &options, TaskTable &tasks, std::vector<std::string> &taskTypeNames)
+{
+	StreamReader reader(options._input, taskTypeNames);
+	
+	record_t record;
+	while (reader.next(record)) {
+		switch (record._type) {
+			case task_created_record:
+			{
+				task_entry_t &entry = tasks.add(record._taskId);
+				entry._parent = record._related;
+				entry._type = record._value;
+				break;
+			}
+			case task_started_record:
+				if (tasks.contains(record._taskId)) {
+					tasks[record._taskId]._startTime = record._time;
+				}
+				break;
+			case task_finished_record:
+				if (tasks.contains(record._taskId)) {
+					task_entry_t &entry = tasks[record._taskId];
+					entry._duration += record._time - entry._startTime;
+					entry._pathLength = entry._duration;
+					entry._readerPathLength = entry._duration;
+				}
+				break;
+			case taskwait_entered_record:
+				if (tasks.contains(record._taskId)) {
+					task_entry_t &entry = tasks[record._taskId];
+					entry._duration += record._time - entry._startTime;
+				}
+				break;
+			case taskwait_exited_record:
+				if (tasks.contains(record._taskId)) {
+					tasks[record._taskId]._startTime = record._time;
+				}
+				break;
+			case access_record:
+				if (tasks.contains(record._taskId) && !(record._value & weak_access)) {
+					task_entry_t &entry = tasks[record._taskId];
+					entry._flags |= has_strong_access;
+					if (!(record._value & read_only_access)) {
+						entry._flags |= has_strong_write;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+
+//! \brief Count the links that are actual dependencies
+static size_t countDependencies(Options const &options, TaskTable &tasks, std::vector<std::string> &taskTypeNames)
+{
+	size_t dependencies = 0;
+	
+	StreamReader reader(options._input, taskTypeNames);
+	record_t record;
+	while (reader.next(record)) {
+		dependency_kind_t kind = getDependencyKind(tasks, record);
+		if ((kind == reader_to_writer) || (kind == regular_dependency)) {
+			dependencies++;
+		}
+	}
+	
+	return dependencies;
+}
+
+
+//! \brief Find the longest chain of dependencies that ends in each task
+//!
+//! Since the predecessors of a task usually appear in the stream before its own dependencies,
+//! each pass propagates the path lengths through most of the graph and only a few passes are
+//! necessary.
+//!
+//! Consecutive readers are linked to each other, but they can run concurrently. Instead, they
+//! share the path of the task before the first one, and the next writer depends on the longest
+//! path of any of them.
+static int findPathLengths(Options const &options, TaskTable &tasks, std::vector<std::string> &taskTypeNames)
+{
+	int pass = 0;
+	bool changed = true;
+	
+	while (changed && (pass < options._maxPasses)) {
+		changed = false;
+		pass++;
+		
+		StreamReader reader(options._input, taskTypeNames);
+		record_t record;
+		while (reader.next(record)) {
+			dependency_kind_t kind = getDependencyKind(tasks, record);
+			if (kind == no_dependency) {
+				continue;
+			}
+			
+			task_entry_t &predecessor = tasks[record._related];
+			task_entry_t &successor = tasks[record._taskId];
+			
+			uint64_t pathLength;
+			int32_t criticalPredecessor;
+			if (kind == reader_to_reader) {
+				pathLength = predecessor._pathLength - predecessor._duration + successor._duration;
+				criticalPredecessor = predecessor._criticalPredecessor;
+			} else if (kind == reader_to_writer) {
+				pathLength = predecessor._readerPathLength + successor._duration;
+				criticalPredecessor = predecessor._readerPathTask;
+			} else {
+				pathLength = predecessor._pathLength + successor._duration;
+				criticalPredecessor = record._related;
+			}
+			
+			if (pathLength > successor._pathLength) {
+				successor._pathLength = pathLength;
+				successor._criticalPredecessor = criticalPredecessor;
+				changed = true;
+			}
+			if (successor._pathLength > successor._readerPathLength) {
+				successor._readerPathLength = successor._pathLength;
+				successor._readerPathTask = record._taskId;
+				changed = true;
+			}
+			if ((kind == reader_to_reader) && (predecessor._readerPathLength > successor._readerPathLength)) {
+				successor._readerPathLength = predecessor._readerPathLength;
+				successor._readerPathTask = predecessor._readerPathTask;
+				changed = true;
+			}
+		}
+	}
+	
+	if (changed) {
+		std::cerr << "Warning: the critical path did not converge after " << pass << " passes" << std::endl;
+	}
+	
+	return pass;
+}
+
+
+static void emitDOTHeader(std::ostream &os)
+{
+	os << "digraph {" << std::endl;
+	os << "\tcompound=true;" << std::endl;
+	os << "\tnode [shape=box style=\"filled,rounded\" fontname=\"Helvetica\"];" << std::endl;
+	os << "\tedge [fontname=\"Helvetica\"];" << std::endl;
+}
+
+
+static void emitTaskGraph(Options const &options, TaskTable &tasks, std::vector<std::string> &taskTypeNames, std::ostream &os)
+{
+	emitDOTHeader(os);
+	
+	// Remember the last dependencies to avoid emitting most of the repeated edges
+	enum { recent_edges = 64 * 1024 };
+	std::vector<std::pair<int32_t, int32_t>> recentEdges(recent_edges, std::make_pair(-1, -1));
+	
+	StreamReader reader(options._input, taskTypeNames);
+	record_t record;
+	while (reader.next(record)) {
+		if (record._type == task_created_record) {
+			task_entry_t &entry = tasks[record._taskId];
+			
+			os << "\ttask" << record._taskId << " [label=\"" << escape(getTypeName(taskTypeNames, entry._type)) << "\"";
+			os << " fillcolor=\"" << getBrightColor(entry._type % 12, 0.25) << "\"";
+			if (entry._flags & on_critical_path) {
+				os << " penwidth=3 color=\"#e41a1c\"";
+			}
+			os << "];" << std::endl;
+			continue;
+		}
+		
+		dependency_kind_t kind = getDependencyKind(tasks, record);
+		if (kind != no_dependency) {
+			std::pair<int32_t, int32_t> edge(record._related, record._taskId);
+			std::pair<int32_t, int32_t> &slot = recentEdges[((uint32_t) edge.first * 2654435761U + (uint32_t) edge.second) % recent_edges];
+			if (slot == edge) {
+				continue;
+			}
+			slot = edge;
+			
+			os << "\ttask" << edge.first << " -> task" << edge.second;
+			if (kind == reader_to_reader) {
+				// Not a dependency, but shows the readers that form a group
+				os << " [style=dashed arrowhead=none]";
+			} else if ((tasks[edge.first]._flags & on_critical_path) && (tasks[edge.second]._criticalPredecessor == edge.first)) {
+				os << " [penwidth=3 color=\"#e41a1c\"]";
+			}
+			os << ";" << std::endl;
+		}
+	}
+	
+	os << "}" << std::endl;
+}
+
+
+static void emitTaskTypeGraph(Options const &options, TaskTable &tasks, std::vector<std::string> &taskTypeNames, std::ostream &os)
+{
+	std::map<int32_t, std::pair<size_t, uint64_t>> instancesAndTime;
+	std::map<std::pair<int32_t, int32_t>, size_t> edgeCounts;
+	
+	for (size_t taskId = 0; taskId < tasks.size(); taskId++) {
+		task_entry_t &entry = tasks[taskId];
+		if (entry._type < 0) {
+			continue;
+		}
+		
+		std::pair<size_t, uint64_t> &current = instancesAndTime[entry._type];
+		current.first++;
+		current.second += entry._duration;
+	}
+	
+	{
+		StreamReader reader(options._input, taskTypeNames);
+		record_t record;
+		while (reader.next(record)) {
+			dependency_kind_t kind = getDependencyKind(tasks, record);
+			if ((kind == reader_to_writer) || (kind == regular_dependency)) {
+				edgeCounts[std::make_pair(tasks[record._related]._type, tasks[record._taskId]._type)]++;
+			}
+		}
+	}
+	
+	emitDOTHeader(os);
+	for (auto const &typeAndInstances : instancesAndTime) {
+		int32_t type = typeAndInstances.first;
+		size_t instances = typeAndInstances.second.first;
+		uint64_t time = typeAndInstances.second.second;
+		
+		os << "\ttype" << type << " [label=\"" << escape(getTypeName(taskTypeNames, type)) << "\\n"
+			<< instances << " tasks\\n"
+			<< std::fixed << std::setprecision(3) << (double) time / (double) instances / 1000.0 << " us on average\"";
+		os << " fillcolor=\"" << getBrightColor(type % 12, 0.25) << "\"];" << std::endl;
+	}
+	for (auto const &edgeAndCount : edgeCounts) {
+		os << "\ttype" << edgeAndCount.first.first << " -> type" << edgeAndCount.first.second
+			<< " [label=\"" << edgeAndCount.second << "\"];" << std::endl;
+	}
+	os << "}" << std::endl;
+}
+
+
+static void emitGraph(Options const &options, TaskTable &tasks, std::vector<std::string> &taskTypeNames)
+{
+	bool isPDF = (options._output.size() > 4) && (options._output.compare(options._output.size() - 4, 4, ".pdf") == 0);
+	
+	FILE *output;
+	if (isPDF) {
+		std::string command = "dot -Tpdf -o '" + options._output + "'";
+		output = popen(command.c_str(), "w");
+	} else {
+		output = fopen(options._output.c_str(), "w");
+	}
+	if (output == nullptr) {
+		std::cerr << "Error: cannot create " << options._output << ": " << strerror(errno) << std::endl;
+		exit(1);
+	}
+	
+	FileStreamBuffer buffer(output);
+	std::ostream stream(&buffer);
+	
+	if (options._collapseByType) {
+		emitTaskTypeGraph(options, tasks, taskTypeNames, stream);
+	} else {
+		emitTaskGraph(options, tasks, taskTypeNames, stream);
+	}
+	stream.flush();
+	
+	int rc = (isPDF ? pclose(output) : fclose(output));
+	if (rc != 0) {
+		std::cerr << "Error: failed to generate " << options._output << std::endl;
+		exit(1);
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	Options options;
+	
+	int opt;
+	while ((opt = getopt(argc, argv, "ho:tpn:T:")) != -1) {
+		switch (opt) {
+			case 'o':
+				options._output = optarg;
+				break;
+			case 't':
+				options._collapseByType = true;
+				break;
+			case 'p':
+				options._showCriticalPath = true;
+				break;
+			case 'n':
+				options._maxPasses = atoi(optarg);
+				break;
+			case 'T':
+				options._temporaryDirectory = optarg;
+				break;
+			case 'h':
+				usage(argv[0]);
+				return 0;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	
+	if ((optind != argc - 1) || (options._maxPasses < 1)) {
+		usage(argv[0]);
+		return 1;
+	}
+	options._input = argv[optind];
+	
+	TaskTable tasks(options._temporaryDirectory);
+	std::vector<std::string> taskTypeNames;
+	
+	loadTasks(options, tasks, taskTypeNames);
+	size_t dependencies = countDependencies(options, tasks, taskTypeNames);
+	int passes = findPathLengths(options, tasks, taskTypeNames);
+	
+	// Find the end of the critical path and mark it
+	int32_t last = -1;
+	for (size_t taskId = 0; taskId < tasks.size(); taskId++) {
+		if ((tasks[taskId]._type >= 0) && ((last == -1) || (tasks[taskId]._pathLength > tasks[last]._pathLength))) {
+			last = taskId;
+		}
+	}
+	
+	std::vector<int32_t> criticalPath;
+	for (int32_t current = last; current != -1; current = tasks[current]._criticalPredecessor) {
+		tasks[current]._flags |= on_critical_path;
+		criticalPath.push_back(current);
+		
+		// Protect against cycles in corrupt streams
+		if (criticalPath.size() > tasks.size()) {
+			break;
+		}
+	}
+	
+	// The work is measured at the level of the critical path
+	uint64_t work = 0;
+	size_t levelTasks = 0;
+	if (last != -1) {
+		for (size_t taskId = 0; taskId < tasks.size(); taskId++) {
+			if ((tasks[taskId]._type >= 0) && (tasks[taskId]._parent == tasks[last]._parent)) {
+				work += tasks[taskId]._duration;
+				levelTasks++;
+			}
+		}
+	}
+	
+	uint64_t span = (last != -1 ? tasks[last]._pathLength : 0);
+	
+	std::cout << "Tasks\t" << tasks.size() << std::endl;
+	std::cout << "TaskTypes\t" << taskTypeNames.size() << std::endl;
+	std::cout << "Dependencies\t" << dependencies << std::endl;
+	std::cout << "CriticalPathPasses\t" << passes << std::endl;
+	std::cout << "CriticalPathTasks\t" << criticalPath.size() << std::endl;
+	std::cout << "CriticalPathLength\t" << span << "\tns" << std::endl;
+	std::cout << "WorkAtCriticalPathLevel\t" << work << "\tns\t" << levelTasks << "\ttasks" << std::endl;
+	if (span != 0) {
+		std::cout << "Parallelism\t" << std::fixed << std::setprecision(2) << (double) work / (double) span << std::endl;
+	}
+	
+	if (options._showCriticalPath) {
+		for (auto it = criticalPath.rbegin(); it != criticalPath.rend(); it++) {
+			task_entry_t &entry = tasks[*it];
+			std::cout << "CriticalPath\t" << *it << "\t" << getTypeName(taskTypeNames, entry._type) << "\t" << entry._duration << "\tns" << std::endl;
+		}
+	}
+	
+	if (!options._output.empty()) {
+		emitGraph(options, tasks, taskTypeNames);
+	}
+	
+	return 0;
+}
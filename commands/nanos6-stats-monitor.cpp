@@ -0,0 +1,235 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "LiveStatsSegment.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace Instrument::Stats::Live;
+
+
+struct Snapshot {
+	SegmentHeader _header;
+	std::vector<CPUEntry> _cpus;
+	std::vector<TaskTypeEntry> _taskTypes;
+	
+	Snapshot()
+		: _header(), _cpus(), _taskTypes()
+	{
+	}
+};
+
+
+static void usage(char const *argv0)
+{
+	std::cerr << "Usage: " << argv0 << " [-i <milliseconds>] [-n <samples>] <pid>" << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "Periodically shows the statistics of a running program that uses the stats variant of Nanos6." << std::endl;
+	std::cerr << "The program must run with NANOS6_STATS_LIVE_INTERVAL set to a non-zero number of milliseconds." << std::endl;
+	std::cerr << std::endl;
+	std::cerr << "\t-i <milliseconds>\trefresh interval (defaults to 1000)" << std::endl;
+	std::cerr << "\t-n <samples>\tnumber of samples to show before exiting (defaults to unlimited)" << std::endl;
+}
+
+
+//! \brief Copy a consistent version of the segment contents
+static bool takeSnapshot(SegmentHeader *segment, Snapshot &snapshot)
+{
+	CPUEntry const *cpus = getCPUEntries(segment);
+	TaskTypeEntry const *taskTypes = getTaskTypeEntries(segment);
+	
+	for (int attempt = 0; attempt < 1000; attempt++) {
+		uint64_t before = segment->_sequence.load(std::memory_order_acquire);
+		if (before % 2 == 1) {
+			usleep(100);
+			continue;
+		}
+		
+		snapshot._header._pid = segment->_pid;
+		snapshot._header._cpuCount = segment->_cpuCount;
+		snapshot._header._interval = segment->_interval;
+		snapshot._header._timestamp = segment->_timestamp;
+		snapshot._header._updates = segment->_updates;
+		snapshot._header._readyTasks = segment->_readyTasks;
+		snapshot._header._threadCount = segment->_threadCount;
+		snapshot._header._taskTypeCount = segment->_taskTypeCount;
+		
+		uint32_t taskTypeCount = snapshot._header._taskTypeCount;
+		if (taskTypeCount > max_task_types) {
+			taskTypeCount = max_task_types;
+		}
+		
+		snapshot._cpus.assign(cpus, cpus + snapshot._header._cpuCount);
+		snapshot._taskTypes.assign(taskTypes, taskTypes + taskTypeCount);
+		
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t after = segment->_sequence.load(std::memory_order_relaxed);
+		if (before == after) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+static void emitSnapshot(Snapshot const &current, Snapshot const *previous)
+{
+	std::cout << "Time\t" << std::fixed << std::setprecision(3) << (double) current._header._timestamp / 1000000000.0 << " s" << std::endl;
+	std::cout << "Threads\t" << current._header._threadCount << std::endl;
+	std::cout << "ReadyTasks\t" << current._header._readyTasks << std::endl;
+	
+	// The CPU usage is computed over the time between samples, or since the beginning for the first one
+	std::cout << "CPUBusy";
+	for (size_t cpu = 0; cpu < current._cpus.size(); cpu++) {
+		uint64_t busy = current._cpus[cpu]._busyTime;
+		uint64_t idle = current._cpus[cpu]._idleTime;
+		if ((previous != nullptr) && (cpu < previous->_cpus.size())) {
+			busy -= previous->_cpus[cpu]._busyTime;
+			idle -= previous->_cpus[cpu]._idleTime;
+		}
+		
+		double ratio = 0.0;
+		if (busy + idle != 0) {
+			ratio = 100.0 * (double) busy / (double) (busy + idle);
+		}
+		std::cout << "\t" << std::setprecision(1) << ratio << "%";
+	}
+	std::cout << std::endl;
+	
+	for (TaskTypeEntry const &taskType : current._taskTypes) {
+		std::string label(taskType._label);
+		
+		std::cout << "TaskType\t" << label << "\tinstances\t" << taskType._instances << std::endl;
+		if (taskType._instances == 0) {
+			continue;
+		}
+		
+		std::cout << std::setprecision(3);
+		std::cout << "TaskType\t" << label << "\tmean ready time\t" << (double) taskType._readyTime / (double) taskType._instances / 1000.0 << " us" << std::endl;
+		std::cout << "TaskType\t" << label << "\tmean execution time\t" << (double) taskType._executionTime / (double) taskType._instances / 1000.0 << " us" << std::endl;
+		std::cout << "TaskType\t" << label << "\tmean blocked time\t" << (double) taskType._blockedTime / (double) taskType._instances / 1000.0 << " us" << std::endl;
+		
+		uint32_t counterCount = taskType._counterCount;
+		if (counterCount > max_task_type_counters) {
+			counterCount = max_task_type_counters;
+		}
+		for (uint32_t counter = 0; counter < counterCount; counter++) {
+			CounterEntry const &counterEntry = taskType._counters[counter];
+			std::cout << "TaskType\t" << label << "\t" << std::string(counterEntry._name) << "\t" << counterEntry._value << std::endl;
+		}
+	}
+	
+	std::cout << std::endl;
+}
+
+
+int main(int argc, char **argv)
+{
+	unsigned long interval = 1000;
+	long samples = -1;
+	
+	int opt;
+	while ((opt = getopt(argc, argv, "hi:n:")) != -1) {
+		switch (opt) {
+			case 'i':
+				interval = strtoul(optarg, nullptr, 10);
+				break;
+			case 'n':
+				samples = strtol(optarg, nullptr, 10);
+				break;
+			case 'h':
+				usage(argv[0]);
+				return 0;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	
+	if ((optind != argc - 1) || (interval == 0)) {
+		usage(argv[0]);
+		return 1;
+	}
+	
+	pid_t pid = (pid_t) strtol(argv[optind], nullptr, 10);
+	std::string segmentName = getSegmentName(pid);
+	
+	int fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+	if (fd == -1) {
+		std::cerr << "Error: cannot open " << segmentName << ": " << strerror(errno) << std::endl;
+		std::cerr << "Check that the program runs with the stats variant and NANOS6_STATS_LIVE_INTERVAL set" << std::endl;
+		return 1;
+	}
+	
+	struct stat segmentStat;
+	if ((fstat(fd, &segmentStat) != 0) || ((size_t) segmentStat.st_size < sizeof(SegmentHeader))) {
+		std::cerr << "Error: " << segmentName << " is not a valid statistics segment" << std::endl;
+		close(fd);
+		return 1;
+	}
+	
+	void *mapping = mmap(nullptr, segmentStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		std::cerr << "Error: cannot map " << segmentName << ": " << strerror(errno) << std::endl;
+		return 1;
+	}
+	
+	SegmentHeader *segment = (SegmentHeader *) mapping;
+	if ((segment->_magic != segment_magic) || (segment->_version != segment_version)
+		|| ((size_t) segmentStat.st_size < getSegmentSize(segment->_cpuCount))
+	) {
+		std::cerr << "Error: " << segmentName << " has an unexpected format" << std::endl;
+		munmap(mapping, segmentStat.st_size);
+		return 1;
+	}
+	
+	Snapshot snapshots[2];
+	Snapshot *previous = nullptr;
+	int current = 0;
+	
+	while (samples != 0) {
+		if (!takeSnapshot(segment, snapshots[current])) {
+			std::cerr << "Warning: could not obtain a consistent sample" << std::endl;
+		} else if ((previous == nullptr) || (snapshots[current]._header._updates != previous->_header._updates)) {
+			emitSnapshot(snapshots[current], previous);
+			previous = &snapshots[current];
+			current = 1 - current;
+			
+			if (samples > 0) {
+				samples--;
+			}
+		}
+		
+		// The segment stays mapped after the runtime unlinks it, so check whether the program is still alive
+		if ((kill(pid, 0) != 0) && (errno == ESRCH)) {
+			break;
+		}
+		
+		if (samples != 0) {
+			usleep(interval * 1000);
+		}
+	}
+	
+	munmap(mapping, segmentStat.st_size);
+	
+	return 0;
+}
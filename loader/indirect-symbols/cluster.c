@@ -0,0 +1,63 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "resolve.h"
+
+
+#pragma GCC visibility push(default)
+
+void *nanos6_dmalloc(size_t size, nanos6_data_distribution_t policy, size_t block_size)
+{
+	typedef void *nanos6_dmalloc_t(size_t size, nanos6_data_distribution_t policy, size_t block_size);
+	
+	static nanos6_dmalloc_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_dmalloc_t *) _nanos6_resolve_symbol("nanos6_dmalloc", "cluster", NULL);
+	}
+	
+	return (*symbol)(size, policy, block_size);
+}
+
+
+void nanos6_dfree(void *ptr, size_t size)
+{
+	typedef void nanos6_dfree_t(void *ptr, size_t size);
+	
+	static nanos6_dfree_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_dfree_t *) _nanos6_resolve_symbol("nanos6_dfree", "cluster", NULL);
+	}
+	
+	(*symbol)(ptr, size);
+}
+
+
+void *nanos6_lmalloc(size_t size)
+{
+	typedef void *nanos6_lmalloc_t(size_t size);
+	
+	static nanos6_lmalloc_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_lmalloc_t *) _nanos6_resolve_symbol("nanos6_lmalloc", "cluster", NULL);
+	}
+	
+	return (*symbol)(size);
+}
+
+
+void nanos6_lfree(void *ptr, size_t size)
+{
+	typedef void nanos6_lfree_t(void *ptr, size_t size);
+	
+	static nanos6_lfree_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_lfree_t *) _nanos6_resolve_symbol("nanos6_lfree", "cluster", NULL);
+	}
+	
+	(*symbol)(ptr, size);
+}
+
+#pragma GCC visibility pop
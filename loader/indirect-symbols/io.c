@@ -0,0 +1,37 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "resolve.h"
+
+
+#pragma GCC visibility push(default)
+
+void nanos6_io_read(int fd, void *buffer, size_t size, off_t offset, ssize_t *result)
+{
+	typedef void nanos6_io_read_t(int fd, void *buffer, size_t size, off_t offset, ssize_t *result);
+	
+	static nanos6_io_read_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_io_read_t *) _nanos6_resolve_symbol("nanos6_io_read", "asynchronous I/O", NULL);
+	}
+	
+	(*symbol)(fd, buffer, size, offset, result);
+}
+
+
+void nanos6_io_write(int fd, void const *buffer, size_t size, off_t offset, ssize_t *result)
+{
+	typedef void nanos6_io_write_t(int fd, void const *buffer, size_t size, off_t offset, ssize_t *result);
+	
+	static nanos6_io_write_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_io_write_t *) _nanos6_resolve_symbol("nanos6_io_write", "asynchronous I/O", NULL);
+	}
+	
+	(*symbol)(fd, buffer, size, offset, result);
+}
+
+#pragma GCC visibility pop
@@ -0,0 +1,63 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "resolve.h"
+
+
+#pragma GCC visibility push(default)
+
+void *nanos6_numa_alloc(size_t size, nanos6_numa_policy_t policy, size_t node, size_t block_size)
+{
+	typedef void *nanos6_numa_alloc_t(size_t size, nanos6_numa_policy_t policy, size_t node, size_t block_size);
+	
+	static nanos6_numa_alloc_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_numa_alloc_t *) _nanos6_resolve_symbol("nanos6_numa_alloc", "numa", NULL);
+	}
+	
+	return (*symbol)(size, policy, node, block_size);
+}
+
+
+void nanos6_numa_free(void *ptr)
+{
+	typedef void nanos6_numa_free_t(void *ptr);
+	
+	static nanos6_numa_free_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_numa_free_t *) _nanos6_resolve_symbol("nanos6_numa_free", "numa", NULL);
+	}
+	
+	(*symbol)(ptr);
+}
+
+
+int nanos6_numa_get_home_node(void const *address)
+{
+	typedef int nanos6_numa_get_home_node_t(void const *address);
+	
+	static nanos6_numa_get_home_node_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_numa_get_home_node_t *) _nanos6_resolve_symbol("nanos6_numa_get_home_node", "numa", NULL);
+	}
+	
+	return (*symbol)(address);
+}
+
+
+unsigned int nanos6_numa_get_node_count(void)
+{
+	typedef unsigned int nanos6_numa_get_node_count_t(void);
+	
+	static nanos6_numa_get_node_count_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_numa_get_node_count_t *) _nanos6_resolve_symbol("nanos6_numa_get_node_count", "numa", NULL);
+	}
+	
+	return (*symbol)();
+}
+
+#pragma GCC visibility pop
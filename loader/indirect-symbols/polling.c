@@ -22,6 +22,32 @@ void nanos6_register_polling_service(char const *service_name, nanos6_polling_se
 }
 
 
+void nanos6_register_periodic_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data, unsigned long period)
+{
+	typedef void nanos6_register_periodic_polling_service_t(char const *service_name, nanos6_polling_service_t service_function, void *service_data, unsigned long period);
+	
+	static nanos6_register_periodic_polling_service_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_register_periodic_polling_service_t *) _nanos6_resolve_symbol("nanos6_register_periodic_polling_service", "polling services", NULL);
+	}
+	
+	(*symbol)(service_name, service_function, service_data, period);
+}
+
+
+void nanos6_register_fd_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data, int fd)
+{
+	typedef void nanos6_register_fd_polling_service_t(char const *service_name, nanos6_polling_service_t service_function, void *service_data, int fd);
+	
+	static nanos6_register_fd_polling_service_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_register_fd_polling_service_t *) _nanos6_resolve_symbol("nanos6_register_fd_polling_service", "polling services", NULL);
+	}
+	
+	(*symbol)(service_name, service_function, service_data, fd);
+}
+
+
 void nanos6_unregister_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data)
 {
 	typedef void nanos6_unregister_polling_service_t(char const *service_name, nanos6_polling_service_t service_function, void *service_data);
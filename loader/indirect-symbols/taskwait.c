@@ -21,5 +21,18 @@ void nanos6_taskwait(char const *invocation_source)
 	(*symbol)(invocation_source);
 }
 
+
+void nanos6_taskwait_on(void (*register_depinfo)(void *args_block, void *handler), void *args_block, char const *invocation_source)
+{
+	typedef void nanos6_taskwait_on_t(void (*register_depinfo)(void *args_block, void *handler), void *args_block, char const *invocation_source);
+	
+	static nanos6_taskwait_on_t *symbol = NULL;
+	if (__builtin_expect(symbol == NULL, 0)) {
+		symbol = (nanos6_taskwait_on_t *) _nanos6_resolve_symbol("nanos6_taskwait_on", "essential", NULL);
+	}
+	
+	(*symbol)(register_depinfo, args_block, invocation_source);
+}
+
 #pragma GCC visibility pop
 
@@ -4,8 +4,10 @@
 	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
 */
 
+#include <pthread.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "api-versions.h"
 #include "loader.h"
@@ -13,6 +15,24 @@
 #include <nanos6/library-mode.h>
 
 
+typedef struct {
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	int _signaled;
+} condition_variable_t;
+
+
+static void completion_callback(void *args)
+{
+	condition_variable_t *condVar = (condition_variable_t *) args;
+	
+	pthread_mutex_lock(&condVar->_mutex);
+	condVar->_signaled = 1;
+	pthread_cond_signal(&condVar->_cond);
+	pthread_mutex_unlock(&condVar->_mutex);
+}
+
+
 __attribute__ ((used)) char const * nanos6_library_mode_init()
 {
 	if (nanos6_check_api_versions(&__user_code_expected_nanos6_api_versions) != 1) {
@@ -32,6 +52,22 @@ __attribute__ ((used)) char const * nanos6_library_mode_init()
 		return _nanos6_error_text;
 	}
 	
+	if (!nanos6_can_run_main()) {
+		// This process only runs the tasks that other processes send to it, and
+		// it must not return to the application
+		condition_variable_t condVar = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0};
+		nanos6_register_completion_callback(completion_callback, &condVar);
+		
+		pthread_mutex_lock(&condVar._mutex);
+		while (condVar._signaled == 0) {
+			pthread_cond_wait(&condVar._cond, &condVar._mutex);
+		}
+		pthread_mutex_unlock(&condVar._mutex);
+		
+		nanos6_shutdown();
+		exit(0);
+	}
+	
 	return NULL;
 }
 
@@ -0,0 +1,13 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "resolve.h"
+
+
+RESOLVE_API_FUNCTION(nanos6_dmalloc, "cluster", NULL);
+RESOLVE_API_FUNCTION(nanos6_dfree, "cluster", NULL);
+RESOLVE_API_FUNCTION(nanos6_lmalloc, "cluster", NULL);
+RESOLVE_API_FUNCTION(nanos6_lfree, "cluster", NULL);
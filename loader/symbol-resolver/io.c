@@ -0,0 +1,11 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "resolve.h"
+
+
+RESOLVE_API_FUNCTION(nanos6_io_read, "asynchronous I/O", NULL);
+RESOLVE_API_FUNCTION(nanos6_io_write, "asynchronous I/O", NULL);
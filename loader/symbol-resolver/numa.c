@@ -0,0 +1,13 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "resolve.h"
+
+
+RESOLVE_API_FUNCTION(nanos6_numa_alloc, "numa", NULL);
+RESOLVE_API_FUNCTION(nanos6_numa_free, "numa", NULL);
+RESOLVE_API_FUNCTION(nanos6_numa_get_home_node, "numa", NULL);
+RESOLVE_API_FUNCTION(nanos6_numa_get_node_count, "numa", NULL);
@@ -8,5 +8,7 @@
 
 
 RESOLVE_API_FUNCTION(nanos6_register_polling_service, "polling services", NULL);
+RESOLVE_API_FUNCTION(nanos6_register_periodic_polling_service, "polling services", NULL);
+RESOLVE_API_FUNCTION(nanos6_register_fd_polling_service, "polling services", NULL);
 RESOLVE_API_FUNCTION(nanos6_unregister_polling_service, "polling services", NULL);
 
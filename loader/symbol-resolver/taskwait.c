@@ -8,4 +8,5 @@
 
 
 RESOLVE_API_FUNCTION(nanos6_taskwait, "essential", NULL);
+RESOLVE_API_FUNCTION(nanos6_taskwait_on, "essential", NULL);
 
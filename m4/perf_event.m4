@@ -0,0 +1,28 @@
+#	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+#	
+#	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+
+AC_DEFUN([AC_CHECK_PERF_EVENT],
+	[
+		AC_ARG_ENABLE(
+			[perf-event],
+			[AS_HELP_STRING([--disable-perf-event], [do not build the variant that reads the hardware counters through perf_event_open])],
+			[ ac_use_perf_event="${enableval}" ],
+			[ ac_use_perf_event=check ]
+		)
+		
+		if test x"${ac_use_perf_event}" != x"no" ; then
+			AC_CHECK_HEADERS([linux/perf_event.h],
+				[ ac_use_perf_event=yes ],
+				[
+					if test x"${ac_use_perf_event}" = x"yes" ; then
+						AC_MSG_ERROR([linux/perf_event.h cannot be found.])
+					fi
+					ac_use_perf_event=no
+				]
+			)
+		fi
+		
+		AM_CONDITIONAL(HAVE_PERF_EVENT, test x"${ac_use_perf_event}" = x"yes")
+	]
+)
@@ -27,3 +27,32 @@ AC_DEFUN([AC_CHECK_MADV_FREE],
 )
 
 
+AC_DEFUN([AC_CHECK_IO_URING],
+	[
+		AC_LANG_PUSH(C)
+		
+		AC_MSG_CHECKING([if the io_uring system calls are available])
+		AC_COMPILE_IFELSE(
+			[ AC_LANG_PROGRAM(
+[[
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+]], [[
+	struct io_uring_params params;
+	int fd = syscall(__NR_io_uring_setup, 1, &params);
+	int rc = syscall(__NR_io_uring_register, fd, IORING_REGISTER_EVENTFD, 0, 1);
+	
+	return IORING_OP_READV + IORING_OP_WRITEV;
+]]
+				) ],
+			[  ac_have_io_uring=yes; AC_DEFINE([HAVE_IO_URING], 1, [The io_uring system calls are available]) ],
+			[ ac_have_io_uring=no ]
+		)
+		AC_MSG_RESULT([${ac_have_io_uring}])
+		
+		AC_LANG_POP(C)
+	]
+)
+
+
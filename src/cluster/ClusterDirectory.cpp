@@ -0,0 +1,276 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "ClusterDirectory.hpp"
+#include "ClusterManager.hpp"
+#include "lowlevel/SpinLock.hpp"
+#include "tasks/Task.hpp"
+
+#include <ClusterNode.hpp>
+#include <DataAccessRegistration.hpp>
+#include <IntrusiveLinearRegionMap.hpp>
+#include <IntrusiveLinearRegionMapImplementation.hpp>
+
+#include <boost/intrusive/avl_set.hpp>
+#include <boost/intrusive/avl_set_hook.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <mutex>
+
+
+namespace {
+	struct DirectoryEntry;
+	
+	struct DirectoryEntryLinkingArtifacts {
+		#if NDEBUG
+			typedef boost::intrusive::link_mode<boost::intrusive::normal_link> link_mode_t;
+		#else
+			typedef boost::intrusive::link_mode<boost::intrusive::safe_link> link_mode_t;
+		#endif
+		
+		typedef boost::intrusive::avl_set_member_hook<link_mode_t> hook_type;
+		typedef hook_type* hook_ptr;
+		typedef const hook_type* const_hook_ptr;
+		typedef DirectoryEntry value_type;
+		typedef value_type* pointer;
+		typedef const value_type* const_pointer;
+		
+		static inline constexpr hook_ptr to_hook_ptr (value_type &value);
+		static inline constexpr const_hook_ptr to_hook_ptr(const value_type &value);
+		static inline pointer to_value_ptr(hook_ptr n);
+		static inline const_pointer to_value_ptr(const_hook_ptr n);
+	};
+	
+	//! A region whose copies are held by the same remote nodes
+	struct DirectoryEntry {
+		DirectoryEntryLinkingArtifacts::hook_type _links;
+		
+		DataAccessRegion _region;
+		
+		//! Whether each node, by index, holds a valid copy
+		std::vector<bool> _copies;
+		
+		DirectoryEntry(DataAccessRegion region, size_t clusterSize)
+			: _links(), _region(region), _copies(clusterSize, false)
+		{
+		}
+		
+		DataAccessRegion const &getAccessRegion() const
+		{
+			return _region;
+		}
+		
+		void setAccessRegion(DataAccessRegion const &newRegion)
+		{
+			_region = newRegion;
+		}
+	};
+	
+	inline constexpr DirectoryEntryLinkingArtifacts::hook_ptr
+	DirectoryEntryLinkingArtifacts::to_hook_ptr (DirectoryEntryLinkingArtifacts::value_type &value)
+	{
+		return &value._links;
+	}
+	
+	inline constexpr DirectoryEntryLinkingArtifacts::const_hook_ptr
+	DirectoryEntryLinkingArtifacts::to_hook_ptr(const DirectoryEntryLinkingArtifacts::value_type &value)
+	{
+		return &value._links;
+	}
+	
+	inline DirectoryEntryLinkingArtifacts::pointer
+	DirectoryEntryLinkingArtifacts::to_value_ptr(DirectoryEntryLinkingArtifacts::hook_ptr n)
+	{
+		return (DirectoryEntryLinkingArtifacts::pointer)
+			boost::intrusive::get_parent_from_member<DirectoryEntry>(
+				n,
+				&DirectoryEntry::_links
+			);
+	}
+	
+	inline DirectoryEntryLinkingArtifacts::const_pointer
+	DirectoryEntryLinkingArtifacts::to_value_ptr(DirectoryEntryLinkingArtifacts::const_hook_ptr n)
+	{
+		return (DirectoryEntryLinkingArtifacts::const_pointer)
+			boost::intrusive::get_parent_from_member<DirectoryEntry>(
+				n,
+				&DirectoryEntry::_links
+			);
+	}
+	
+	typedef IntrusiveLinearRegionMap<
+		DirectoryEntry,
+		boost::intrusive::function_hook<DirectoryEntryLinkingArtifacts>
+	> directory_t;
+	
+	//! The regions that have copies in some remote node
+	directory_t _directory;
+	SpinLock _lock;
+	
+	//! Lets the local tasks skip the directory while it is empty
+	std::atomic<bool> _hasCopies(false);
+	
+	
+	//! Split the entries that cross the boundaries of a region
+	void fragment(DataAccessRegion const &region)
+	{
+		_directory.fragmentIntersecting(
+			region,
+			[](DirectoryEntry const &entry) -> DirectoryEntry * {
+				return new DirectoryEntry(entry);
+			},
+			[](__attribute__((unused)) DirectoryEntry *fragment, __attribute__((unused)) DirectoryEntry *original) {
+			}
+		);
+	}
+	
+	//! Record that a node holds a copy of a region, which may be the only remote one
+	void addCopy(DataAccessRegion const &region, ClusterNode const *node, bool onlyCopy)
+	{
+		int index = node->getIndex();
+		std::vector<DataAccessRegion> missing;
+		
+		fragment(region);
+		_directory.processIntersectingAndMissing(
+			region,
+			[&](directory_t::iterator position) -> bool {
+				if (onlyCopy) {
+					std::fill(position->_copies.begin(), position->_copies.end(), false);
+				}
+				position->_copies[index] = true;
+				return true;
+			},
+			[&](DataAccessRegion const &missingRegion) -> bool {
+				missing.push_back(missingRegion);
+				return true;
+			}
+		);
+		
+		//! The entries are added after the traversal, since it does not expect changes
+		for (DataAccessRegion const &missingRegion : missing) {
+			DirectoryEntry *entry = new DirectoryEntry(missingRegion, ClusterManager::clusterSize());
+			entry->_copies[index] = true;
+			_directory.insert(*entry);
+		}
+		
+		_hasCopies = true;
+	}
+	
+	//! Drop the remote copies of a region
+	void invalidate(DataAccessRegion const &region)
+	{
+		std::vector<DirectoryEntry *> victims;
+		
+		fragment(region);
+		_directory.processIntersecting(
+			region,
+			[&](directory_t::iterator position) -> bool {
+				victims.push_back(&(*position));
+				return true;
+			}
+		);
+		
+		for (DirectoryEntry *entry : victims) {
+			_directory.erase(entry);
+			delete entry;
+		}
+	}
+}
+
+
+void ClusterDirectory::requestCopy(DataAccessRegion const &region, ClusterNode const *node, std::vector<DataAccessRegion> &missing)
+{
+	assert(node != nullptr);
+	assert(node != ClusterManager::getClusterNode());
+	
+	//! Contiguous parts are merged, so that they are transferred together
+	auto addMissing = [&](DataAccessRegion const &part) {
+		if (!missing.empty() && (missing.back().getEndAddress() == part.getStartAddress())) {
+			missing.back() = DataAccessRegion(missing.back().getStartAddress(), part.getEndAddress());
+		} else {
+			missing.push_back(part);
+		}
+	};
+	
+	int index = node->getIndex();
+	
+	std::lock_guard<SpinLock> guard(_lock);
+	_directory.processIntersectingAndMissing(
+		region,
+		[&](directory_t::iterator position) -> bool {
+			if (!position->_copies[index]) {
+				addMissing(position->getAccessRegion().intersect(region));
+			}
+			return true;
+		},
+		[&](DataAccessRegion const &missingRegion) -> bool {
+			addMissing(missingRegion);
+			return true;
+		}
+	);
+	
+	addCopy(region, node, false);
+}
+
+
+void ClusterDirectory::remoteTaskHasRun(Task *task, ClusterNode const *node)
+{
+	assert(task != nullptr);
+	assert(node != nullptr);
+	
+	/*! The weak accesses count too, since their data has been
+	 * written by the subtasks of the remote task */
+	DataAccessRegistration::processAllDataAccesses(
+		task,
+		[&](DataAccessRegion const &region, DataAccessType type, __attribute__((unused)) bool weak) -> bool {
+			if (type != READ_ACCESS_TYPE) {
+				std::lock_guard<SpinLock> guard(_lock);
+				addCopy(region, node, true);
+			}
+			return true;
+		}
+	);
+}
+
+
+void ClusterDirectory::localTaskHasRun(Task *task)
+{
+	assert(task != nullptr);
+	
+	if (!_hasCopies || !ClusterManager::isMasterNode()) {
+		return;
+	}
+	
+	DataAccessRegistration::processAllDataAccesses(
+		task,
+		[&](DataAccessRegion const &region, DataAccessType type, bool weak) -> bool {
+			//! Weak accesses are written by the subtasks, which do their own invalidations
+			if (!weak && (type != READ_ACCESS_TYPE)) {
+				std::lock_guard<SpinLock> guard(_lock);
+				invalidate(region);
+			}
+			return true;
+		}
+	);
+}
+
+
+void ClusterDirectory::invalidateAll()
+{
+	if (!_hasCopies) {
+		return;
+	}
+	
+	std::lock_guard<SpinLock> guard(_lock);
+	_directory.deleteAll(
+		[](DirectoryEntry *entry) {
+			delete entry;
+		}
+	);
+	_hasCopies = false;
+}
@@ -0,0 +1,62 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __CLUSTER_DIRECTORY_HPP__
+#define __CLUSTER_DIRECTORY_HPP__
+
+#include <vector>
+
+#include <DataAccessRegion.hpp>
+
+class ClusterNode;
+class Task;
+
+/** Directory of the copies of the cluster memory held by the remote nodes.
+ *
+ * The master node always holds the last version of the data. The
+ * directory records, with region granularity, which remote nodes also
+ * hold a valid copy of it, so that the tasks offloaded to them do not
+ * fetch it again. The copies are invalidated when the data is written
+ * anywhere else.
+ *
+ * It is only used by the master node, which is the one that offloads
+ * the tasks.
+ */
+class ClusterDirectory {
+public:
+	/** Get the parts of a region that a node does not hold, and record that it will
+	 *
+	 * The node is recorded as holding the whole region right away, so
+	 * that the tasks offloaded to it later do not transfer it again.
+	 * They wait on the remote node for the transfers in progress instead.
+	 *
+	 * \param region is the input region of a task offloaded to the node
+	 * \param node is the remote node
+	 * \param missing gets the parts of the region without a valid copy
+	 * 	  in the node, with the contiguous ones merged
+	 */
+	static void requestCopy(DataAccessRegion const &region, ClusterNode const *node, std::vector<DataAccessRegion> &missing);
+	
+	/** Update the directory with a task that has run remotely
+	 *
+	 * The node holds the only remote copy of the data the task has written
+	 */
+	static void remoteTaskHasRun(Task *task, ClusterNode const *node);
+	
+	//! Invalidate the remote copies of the data written by a task that has run locally
+	static void localTaskHasRun(Task *task);
+	
+	/** Invalidate all the remote copies
+	 *
+	 * Used when the master node may have written the data outside of a
+	 * task, that is, at the start of top level tasks and after their
+	 * taskwaits
+	 */
+	static void invalidateAll();
+};
+
+
+#endif /* __CLUSTER_DIRECTORY_HPP__ */
@@ -7,14 +7,27 @@
 #include "ClusterManager.hpp"
 #include <ClusterNode.hpp>
 #include "lowlevel/EnvironmentVariable.hpp"
+#include "lowlevel/SpinLock.hpp"
+#include "messages/Message.hpp"
+#include "messages/MessageSysFinish.hpp"
 #include "messenger/Messenger.hpp"
 #include "system/RuntimeInfo.hpp"
 
+#include <mutex>
+
+#include <nanos6/polling.h>
+
 int ClusterManager::_clusterSize;
 std::vector<ClusterNode *> ClusterManager::_clusterNodes;
 ClusterNode *ClusterManager::_thisNode = nullptr;
 ClusterNode *ClusterManager::_masterNode = nullptr;
 Messenger *ClusterManager::_msn = nullptr;
+void (*ClusterManager::_completionCallback)(void *) = nullptr;
+void *ClusterManager::_completionCallbackArgs = nullptr;
+bool ClusterManager::_finishRequested = false;
+
+//! Protects the completion callback and the finish request
+static SpinLock _completionLock;
 
 
 void ClusterManager::initializeCluster(std::string const &commType)
@@ -37,9 +50,55 @@ void ClusterManager::initializeCluster(std::string const &commType)
 	_thisNode = _clusterNodes[nodeIndex];
 	_masterNode = _clusterNodes[masterIndex];
 	
+	nanos6_register_polling_service("cluster messages", (nanos6_polling_service_t) &ClusterManager::handleMessages, nullptr);
+	
 	_msn->synchronizeAll();
 }
 
+int ClusterManager::handleMessages(__attribute__((unused)) void *)
+{
+	Message *msg = _msn->checkMail();
+	while (msg != nullptr) {
+		if (msg->handleMessage()) {
+			delete msg;
+		}
+		msg = _msn->checkMail();
+	}
+	
+	return false;
+}
+
+void ClusterManager::setCompletionCallback(void (*callback)(void *), void *callbackArgs)
+{
+	bool alreadyRequested;
+	{
+		std::lock_guard<SpinLock> guard(_completionLock);
+		_completionCallback = callback;
+		_completionCallbackArgs = callbackArgs;
+		alreadyRequested = _finishRequested;
+	}
+	
+	if (alreadyRequested) {
+		callback(callbackArgs);
+	}
+}
+
+void ClusterManager::finishRequested()
+{
+	void (*callback)(void *);
+	void *callbackArgs;
+	{
+		std::lock_guard<SpinLock> guard(_completionLock);
+		_finishRequested = true;
+		callback = _completionCallback;
+		callbackArgs = _completionCallbackArgs;
+	}
+	
+	if (callback != nullptr) {
+		callback(callbackArgs);
+	}
+}
+
 void ClusterManager::initialize()
 {
 	EnvironmentVariable<std::string> commType("NANOS6_COMMUNICATION", "disabled");
@@ -61,6 +120,28 @@ void ClusterManager::initialize()
 
 void ClusterManager::shutdown()
 {
+	if (_msn != nullptr) {
+		if (isMasterNode()) {
+			// At this point all the offloaded tasks have finished
+			std::vector<ClusterNode *> remoteNodes;
+			for (auto &node : _clusterNodes) {
+				if (node != _thisNode) {
+					remoteNodes.push_back(node);
+				}
+			}
+			
+			// The messenger sends it before finalizing
+			if (!remoteNodes.empty()) {
+				_msn->sendMessage(new MessageSysFinish(_thisNode), remoteNodes);
+			}
+		}
+		
+		nanos6_unregister_polling_service("cluster messages", (nanos6_polling_service_t) &ClusterManager::handleMessages, nullptr);
+		
+		delete _msn;
+		_msn = nullptr;
+	}
+	
 	for (auto &node : _clusterNodes) {
 		delete node;
 	}
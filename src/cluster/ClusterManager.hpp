@@ -34,8 +34,18 @@ private:
 	//! Messenger object for cluster communication.
 	static Messenger *_msn;
 	
+	//! Function to call when a node that does not run main must finish
+	static void (*_completionCallback)(void *);
+	static void *_completionCallbackArgs;
+	
+	//! Whether the master node has already requested this node to finish
+	static bool _finishRequested;
+	
 	static void initializeCluster(std::string const &commType);
 	
+	//! Polling service that receives and handles the incoming messages
+	static int handleMessages(void *);
+	
 	//! private constructor. This is a singleton.
 	ClusterManager()
 	{}
@@ -43,6 +53,22 @@ public:
 	static void initialize();
 	static void shutdown();
 	
+	//! \brief Register the function that finishes a node that does not run main
+	static void setCompletionCallback(void (*callback)(void *), void *callbackArgs);
+	
+	//! \brief Called when the master node requests this node to finish
+	static void finishRequested();
+	
+	static inline Messenger *getMessenger()
+	{
+		return _msn;
+	}
+	
+	static inline ClusterNode *getMasterNode()
+	{
+		return _masterNode;
+	}
+	
 	static inline ClusterNode *getClusterNode(int nodeId)
 	{
 		return _clusterNodes[nodeId];
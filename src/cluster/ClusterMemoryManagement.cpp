@@ -0,0 +1,214 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "ClusterManager.hpp"
+#include "ClusterMemoryManagement.hpp"
+#include "executors/threads/CPU.hpp"
+#include "executors/threads/WorkerThread.hpp"
+#include "hardware/HardwareInfo.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+
+#include <ClusterNode.hpp>
+#include <VirtualMemoryManagement.hpp>
+
+#include <cassert>
+#include <iterator>
+#include <mutex>
+
+
+std::map<char *, ClusterMemoryManagement::allocation_t> ClusterMemoryManagement::_allocations;
+ClusterMemoryManagement::free_ranges_t ClusterMemoryManagement::_freeDistributed;
+ClusterMemoryManagement::free_ranges_t ClusterMemoryManagement::_freeLocal;
+SpinLock ClusterMemoryManagement::_lock;
+
+
+char *ClusterMemoryManagement::takeFreeRange(free_ranges_t &freeRanges, size_t size)
+{
+	//! First fit, since the ranges are few and merged
+	for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+		if (it->second < size) {
+			continue;
+		}
+		
+		char *address = it->first;
+		size_t remaining = it->second - size;
+		freeRanges.erase(it);
+		if (remaining > 0) {
+			freeRanges[address + size] = remaining;
+		}
+		
+		return address;
+	}
+	
+	return nullptr;
+}
+
+void ClusterMemoryManagement::returnFreeRange(free_ranges_t &freeRanges, char *address, size_t size)
+{
+	auto next = freeRanges.lower_bound(address);
+	if ((next != freeRanges.end()) && (address + size == next->first)) {
+		size += next->second;
+		next = freeRanges.erase(next);
+	}
+	
+	if (next != freeRanges.begin()) {
+		auto previous = std::prev(next);
+		if (previous->first + previous->second == address) {
+			previous->second += size;
+			return;
+		}
+	}
+	
+	freeRanges[address] = size;
+}
+
+void *ClusterMemoryManagement::dmalloc(size_t size, nanos6_data_distribution_t policy, size_t blockSize)
+{
+	FatalErrorHandler::failIf(
+		!ClusterManager::isMasterNode(),
+		"nanos6_dmalloc can only be called from the master node"
+	);
+	
+	if (size == 0) {
+		return nullptr;
+	}
+	
+	size_t pageSize = HardwareInfo::getPageSize();
+	size = ROUND_UP(size, pageSize);
+	
+	allocation_t allocation;
+	allocation._size = size;
+	allocation._homeNode = nullptr;
+	allocation._policy = policy;
+	
+	int clusterSize = ClusterManager::clusterSize();
+	switch (policy) {
+		case nanos6_block_distribution:
+			allocation._blockSize = ROUND_UP((size + clusterSize - 1) / clusterSize, pageSize);
+			break;
+		case nanos6_cyclic_distribution:
+			allocation._blockSize = pageSize;
+			break;
+		case nanos6_cyclic_block_distribution:
+			allocation._blockSize = (blockSize > 0) ? blockSize : pageSize;
+			break;
+		default:
+			FatalErrorHandler::failIf(true, "Unknown distribution policy passed to nanos6_dmalloc");
+			return nullptr;
+	}
+	
+	std::lock_guard<SpinLock> guard(_lock);
+	
+	char *address = takeFreeRange(_freeDistributed, size);
+	if (address == nullptr) {
+		address = (char *) VirtualMemoryManagement::allocDistrib(size);
+		if (address == nullptr) {
+			return nullptr;
+		}
+	}
+	
+	_allocations[address] = allocation;
+	
+	return address;
+}
+
+void *ClusterMemoryManagement::lmalloc(size_t size)
+{
+	if (size == 0) {
+		return nullptr;
+	}
+	
+	size = ROUND_UP(size, HardwareInfo::getPageSize());
+	
+	//! Take it from the NUMA node of the current CPU, if any
+	size_t NUMANodeId = 0;
+	WorkerThread *currentThread = WorkerThread::getCurrentWorkerThread();
+	if ((currentThread != nullptr) && (currentThread->getComputePlace() != nullptr)) {
+		NUMANodeId = currentThread->getComputePlace()->_NUMANodeId;
+	}
+	
+	allocation_t allocation;
+	allocation._size = size;
+	allocation._homeNode = ClusterManager::getClusterNode();
+	allocation._policy = nanos6_block_distribution;
+	allocation._blockSize = size;
+	
+	std::lock_guard<SpinLock> guard(_lock);
+	
+	char *address = takeFreeRange(_freeLocal, size);
+	if (address == nullptr) {
+		address = (char *) VirtualMemoryManagement::allocLocalNUMA(size, NUMANodeId);
+		if (address == nullptr) {
+			return nullptr;
+		}
+	}
+	
+	_allocations[address] = allocation;
+	
+	return address;
+}
+
+void ClusterMemoryManagement::release(free_ranges_t &freeRanges, void *ptr, size_t size, bool distributed)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+	
+	std::lock_guard<SpinLock> guard(_lock);
+	
+	auto it = _allocations.find((char *) ptr);
+	FatalErrorHandler::failIf(
+		(it == _allocations.end())
+			|| (it->second._size != ROUND_UP(size, HardwareInfo::getPageSize()))
+			|| ((it->second._homeNode == nullptr) != distributed),
+		distributed ? "nanos6_dfree" : "nanos6_lfree",
+		" called with an address or size that does not match an allocation"
+	);
+	
+	returnFreeRange(freeRanges, it->first, it->second._size);
+	_allocations.erase(it);
+}
+
+void ClusterMemoryManagement::dfree(void *ptr, size_t size)
+{
+	release(_freeDistributed, ptr, size, true);
+}
+
+void ClusterMemoryManagement::lfree(void *ptr, size_t size)
+{
+	release(_freeLocal, ptr, size, false);
+}
+
+ClusterNode *ClusterMemoryManagement::getHomeNode(void const *address)
+{
+	std::lock_guard<SpinLock> guard(_lock);
+	
+	auto it = _allocations.upper_bound((char *) address);
+	if (it == _allocations.begin()) {
+		return nullptr;
+	}
+	--it;
+	
+	allocation_t const &allocation = it->second;
+	size_t offset = (char const *) address - it->first;
+	if (offset >= allocation._size) {
+		return nullptr;
+	}
+	
+	if (allocation._homeNode != nullptr) {
+		return allocation._homeNode;
+	}
+	
+	size_t block = offset / allocation._blockSize;
+	int clusterSize = ClusterManager::clusterSize();
+	if (allocation._policy == nanos6_block_distribution) {
+		//! The last node may get a smaller part
+		assert(block < (size_t) clusterSize);
+		return ClusterManager::getClusterNode(block);
+	}
+	
+	return ClusterManager::getClusterNode(block % clusterSize);
+}
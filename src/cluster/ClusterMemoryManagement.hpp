@@ -0,0 +1,77 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __CLUSTER_MEMORY_MANAGEMENT_HPP__
+#define __CLUSTER_MEMORY_MANAGEMENT_HPP__
+
+#include <map>
+
+#include <nanos6/cluster.h>
+
+#include "lowlevel/SpinLock.hpp"
+
+class ClusterNode;
+
+//! Allocations of the memory that is shared by all the cluster nodes
+class ClusterMemoryManagement {
+private:
+	struct allocation_t {
+		size_t _size;
+		
+		//! Home node of the local allocations, or nullptr if distributed
+		ClusterNode *_homeNode;
+		
+		nanos6_data_distribution_t _policy;
+		
+		//! Size of the part of each node, or of the blocks of the cyclic policies
+		size_t _blockSize;
+	};
+	
+	//! Free address ranges, indexed by their start address
+	typedef std::map<char *, size_t> free_ranges_t;
+	
+	//! The live allocations, indexed by their start address
+	static std::map<char *, allocation_t> _allocations;
+	
+	//! Address ranges of previous allocations that can be reused
+	static free_ranges_t _freeDistributed;
+	static free_ranges_t _freeLocal;
+	
+	static SpinLock _lock;
+	
+	//! Take a range of the given size from the free ranges, or return nullptr
+	static char *takeFreeRange(free_ranges_t &freeRanges, size_t size);
+	
+	//! Return a range to the free ranges, merging it with its neighbours
+	static void returnFreeRange(free_ranges_t &freeRanges, char *address, size_t size);
+	
+	//! Remove an allocation and return its range to the free ranges
+	static void release(free_ranges_t &freeRanges, void *ptr, size_t size, bool distributed);
+
+public:
+	/** Allocate memory distributed among the nodes
+	 *
+	 * \param size is the size of the allocation
+	 * \param policy determines the home node of each part
+	 * \param blockSize is the block size of the cyclic-block policy
+	 */
+	static void *dmalloc(size_t size, nanos6_data_distribution_t policy, size_t blockSize);
+	static void dfree(void *ptr, size_t size);
+	
+	//! Allocate memory whose home is the current node
+	static void *lmalloc(size_t size);
+	static void lfree(void *ptr, size_t size);
+	
+	/** Get the node that holds an address
+	 *
+	 * \returns the home node, or nullptr if the address does not belong
+	 * to an allocation of this node
+	 */
+	static ClusterNode *getHomeNode(void const *address);
+};
+
+
+#endif /* __CLUSTER_MEMORY_MANAGEMENT_HPP__ */
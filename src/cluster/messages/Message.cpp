@@ -7,7 +7,17 @@
 #include "Message.hpp"
 #include <ClusterNode.hpp>
 
-Message::Message(const char* name, MessageType type, size_t size, const ClusterNode *from)
+#include <atomic>
+#include <climits>
+
+
+static std::atomic<unsigned int> _nextMessageId(0);
+
+
+static_assert(sizeof(Message::msg_header) % 8 == 0, "The payload of the messages must be aligned");
+
+
+Message::Message(MessageType type, size_t size, const ClusterNode *from)
 {
 	_deliverable = (Deliverable *)calloc(1, sizeof(msg_header) + size);
 	FatalErrorHandler::failIf(
@@ -15,12 +25,12 @@ Message::Message(const char* name, MessageType type, size_t size, const ClusterN
 		"Could not allocate for creating message"
 	);
 	
-	strncpy(_deliverable->header.name, name, MSG_NAMELEN);
+	assert(from->getIndex() <= UINT16_MAX);
+	
 	_deliverable->header.type = type;
 	_deliverable->header.size = size;
-	/*! initialize the message id to 0 for now. In the
-	 * future, it will probably be something related to
-	 * the Task related with this message. */
-	_deliverable->header.id = 0;
+	/*! The data transfers that are related to a message use
+	 * its id to be told apart from the rest */
+	_deliverable->header.id = (int) (_nextMessageId++ & INT_MAX);
 	_deliverable->header.snd_id = from->getIndex();
 }
@@ -12,25 +12,29 @@
 #include "support/GenericFactory.hpp"
 #include "MessageType.hpp"
 
+#include <cstdint>
+
 class ClusterNode;
 
 class Message {
 public:
+	/** Header of the messages on the wire.
+	 *
+	 * It is kept compact, since most of the messages are small, and its
+	 * size is a multiple of 8 bytes, so that the payloads are aligned
+	 */
 	struct msg_header {
-		//! string containing the message type
-		char name[MSG_NAMELEN];
+		//! the MessageType of the message
+		uint16_t type;
 		
-		//! the type of the message
-		MessageType type;
-		
-		//! size of the payload in bytes
-		size_t size;
+		//! Cluster index of the sender node
+		uint16_t snd_id;
 		
 		//! Id of the message
-		int id;
+		int32_t id;
 		
-		//! Cluster index of the sender node
-		int snd_id;
+		//! size of the payload in bytes
+		uint64_t size;
 	};
 	
 	/** Deliverable is the structure that is actually sent over the network.
@@ -44,7 +48,7 @@ public:
 	} Deliverable;
 	
 	Message() = delete;
-	Message(const char* name, MessageType type, size_t size, const ClusterNode *from);
+	Message(MessageType type, size_t size, const ClusterNode *from);
 	
 	//! Construct a message from a received(?) Deliverable structure
 	Message(Deliverable *dlv)
@@ -64,13 +68,32 @@ public:
 		return _deliverable;
 	}
 	
+	//! Get the identifier of the message, which is unique for each sender
+	inline int getId() const
+	{
+		return _deliverable->header.id;
+	}
+	
+	//! Get the type of the message
+	inline MessageType getType() const
+	{
+		return (MessageType) _deliverable->header.type;
+	}
+	
+	//! Get the cluster index of the sender node
+	inline int getSenderId() const
+	{
+		return _deliverable->header.snd_id;
+	}
+	
 	/** Handles the received message.
 	 *
-	 * Specific to each type of message. This method should handle the
-	 * destruction of the message.
+	 * Specific to each type of message.
 	 *
+	 * \returns true if the message can be deleted, or false if the
+	 * handler has taken care of its destruction
 	 **/
-	virtual void handleMessage() = 0;
+	virtual bool handleMessage() = 0;
 	
 	//! prints info about the message.
 	virtual void toString(std::ostream& where) const = 0;
@@ -0,0 +1,36 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "MessageDataFetch.hpp"
+#include "cluster/ClusterManager.hpp"
+#include "cluster/messenger/Messenger.hpp"
+
+MessageDataFetch::MessageDataFetch(const ClusterNode *from, std::vector<DataAccessRegion> const &regions)
+	: Message(DATA_FETCH,
+		sizeof(DataFetchMessageContent) + regions.size() * sizeof(DataAccessRegion),
+		from)
+{
+	_content = reinterpret_cast<DataFetchMessageContent *>(_deliverable->payload);
+	_content->_numRegions = regions.size();
+	
+	for (size_t i = 0; i < regions.size(); ++i) {
+		_content->_regions[i] = regions[i];
+	}
+}
+
+bool MessageDataFetch::handleMessage()
+{
+	Messenger *msn = ClusterManager::getMessenger();
+	ClusterNode *requester = ClusterManager::getClusterNode(getSenderId());
+	
+	/*! The requester is waiting for the regions in the same
+	 * order, matched by the id of this message */
+	for (size_t i = 0; i < _content->_numRegions; ++i) {
+		msn->sendData(_content->_regions[i], requester, getId());
+	}
+	
+	return true;
+}
@@ -0,0 +1,58 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __MESSAGE_DATA_FETCH_HPP__
+#define __MESSAGE_DATA_FETCH_HPP__
+
+#include "Message.hpp"
+
+#include <vector>
+
+#include <DataAccessRegion.hpp>
+
+class MessageDataFetch : public Message
+{
+	struct DataFetchMessageContent {
+		//! The regions that the receiver sends back, in order
+		size_t _numRegions;
+		DataAccessRegion _regions[];
+	};
+	
+	//! pointer to message payload
+	DataFetchMessageContent *_content;
+
+public:
+	MessageDataFetch(const ClusterNode *from, std::vector<DataAccessRegion> const &regions);
+	MessageDataFetch(Deliverable *dlv);
+	
+	bool handleMessage();
+	
+	void toString(std::ostream &where) const;
+};
+
+inline MessageDataFetch::MessageDataFetch(Deliverable *dlv)
+	: Message(dlv)
+{
+	_content = reinterpret_cast<DataFetchMessageContent *>(_deliverable->payload);
+}
+
+inline void MessageDataFetch::toString(std::ostream &where) const
+{
+	where << "DataFetch of " << _content->_numRegions << " regions";
+}
+
+//! Register the Message type to the Object factory
+namespace {
+	Message *createDataFetchMessage(Message::Deliverable *dlv)
+	{
+		return new MessageDataFetch(dlv);
+	}
+	
+	const bool __attribute__((unused))_registered_data_fetch =
+		REGISTER_MSG_CLASS(DATA_FETCH, createDataFetchMessage);
+}
+
+#endif /* __MESSAGE_DATA_FETCH_HPP__ */
@@ -5,11 +5,15 @@
 */
 
 #include "MessageSysFinish.hpp"
+#include "cluster/ClusterManager.hpp"
 
 MessageSysFinish::MessageSysFinish(const ClusterNode *from)
-	: Message("MessageSysFinish", SYS_FINISH, 1, from)
+	: Message(SYS_FINISH, 1, from)
 {}
 
-void MessageSysFinish::handleMessage()
+bool MessageSysFinish::handleMessage()
 {
+	ClusterManager::finishRequested();
+	
+	return true;
 }
@@ -14,11 +14,11 @@ class MessageSysFinish : public Message
 public:
 	MessageSysFinish(const ClusterNode *from);
 	MessageSysFinish(Deliverable *dlv);
-	void handleMessage();
+	bool handleMessage();
 	void toString(std::ostream &where) const;
 };
 
-MessageSysFinish::MessageSysFinish(Deliverable *dlv)
+inline MessageSysFinish::MessageSysFinish(Deliverable *dlv)
 	: Message(dlv)
 {
 }
@@ -0,0 +1,29 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "MessageTaskFinished.hpp"
+#include "cluster/offloading/TaskOffloading.hpp"
+
+MessageTaskFinished::MessageTaskFinished(const ClusterNode *from, void *offloadedTask, std::vector<DataAccessRegion> const &regions)
+	: Message(TASK_FINISHED,
+		sizeof(TaskFinishedMessageContent) + regions.size() * sizeof(DataAccessRegion),
+		from)
+{
+	_content = reinterpret_cast<TaskFinishedMessageContent *>(_deliverable->payload);
+	_content->_offloadedTask = offloadedTask;
+	_content->_numRegions = regions.size();
+	
+	for (size_t i = 0; i < regions.size(); ++i) {
+		_content->_regions[i] = regions[i];
+	}
+}
+
+bool MessageTaskFinished::handleMessage()
+{
+	TaskOffloading::remoteTaskFinished(this);
+	
+	return true;
+}
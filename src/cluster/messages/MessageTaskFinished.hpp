@@ -0,0 +1,76 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __MESSAGE_TASK_FINISHED_HPP__
+#define __MESSAGE_TASK_FINISHED_HPP__
+
+#include "Message.hpp"
+
+#include <vector>
+
+#include <DataAccessRegion.hpp>
+
+class MessageTaskFinished : public Message
+{
+	struct TaskFinishedMessageContent {
+		//! The task on the offloader node
+		void *_offloadedTask;
+		
+		//! The regions that are sent after the message, in order
+		size_t _numRegions;
+		DataAccessRegion _regions[];
+	};
+	
+	//! pointer to message payload
+	TaskFinishedMessageContent *_content;
+
+public:
+	MessageTaskFinished(const ClusterNode *from, void *offloadedTask, std::vector<DataAccessRegion> const &regions);
+	MessageTaskFinished(Deliverable *dlv);
+	
+	bool handleMessage();
+	
+	inline void *getOffloadedTask() const
+	{
+		return _content->_offloadedTask;
+	}
+	
+	inline size_t getNumRegions() const
+	{
+		return _content->_numRegions;
+	}
+	
+	inline DataAccessRegion const *getRegions() const
+	{
+		return _content->_regions;
+	}
+	
+	void toString(std::ostream &where) const;
+};
+
+inline MessageTaskFinished::MessageTaskFinished(Deliverable *dlv)
+	: Message(dlv)
+{
+	_content = reinterpret_cast<TaskFinishedMessageContent *>(_deliverable->payload);
+}
+
+inline void MessageTaskFinished::toString(std::ostream &where) const
+{
+	where << "TaskFinished " << _content->_offloadedTask << " with " << _content->_numRegions << " regions";
+}
+
+//! Register the Message type to the Object factory
+namespace {
+	Message *createTaskFinishedMessage(Message::Deliverable *dlv)
+	{
+		return new MessageTaskFinished(dlv);
+	}
+	
+	const bool __attribute__((unused))_registered_task_finished =
+		REGISTER_MSG_CLASS(TASK_FINISHED, createTaskFinishedMessage);
+}
+
+#endif /* __MESSAGE_TASK_FINISHED_HPP__ */
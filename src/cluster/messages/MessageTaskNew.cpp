@@ -0,0 +1,52 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "MessageTaskNew.hpp"
+
+#include <cstring>
+
+MessageTaskNew::MessageTaskNew(
+	const ClusterNode *from, void *offloadedTask,
+	TaskOffloading::static_object_location_t const &taskInfo,
+	TaskOffloading::static_object_location_t const &taskInvocationInfo,
+	size_t flags, void const *argsBlock, size_t argsBlockSize,
+	std::vector<AccessInfo> const &accesses,
+	std::vector<DataAccessRegion> const &transfers
+)
+	: Message(TASK_NEW,
+		sizeof(TaskNewMessageContent) + accesses.size() * sizeof(AccessInfo)
+		+ transfers.size() * sizeof(DataAccessRegion) + argsBlockSize,
+		from)
+{
+	_content = reinterpret_cast<TaskNewMessageContent *>(_deliverable->payload);
+	_content->_offloadedTask = offloadedTask;
+	_content->_taskInfo = taskInfo;
+	_content->_taskInvocationInfo = taskInvocationInfo;
+	_content->_flags = flags;
+	_content->_argsBlockSize = argsBlockSize;
+	_content->_numAccesses = accesses.size();
+	_content->_numTransfers = transfers.size();
+	
+	for (size_t i = 0; i < accesses.size(); ++i) {
+		_content->_accesses[i] = accesses[i];
+	}
+	
+	DataAccessRegion *transferRegions = const_cast<DataAccessRegion *>(getTransfers());
+	for (size_t i = 0; i < transfers.size(); ++i) {
+		transferRegions[i] = transfers[i];
+	}
+	
+	memcpy((void *)getArgsBlock(), argsBlock, argsBlockSize);
+}
+
+bool MessageTaskNew::handleMessage()
+{
+	/*! The message is deleted once the task has finished, since
+	 * it holds the args block and the accesses of the task */
+	TaskOffloading::remoteTaskCreated(this);
+	
+	return false;
+}
@@ -0,0 +1,141 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __MESSAGE_TASK_NEW_HPP__
+#define __MESSAGE_TASK_NEW_HPP__
+
+#include "Message.hpp"
+#include "cluster/offloading/TaskOffloading.hpp"
+#include "dependencies/DataAccessType.hpp"
+
+#include <vector>
+
+#include <DataAccessRegion.hpp>
+
+class MessageTaskNew : public Message
+{
+public:
+	//! An access of the offloaded task
+	struct AccessInfo {
+		DataAccessRegion _region;
+		DataAccessType _type;
+		bool _weak;
+	};
+
+private:
+	struct TaskNewMessageContent {
+		//! The task on the offloader node
+		void *_offloadedTask;
+		
+		TaskOffloading::static_object_location_t _taskInfo;
+		TaskOffloading::static_object_location_t _taskInvocationInfo;
+		
+		//! nanos6_task_flag_t flags of the task
+		size_t _flags;
+		
+		size_t _argsBlockSize;
+		size_t _numAccesses;
+		
+		//! Number of input regions that the remote node does not hold
+		size_t _numTransfers;
+		
+		/*! The accesses followed by the input regions to transfer and
+		 * the contents of the args block */
+		AccessInfo _accesses[];
+	};
+	
+	//! pointer to message payload
+	TaskNewMessageContent *_content;
+
+public:
+	MessageTaskNew(
+		const ClusterNode *from, void *offloadedTask,
+		TaskOffloading::static_object_location_t const &taskInfo,
+		TaskOffloading::static_object_location_t const &taskInvocationInfo,
+		size_t flags, void const *argsBlock, size_t argsBlockSize,
+		std::vector<AccessInfo> const &accesses,
+		std::vector<DataAccessRegion> const &transfers
+	);
+	MessageTaskNew(Deliverable *dlv);
+	
+	bool handleMessage();
+	
+	inline void *getOffloadedTask() const
+	{
+		return _content->_offloadedTask;
+	}
+	
+	inline TaskOffloading::static_object_location_t const &getTaskInfo() const
+	{
+		return _content->_taskInfo;
+	}
+	
+	inline TaskOffloading::static_object_location_t const &getTaskInvocationInfo() const
+	{
+		return _content->_taskInvocationInfo;
+	}
+	
+	inline size_t getFlags() const
+	{
+		return _content->_flags;
+	}
+	
+	inline size_t getNumAccesses() const
+	{
+		return _content->_numAccesses;
+	}
+	
+	inline AccessInfo const *getAccesses() const
+	{
+		return _content->_accesses;
+	}
+	
+	inline size_t getNumTransfers() const
+	{
+		return _content->_numTransfers;
+	}
+	
+	inline DataAccessRegion const *getTransfers() const
+	{
+		return reinterpret_cast<DataAccessRegion const *>(&_content->_accesses[_content->_numAccesses]);
+	}
+	
+	inline size_t getArgsBlockSize() const
+	{
+		return _content->_argsBlockSize;
+	}
+	
+	inline void const *getArgsBlock() const
+	{
+		return &getTransfers()[_content->_numTransfers];
+	}
+	
+	void toString(std::ostream &where) const;
+};
+
+inline MessageTaskNew::MessageTaskNew(Deliverable *dlv)
+	: Message(dlv)
+{
+	_content = reinterpret_cast<TaskNewMessageContent *>(_deliverable->payload);
+}
+
+inline void MessageTaskNew::toString(std::ostream &where) const
+{
+	where << "TaskNew " << _content->_offloadedTask << " with " << _content->_numAccesses << " accesses and " << _content->_numTransfers << " transfers";
+}
+
+//! Register the Message type to the Object factory
+namespace {
+	Message *createTaskNewMessage(Message::Deliverable *dlv)
+	{
+		return new MessageTaskNew(dlv);
+	}
+	
+	const bool __attribute__((unused))_registered_task_new =
+		REGISTER_MSG_CLASS(TASK_NEW, createTaskNewMessage);
+}
+
+#endif /* __MESSAGE_TASK_NEW_HPP__ */
@@ -10,5 +10,8 @@
 const char MessageTypeStr[TOTAL_MESSAGE_TYPES][MSG_NAMELEN] =
 {
 	"SYS_FINISH",
-	"DATA_SEND"
+	"DATA_SEND",
+	"TASK_NEW",
+	"TASK_FINISHED",
+	"DATA_FETCH"
 };
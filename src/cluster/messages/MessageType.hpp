@@ -13,6 +13,9 @@
 typedef enum {
 	SYS_FINISH = 0,
 	DATA_SEND,
+	TASK_NEW,
+	TASK_FINISHED,
+	DATA_FETCH,
 	TOTAL_MESSAGE_TYPES
 } MessageType;
 
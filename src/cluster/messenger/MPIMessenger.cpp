@@ -1,15 +1,30 @@
 #include "MPIMessenger.hpp"
 #include "cluster/messages/Message.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
 #include <ClusterNode.hpp>
 
 #include "alloca.h"
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
 #include <vector>
 
+#include <nanos6/polling.h>
+
 #pragma GCC visibility push(default)
 #include <mpi.h>
 #pragma GCC visibility pop
 
+//! Tag of the batches of messages
+static const int BATCH_TAG = 0;
+
+//! The messages of a batch start at multiples of 8 bytes
+static inline size_t roundToMessage(size_t size)
+{
+	return (size + 7) & ~((size_t) 7);
+}
+
 MPIMessenger::MPIMessenger()
 {
 	int support;
@@ -33,114 +48,251 @@ MPIMessenger::MPIMessenger()
 	MPI_Comm_set_errhandler(INTRA_COMM, MPI_ERRORS_RETURN);
 	MPI_Comm_rank(INTRA_COMM, &wrank);
 	MPI_Comm_size(INTRA_COMM, &wsize);
+	
+	/*! Data transfers use their own communicator, so that they
+	 * never match the probes for incoming messages */
+	MPI_Comm_dup(INTRA_COMM, &DATA_COMM);
+	MPI_Comm_set_errhandler(DATA_COMM, MPI_ERRORS_RETURN);
+	
+	int *tagUpperBoundAttribute, flag;
+	MPI_Comm_get_attr(DATA_COMM, MPI_TAG_UB, &tagUpperBoundAttribute, &flag);
+	//! The standard guarantees at least 32767
+	tagUpperBound = (flag ? *tagUpperBoundAttribute : 32767);
+	
+	/*! The messages for the same node are sent together once they
+	 * reach a size or have waited for some time. A window of 0 sends
+	 * them right away */
+	EnvironmentVariable<StringifiedMemorySize> batchSize("NANOS6_CLUSTER_BATCH_SIZE", 64 * 1024);
+	EnvironmentVariable<unsigned int> batchWindow("NANOS6_CLUSTER_BATCH_WINDOW", 50);
+	_batchSize = batchSize.getValue();
+	_batchWindow = std::chrono::microseconds(batchWindow.getValue());
+	
+	_batches = new batch_t[(unsigned int) wsize];
+	for (int i = 0; i < wsize; ++i) {
+		_batches[i]._buffer = new std::vector<char>();
+	}
+	
+	//! Transfers progress while the CPUs are idle
+	nanos6_register_polling_service("MPI messenger", &MPIMessenger::progress, this);
 }
 
 MPIMessenger::~MPIMessenger()
 {
-	//! Release the intra-communicator
+	nanos6_unregister_polling_service("MPI messenger", &MPIMessenger::progress, this);
+	
+	flushBatches(true);
+	
+	/*! The last messages, such as the SYS_FINISH, must reach their
+	 * destination. Their callbacks may issue further transfers */
+	while (!_pendingRequests.empty()) {
+		progressPendingRequests(true);
+	}
+	
+	for (int i = 0; i < wsize; ++i) {
+		delete _batches[i]._buffer;
+	}
+	delete [] _batches;
+	
+	//! Release the communicators
+	MPI_Comm_free(&DATA_COMM);
 	MPI_Comm_free(&INTRA_COMM);
 	MPI_Finalize();
 }
 
-void MPIMessenger::sendMessage(Message *msg, ClusterNode *toNode)
+void MPIMessenger::addPendingRequest(MPI_Request request, transfer_callback_t const &callback)
 {
-	int ret;
-	Message::Deliverable *delv = msg->getDeliverable();
-	const int MPI_to = toNode->getCommIndex();
+	std::lock_guard<SpinLock> guard(_pendingLock);
+	_pendingRequests.push_back(request);
+	_pendingCallbacks.push_back(callback);
+}
+
+void MPIMessenger::progressPendingRequests(bool wait)
+{
+	std::vector<transfer_callback_t> completed;
 	
-	assert(MPI_to < wsize && MPI_to != wrank);
-	assert(delv->header.size != 0);
+	{
+		std::lock_guard<SpinLock> guard(_pendingLock);
+		
+		const int pending = _pendingRequests.size();
+		if (pending == 0) {
+			return;
+		}
+		
+		int *indices = (int *) alloca(pending * sizeof(int));
+		int count;
+		int ret;
+		if (wait) {
+			ret = MPI_Waitall(pending, _pendingRequests.data(), MPI_STATUSES_IGNORE);
+			count = pending;
+			for (int i = 0; i < pending; ++i) {
+				indices[i] = i;
+			}
+		} else {
+			ret = MPI_Testsome(pending, _pendingRequests.data(), &count, indices, MPI_STATUSES_IGNORE);
+		}
+		
+		if (ret != MPI_SUCCESS) {
+			MPI_Abort(INTRA_COMM, ret);
+		}
+		
+		if ((count == 0) || (count == MPI_UNDEFINED)) {
+			return;
+		}
+		
+		//! Remove the completed requests, from the last one to the first
+		std::sort(indices, indices + count);
+		for (int i = count - 1; i >= 0; --i) {
+			int index = indices[i];
+			
+			if (_pendingCallbacks[index]) {
+				completed.push_back(std::move(_pendingCallbacks[index]));
+			}
+			
+			_pendingRequests[index] = _pendingRequests.back();
+			_pendingRequests.pop_back();
+			_pendingCallbacks[index] = std::move(_pendingCallbacks.back());
+			_pendingCallbacks.pop_back();
+		}
+	}
 	
-	/*! At the moment we use the Message type as the MPI
-	 * tag of the communication */
-	int tag = delv->header.type;
-	ret = MPI_Send((void *)delv, sizeof(delv->header) + delv->header.size,
-			MPI_BYTE, MPI_to, tag, INTRA_COMM);
-	if (ret != MPI_SUCCESS) {
-		MPI_Abort(INTRA_COMM, ret);
+	//! The callbacks may issue new transfers, so they run without the lock
+	for (transfer_callback_t &callback : completed) {
+		callback();
 	}
 }
 
-void MPIMessenger::sendMessage(Message *msg, std::vector<ClusterNode *> const &toNodes)
+int MPIMessenger::progress(void *messenger)
 {
-	Message::Deliverable *delv = msg->getDeliverable();
-	assert(delv->header.size != 0);
+	((MPIMessenger *)messenger)->flushBatches(false);
+	((MPIMessenger *)messenger)->progressPendingRequests(false);
+	
+	return false;
+}
+
+void MPIMessenger::flushBatch(batch_t &batch, int MPI_to)
+{
+	std::vector<char> *buffer = batch._buffer;
+	if (buffer->empty()) {
+		return;
+	}
 	
-	const int nr_nodes = toNodes.size();
-	assert(nr_nodes != 0);
+	//! The buffer is released once sent
+	batch._buffer = new std::vector<char>();
 	
-	/*! At the moment we use the Message type as the MPI
-	 * tag of the communication */
-	const int tag = delv->header.type;
+	MPI_Request request;
+	int ret = MPI_Isend(buffer->data(), buffer->size(), MPI_BYTE, MPI_to, BATCH_TAG, INTRA_COMM, &request);
+	if (ret != MPI_SUCCESS) {
+		MPI_Abort(INTRA_COMM, ret);
+	}
 	
-	/*! nr_nodes should be in the order of 1000s, so alloca should
-	 * probably be the best option now */
-	MPI_Request *requests = (MPI_Request *) alloca(nr_nodes * sizeof(MPI_Request));
-	MPI_Status *status = (MPI_Status *) alloca(nr_nodes * sizeof(MPI_Status));
+	addPendingRequest(request, [buffer]() { delete buffer; });
+}
+
+void MPIMessenger::flushBatches(bool all)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
 	
-	int i = 0;
-	for (auto &node : toNodes) {
-		int MPI_to = node->getCommIndex();
-		assert(MPI_to != wrank);
+	for (int i = 0; i < wsize; ++i) {
+		batch_t &batch = _batches[i];
 		
-		int ret = MPI_Isend((void *)delv,
-				sizeof(delv->header) + delv->header.size,
-				MPI_BYTE, MPI_to, tag, INTRA_COMM,
-				&requests[i]);
-		if (ret != MPI_SUCCESS) {
-			MPI_Abort(INTRA_COMM, ret);
+		if (all) {
+			batch._lock.lock();
+		} else if (!batch._lock.tryLock()) {
+			continue;
 		}
 		
-		++i;
-	}
-	
-	//! Check that all sends were fine or print some information;
-	int ret = MPI_Waitall(nr_nodes, requests, status);
-	if(ret == MPI_ERR_IN_STATUS) {
-		for(i = 0; i < nr_nodes; ++i){
-			if(status[i].MPI_ERROR != MPI_SUCCESS){
-				std::cerr << "MPI_Error "
-					<< status[i].MPI_ERROR
-					<< " sending collective message "
-					<< status[i].MPI_TAG
-					<< " to rank:"
-					<< status[i].MPI_SOURCE
-					<< std::endl;
-			}
+		if (all || (now - batch._firstQueued >= _batchWindow)) {
+			flushBatch(batch, i);
 		}
 		
-		MPI_Abort(INTRA_COMM, ret);
+		batch._lock.unlock();
 	}
 }
 
-void MPIMessenger::sendData(const DataAccessRegion &region, const ClusterNode *to)
+void MPIMessenger::addToBatch(Message::Deliverable *delv, int MPI_to)
+{
+	const size_t size = sizeof(delv->header) + delv->header.size;
+	
+	assert(MPI_to < wsize && MPI_to != wrank);
+	assert(delv->header.size != 0);
+	
+	batch_t &batch = _batches[MPI_to];
+	std::lock_guard<SpinLock> guard(batch._lock);
+	
+	std::vector<char> *buffer = batch._buffer;
+	if (buffer->empty()) {
+		batch._firstQueued = std::chrono::steady_clock::now();
+	}
+	
+	size_t offset = buffer->size();
+	buffer->resize(offset + roundToMessage(size));
+	memcpy(buffer->data() + offset, delv, size);
+	
+	if ((buffer->size() >= _batchSize) || (_batchWindow.count() == 0)) {
+		flushBatch(batch, MPI_to);
+	}
+}
+
+void MPIMessenger::sendMessage(Message *msg, ClusterNode *toNode)
+{
+	/*! The message is copied to the batch of the node, which is
+	 * demultiplexed by the receiver */
+	addToBatch(msg->getDeliverable(), toNode->getCommIndex());
+	
+	delete msg;
+}
+
+void MPIMessenger::sendMessage(Message *msg, std::vector<ClusterNode *> const &toNodes)
+{
+	assert(!toNodes.empty());
+	
+	for (auto &node : toNodes) {
+		addToBatch(msg->getDeliverable(), node->getCommIndex());
+	}
+		
+	delete msg;
+}
+		
+void MPIMessenger::sendData(const DataAccessRegion &region, const ClusterNode *to, int messageId,
+	transfer_callback_t callback)
 {
 	int ret;
 	const int MPI_to = to->getCommIndex();
 	void *address = region.getStartAddress();
 	size_t size = region.getSize();
+	MPI_Request request;
 	
 	assert(MPI_to < wsize && MPI_to != wrank);
 	
-	ret = MPI_Send(address, size, MPI_BYTE, MPI_to, DATA_SEND, INTRA_COMM);
-       	if (ret != MPI_SUCCESS)	{
+	/*! The transfers of a message are told apart by its id. The
+	 * transfers of the same message are matched in order */
+	const int tag = messageId % tagUpperBound;
+	ret = MPI_Isend(address, size, MPI_BYTE, MPI_to, tag, DATA_COMM, &request);
+	if (ret != MPI_SUCCESS) {
 		MPI_Abort(INTRA_COMM, ret);
 	}
+	
+	addPendingRequest(request, callback);
 }
 
-void MPIMessenger::fetchData(const DataAccessRegion &region, const ClusterNode *from)
+void MPIMessenger::fetchData(const DataAccessRegion &region, const ClusterNode *from, int messageId,
+	transfer_callback_t callback)
 {
 	int ret;
 	const int MPI_from = from->getCommIndex();
 	void *address = region.getStartAddress();
 	size_t size = region.getSize();
+	MPI_Request request;
 	
 	assert(MPI_from < wsize && MPI_from != wrank);
 	
-	ret = MPI_Recv(address, size, MPI_BYTE, MPI_from, DATA_SEND, INTRA_COMM, MPI_STATUS_IGNORE);
+	const int tag = messageId % tagUpperBound;
+	ret = MPI_Irecv(address, size, MPI_BYTE, MPI_from, tag, DATA_COMM, &request);
 	if (ret != MPI_SUCCESS) {
 		MPI_Abort(INTRA_COMM, ret);
 	}
+	
+	addPendingRequest(request, callback);
 }
 
 void MPIMessenger::synchronizeAll(void)
@@ -153,11 +305,17 @@ void MPIMessenger::synchronizeAll(void)
 
 Message *MPIMessenger::checkMail(void)
 {
-	int ret, flag, count, type;
+	int ret, flag, count;
 	MPI_Status status;
-	Message::Deliverable *msg;
+	char *buffer;
 	
-	ret = MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, INTRA_COMM, &flag, &status);
+	if (!_receivedMessages.empty()) {
+		Message *msg = _receivedMessages.front();
+		_receivedMessages.pop_front();
+		return msg;
+	}
+	
+	ret = MPI_Iprobe(MPI_ANY_SOURCE, BATCH_TAG, INTRA_COMM, &flag, &status);
 	if (ret != MPI_SUCCESS) {
 		MPI_Abort(INTRA_COMM, ret);
 	}
@@ -166,30 +324,58 @@ Message *MPIMessenger::checkMail(void)
 		return nullptr;
 	}
 	
-	type = status.MPI_TAG;
-	if (type == DATA_SEND) {
-		return nullptr;
-	}
-	
 	ret = MPI_Get_count(&status, MPI_BYTE, &count);
 	if (ret != MPI_SUCCESS) {
 		std::cerr << "Error while trying to determing size of message\n" << std::endl;
 		MPI_Abort(INTRA_COMM, ret);
 	}
 	
-	msg = (Message::Deliverable *)malloc(count);
-	if (!msg) {
+	buffer = (char *)malloc(count);
+	if (!buffer) {
 		perror("malloc for message");
 		MPI_Abort(INTRA_COMM, 1);
 	}
 	
 	assert(count != 0);
-	ret = MPI_Recv((void *)msg, count, MPI_BYTE, status.MPI_SOURCE,
+	ret = MPI_Recv((void *)buffer, count, MPI_BYTE, status.MPI_SOURCE,
 			status.MPI_TAG, INTRA_COMM, MPI_STATUS_IGNORE);
 	if (ret != MPI_SUCCESS) {
 		std::cerr << "Error receiving incoming message" << std::endl;
 		MPI_Abort(INTRA_COMM, ret);
 	}
 	
-	return GenericFactory<int, Message*, Message::Deliverable*>::getInstance().create(status.MPI_TAG, msg);
+	/*! Demultiplex the batch. Each message owns its Deliverable, so
+	 * they are copied unless the batch has a single one */
+	size_t offset = 0;
+	while (offset < (size_t) count) {
+		Message::Deliverable *delv = (Message::Deliverable *)(buffer + offset);
+		size_t size = sizeof(delv->header) + delv->header.size;
+		assert(offset + size <= (size_t) count);
+		
+		if ((offset == 0) && (roundToMessage(size) >= (size_t) count)) {
+			_receivedMessages.push_back(
+				GenericFactory<int, Message*, Message::Deliverable*>::getInstance().create(delv->header.type, delv)
+			);
+			buffer = nullptr;
+			break;
+		}
+
+		Message::Deliverable *copy = (Message::Deliverable *)malloc(size);
+		if (!copy) {
+			perror("malloc for message");
+			MPI_Abort(INTRA_COMM, 1);
+		}
+		memcpy(copy, delv, size);
+		
+		_receivedMessages.push_back(
+			GenericFactory<int, Message*, Message::Deliverable*>::getInstance().create(copy->header.type, copy)
+		);
+		offset += roundToMessage(size);
+	}
+	
+	free(buffer);
+	
+	Message *msg = _receivedMessages.front();
+	_receivedMessages.pop_front();
+	return msg;
 }
@@ -7,6 +7,8 @@
 #ifndef __MPI_MESSENGER_H__
 #define __MPI_MESSENGER_H__
 
+#include <chrono>
+#include <deque>
 #include <vector>
 
 #pragma GCC visibility push(default)
@@ -14,14 +16,66 @@
 #pragma GCC visibility pop
 
 #include "Messenger.hpp"
+#include "cluster/messages/Message.hpp"
+#include "lowlevel/SpinLock.hpp"
 
-class Message;
 class ClusterPlace;
 
 class MPIMessenger : public Messenger {
 private:
 	int wrank, wsize;
-	MPI_Comm INTRA_COMM, PARENT_COMM;
+	MPI_Comm INTRA_COMM, DATA_COMM, PARENT_COMM;
+	
+	//! Upper bound of the tags of the data transfers
+	int tagUpperBound;
+	
+	/** The requests that have not completed yet and what to do once
+	 * they complete. Both vectors are kept in the same order, so that
+	 * the requests can be tested at once */
+	std::vector<MPI_Request> _pendingRequests;
+	std::vector<transfer_callback_t> _pendingCallbacks;
+	SpinLock _pendingLock;
+	
+	//! Messages for a node that are waiting to be sent together
+	struct batch_t {
+		SpinLock _lock;
+		std::vector<char> *_buffer;
+		std::chrono::steady_clock::time_point _firstQueued;
+	};
+	
+	//! One batch per node, and its limits in bytes and time
+	batch_t *_batches;
+	size_t _batchSize;
+	std::chrono::microseconds _batchWindow;
+	
+	/** The messages of the received batches that have not been returned
+	 * yet. Only the thread that checks the mail accesses them */
+	std::deque<Message *> _receivedMessages;
+	
+	/** Send the messages of a batch as a single buffer
+	 *
+	 * \param batch is the batch, whose lock must be held
+	 * \param MPI_to is the rank of the node of the batch
+	 */
+	void flushBatch(batch_t &batch, int MPI_to);
+	
+	//! Copy a message to the batch of a node, and send it if it is full
+	void addToBatch(Message::Deliverable *delv, int MPI_to);
+	
+	//! Send the batches that are older than the window, or all of them
+	void flushBatches(bool all);
+	
+	//! Add a request to the table of pending requests
+	void addPendingRequest(MPI_Request request, transfer_callback_t const &callback);
+	
+	/** Complete the pending requests that have finished
+	 *
+	 * \param wait is true to wait until all of them have completed
+	 */
+	void progressPendingRequests(bool wait);
+	
+	//! Polling service that sends the batches and progresses the pending requests
+	static int progress(void *messenger);
 	
 public:
 	MPIMessenger();
@@ -30,8 +84,10 @@ public:
 	void sendMessage(Message *msg, ClusterNode *toNode);
 	void sendMessage(Message *msg, std::vector<ClusterNode *> const &toNodes);
 	void synchronizeAll(void);
-	void sendData(const DataAccessRegion &region, const ClusterNode *toNode);
-	void fetchData(const DataAccessRegion &region, const ClusterNode *fromNode);
+	void sendData(const DataAccessRegion &region, const ClusterNode *toNode, int messageId,
+		transfer_callback_t callback = transfer_callback_t());
+	void fetchData(const DataAccessRegion &region, const ClusterNode *fromNode, int messageId,
+		transfer_callback_t callback = transfer_callback_t());
 	Message *checkMail();
 	
 	inline int getNodeIndex() const
@@ -7,6 +7,7 @@
 #ifndef __MESSENGER_HPP__
 #define __MESSENGER_HPP__
 
+#include <functional>
 #include <vector>
 #include <string>
 #include <DataAccessRegion.hpp>
@@ -17,24 +18,33 @@ class ClusterNode;
 
 class Messenger {
 public:
+	//! Function that is called once a data transfer has completed
+	typedef std::function<void()> transfer_callback_t;
+	
 	Messenger()
 	{
 	}
 	
-	~Messenger()
+	virtual ~Messenger()
 	{
 	}
 	
 	/** Send a message to a remote node.
 	 *
-	 * \param msg is the Message to send
+	 * The call does not wait for the message to be sent. The messenger
+	 * takes the ownership of the message and deletes it once sent
+	 *
+	 * \param msg is the Message to send, allocated with new
 	 * \param toNode is the receiver node
 	 */
 	virtual void sendMessage(Message *msg, ClusterNode *toNode) = 0;
 	
 	/** Send a message to multiple remote nodes.
 	 *
-	 * \param msg is the Message to send
+	 * The messenger takes the ownership of the message and deletes it
+	 * once it has been sent to all the nodes
+	 *
+	 * \param msg is the Message to send, allocated with new
 	 * \param toNodes is a vector of nodes to send the message to
 	 */
 	virtual void sendMessage(Message *msg, std::vector<ClusterNode *> const &toNodes) = 0;
@@ -43,19 +53,32 @@ public:
 	virtual void synchronizeAll(void) = 0;
 	
 	/** Send a data region to a remote node, related to a previous message.
+	 *
+	 * The call does not wait for the transfer to complete. The region
+	 * must not be modified until then
 	 *
 	 * \param region is the data region to send
 	 * \param toNode is the receiver node
+	 * \param messageId is the id of the message related with this
+	 * 	  data transfer
+	 * \param callback is called once the transfer has completed, if any
 	 */
-	virtual void sendData(const DataAccessRegion &region, const ClusterNode *toNode) = 0;
+	virtual void sendData(const DataAccessRegion &region, const ClusterNode *toNode, int messageId,
+		transfer_callback_t callback = transfer_callback_t()) = 0;
 	
 	/** Receive a data region from a remote node, related to a previous message
+	 *
+	 * The call does not wait for the transfer to complete. The region
+	 * must not be accessed until then
 	 *
 	 * \param region is the data region to fetch
 	 * \param fromNode is the node to fetch the data from
-	 * 	  with this data transfer
+	 * \param messageId is the id of the message related with this
+	 * 	  data transfer
+	 * \param callback is called once the transfer has completed, if any
 	 */
-	virtual void fetchData(const DataAccessRegion &region, const ClusterNode *fromNode) = 0;
+	virtual void fetchData(const DataAccessRegion &region, const ClusterNode *fromNode, int messageId,
+		transfer_callback_t callback = transfer_callback_t()) = 0;
 	
 	/** Check for incoming messages
 	 *
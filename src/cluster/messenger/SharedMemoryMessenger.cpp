@@ -0,0 +1,485 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "SharedMemoryMessenger.hpp"
+#include "cluster/messages/Message.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include <ClusterNode.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <nanos6/polling.h>
+
+
+//! Value of the magic field of an initialized segment
+static const uint64_t SEGMENT_MAGIC = 0x4e36534d53474d54UL;
+
+
+//! Get the first of the variables that is defined, or -1 if none
+static int getLauncherValue(std::vector<char const *> const &names)
+{
+	for (char const *name : names) {
+		char const *value = getenv(name);
+		if (value != nullptr) {
+			return atoi(value);
+		}
+	}
+	
+	return -1;
+}
+
+static inline size_t roundToRecord(size_t size)
+{
+	return (size + 7) & ~((size_t) 7);
+}
+
+
+SharedMemoryMessenger::SharedMemoryMessenger()
+	: _nextMailbox(0)
+{
+	/*! The nodes are usually started by a launcher, so its variables
+	 * are used unless they are given explicitly */
+	_nodeIndex = getLauncherValue({"NANOS6_SHM_RANK", "OMPI_COMM_WORLD_RANK", "PMI_RANK", "SLURM_PROCID"});
+	_clusterSize = getLauncherValue({"NANOS6_SHM_SIZE", "OMPI_COMM_WORLD_SIZE", "PMI_SIZE", "SLURM_NTASKS"});
+	FatalErrorHandler::failIf(
+		(_clusterSize < 1) || (_nodeIndex < 0) || (_nodeIndex >= _clusterSize),
+		"The shm communication needs the NANOS6_SHM_RANK and NANOS6_SHM_SIZE environment variables"
+	);
+	
+	std::ostringstream defaultName;
+	defaultName << "/nanos6-cluster-" << getuid();
+	EnvironmentVariable<std::string> segmentName("NANOS6_SHM_NAME", defaultName.str());
+	EnvironmentVariable<StringifiedMemorySize> ringCapacity("NANOS6_SHM_RING_SIZE", 1024 * 1024);
+	
+	_segmentName = segmentName.getValue();
+	_ringCapacity = (ringCapacity.getValue() + 63) & ~((size_t) 63);
+	FatalErrorHandler::failIf(
+		_ringCapacity < 4096,
+		"NANOS6_SHM_RING_SIZE must be at least 4096 bytes"
+	);
+	
+	const size_t ringStride = sizeof(ring_t) + _ringCapacity;
+	const size_t headerSize = (sizeof(segment_header_t) + 63) & ~((size_t) 63);
+	_segmentSize = headerSize + _clusterSize * _clusterSize * ringStride;
+	
+	int fd;
+	if (_nodeIndex == 0) {
+		//! Remove the segment of a previous run that did not finish
+		shm_unlink(_segmentName.c_str());
+		
+		fd = shm_open(_segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd == -1) {
+			FatalErrorHandler::handle(errno, " when creating the shared memory segment ", _segmentName);
+		}
+		
+		if (ftruncate(fd, _segmentSize) != 0) {
+			FatalErrorHandler::handle(errno, " when setting the size of the shared memory segment ", _segmentName);
+		}
+	} else {
+		//! Wait for the master to create it
+		struct stat status;
+		do {
+			fd = shm_open(_segmentName.c_str(), O_RDWR, 0600);
+			if (fd == -1) {
+				if (errno != ENOENT) {
+					FatalErrorHandler::handle(errno, " when opening the shared memory segment ", _segmentName);
+				}
+				usleep(1000);
+				continue;
+			}
+			
+			if (fstat(fd, &status) != 0) {
+				FatalErrorHandler::handle(errno, " when checking the shared memory segment ", _segmentName);
+			}
+			if ((size_t) status.st_size != _segmentSize) {
+				close(fd);
+				fd = -1;
+				usleep(1000);
+			}
+		} while (fd == -1);
+	}
+	
+	void *segment = mmap(nullptr, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (segment == MAP_FAILED) {
+		FatalErrorHandler::handle(errno, " when mapping the shared memory segment ", _segmentName);
+	}
+	close(fd);
+	
+	//! The segment is zero-filled on creation, which is a valid initial state
+	_segment = (segment_header_t *) segment;
+	if (_nodeIndex == 0) {
+		_segment->_clusterSize = _clusterSize;
+		_segment->_ringCapacity = _ringCapacity;
+		_segment->_magic.store(SEGMENT_MAGIC, std::memory_order_release);
+	} else {
+		while (_segment->_magic.load(std::memory_order_acquire) != SEGMENT_MAGIC) {
+			sched_yield();
+		}
+		FatalErrorHandler::failIf(
+			(_segment->_clusterSize != (uint64_t) _clusterSize) || (_segment->_ringCapacity != _ringCapacity),
+			"All the nodes must have the same NANOS6_SHM_SIZE and NANOS6_SHM_RING_SIZE"
+		);
+	}
+	
+	_peers = new peer_t[(unsigned int) _clusterSize];
+	for (int i = 0; i < _clusterSize; ++i) {
+		_peers[i]._sendRing = getRing(_nodeIndex, i);
+		_peers[i]._receiveRing = getRing(i, _nodeIndex);
+	}
+	
+	//! Once everybody has attached, the name is no longer needed
+	_segment->_attachedNodes++;
+	while (_segment->_attachedNodes.load() != _clusterSize) {
+		sched_yield();
+	}
+	if (_nodeIndex == 0) {
+		shm_unlink(_segmentName.c_str());
+	}
+	
+	//! Transfers progress while the CPUs are idle
+	nanos6_register_polling_service("shared memory messenger", &SharedMemoryMessenger::progress, this);
+}
+
+SharedMemoryMessenger::~SharedMemoryMessenger()
+{
+	nanos6_unregister_polling_service("shared memory messenger", &SharedMemoryMessenger::progress, this);
+	
+	//! The last messages, such as the SYS_FINISH, must reach their destination
+	bool pending;
+	do {
+		progressTransfers();
+		
+		pending = false;
+		for (int i = 0; i < _clusterSize; ++i) {
+			std::lock_guard<SpinLock> guard(_peers[i]._outgoingLock);
+			pending |= !_peers[i]._outgoing.empty();
+		}
+	} while (pending);
+	
+	//! The other nodes may still be reading from our rings
+	synchronizeAll();
+	
+	delete [] _peers;
+	munmap(_segment, _segmentSize);
+}
+
+SharedMemoryMessenger::ring_t *SharedMemoryMessenger::getRing(int from, int to) const
+{
+	const size_t ringStride = sizeof(ring_t) + _ringCapacity;
+	const size_t headerSize = (sizeof(segment_header_t) + 63) & ~((size_t) 63);
+	
+	return (ring_t *) ((char *) _segment + headerSize + (from * _clusterSize + to) * ringStride);
+}
+
+void SharedMemoryMessenger::copyToRing(ring_t *ring, uint64_t position, void const *source, size_t size) const
+{
+	char *buffer = (char *) (ring + 1);
+	size_t offset = position % _ringCapacity;
+	size_t first = std::min(size, _ringCapacity - offset);
+	
+	memcpy(buffer + offset, source, first);
+	memcpy(buffer, (char const *) source + first, size - first);
+}
+
+void SharedMemoryMessenger::copyFromRing(ring_t *ring, uint64_t position, void *destination, size_t size) const
+{
+	char const *buffer = (char const *) (ring + 1);
+	size_t offset = position % _ringCapacity;
+	size_t first = std::min(size, _ringCapacity - offset);
+	
+	memcpy(destination, buffer + offset, first);
+	memcpy((char *) destination + first, buffer, size - first);
+}
+
+void SharedMemoryMessenger::enqueue(int to, outgoing_t const &item)
+{
+	assert(to != _nodeIndex);
+	assert(to < _clusterSize);
+	
+	peer_t &peer = _peers[to];
+	std::vector<transfer_callback_t> completed;
+	{
+		std::lock_guard<SpinLock> guard(peer._outgoingLock);
+		peer._outgoing.push_back(item);
+		pushOutgoing(peer, completed);
+	}
+	
+	for (transfer_callback_t &callback : completed) {
+		callback();
+	}
+}
+
+void SharedMemoryMessenger::pushOutgoing(peer_t &peer, std::vector<transfer_callback_t> &completed)
+{
+	ring_t *ring = peer._sendRing;
+	uint64_t tail = ring->_tail.load(std::memory_order_relaxed);
+	
+	while (!peer._outgoing.empty()) {
+		outgoing_t &item = peer._outgoing.front();
+		size_t available = _ringCapacity - (tail - ring->_head.load(std::memory_order_acquire));
+		if (available <= sizeof(record_header_t)) {
+			break;
+		}
+		
+		record_header_t header;
+		if (item._message != nullptr) {
+			Message::Deliverable *delv = item._message->getDeliverable();
+			header._kind = message_record;
+			header._messageId = 0;
+			header._size = sizeof(delv->header) + delv->header.size;
+			
+			//! Messages enter the ring at once
+			if (sizeof(record_header_t) + roundToRecord(header._size) > available) {
+				break;
+			}
+			
+			copyToRing(ring, tail, &header, sizeof(header));
+			copyToRing(ring, tail + sizeof(header), delv, header._size);
+			delete item._message;
+		} else {
+			//! Data transfers are split in chunks as large as the free space
+			size_t remaining = item._region.getSize() - item._sent;
+			header._kind = data_record;
+			header._messageId = item._messageId;
+			header._size = std::min(remaining, (available - sizeof(record_header_t)) & ~((size_t) 7));
+			if (header._size == 0) {
+				break;
+			}
+			
+			copyToRing(ring, tail, &header, sizeof(header));
+			copyToRing(ring, tail + sizeof(header), (char *) item._region.getStartAddress() + item._sent, header._size);
+			item._sent += header._size;
+		}
+		
+		tail += sizeof(header) + roundToRecord(header._size);
+		ring->_tail.store(tail, std::memory_order_release);
+		
+		if ((item._message == nullptr) && (item._sent < item._region.getSize())) {
+			continue;
+		}
+		
+		if (item._callback) {
+			completed.push_back(std::move(item._callback));
+		}
+		peer._outgoing.pop_front();
+	}
+}
+
+void SharedMemoryMessenger::pollIncoming(peer_t &peer, Message **message, std::vector<transfer_callback_t> &completed)
+{
+	ring_t *ring = peer._receiveRing;
+	uint64_t head = ring->_head.load(std::memory_order_relaxed);
+	
+	while (head != ring->_tail.load(std::memory_order_acquire)) {
+		record_header_t header;
+		copyFromRing(ring, head, &header, sizeof(header));
+		
+		if (header._kind == message_record) {
+			if (message == nullptr) {
+				return;
+			}
+			
+			Message::Deliverable *delv = (Message::Deliverable *) malloc(header._size);
+			FatalErrorHandler::failIf(delv == nullptr, "Could not allocate for receiving message");
+			copyFromRing(ring, head + sizeof(header), delv, header._size);
+			
+			head += sizeof(header) + roundToRecord(header._size);
+			ring->_head.store(head, std::memory_order_release);
+			
+			*message = GenericFactory<int, Message*, Message::Deliverable*>::getInstance().create(delv->header.type, delv);
+			return;
+		}
+		
+		assert(header._kind == data_record);
+		
+		//! The transfers of the same message are matched in order
+		auto it = peer._incoming.begin();
+		while ((it != peer._incoming.end()) && (it->_messageId != header._messageId)) {
+			++it;
+		}
+		if (it == peer._incoming.end()) {
+			return;
+		}
+		
+		assert(it->_received + header._size <= it->_region.getSize());
+		copyFromRing(ring, head + sizeof(header), (char *) it->_region.getStartAddress() + it->_received, header._size);
+		it->_received += header._size;
+		
+		head += sizeof(header) + roundToRecord(header._size);
+		ring->_head.store(head, std::memory_order_release);
+		
+		if (it->_received == it->_region.getSize()) {
+			if (it->_callback) {
+				completed.push_back(std::move(it->_callback));
+			}
+			peer._incoming.erase(it);
+		}
+	}
+}
+
+int SharedMemoryMessenger::progress(void *messenger)
+{
+	((SharedMemoryMessenger *) messenger)->progressTransfers();
+	
+	return false;
+}
+
+void SharedMemoryMessenger::progressTransfers()
+{
+	std::vector<transfer_callback_t> completed;
+	
+	for (int i = 0; i < _clusterSize; ++i) {
+		if (i == _nodeIndex) {
+			continue;
+		}
+		
+		peer_t &peer = _peers[i];
+		if (peer._outgoingLock.tryLock()) {
+			pushOutgoing(peer, completed);
+			peer._outgoingLock.unlock();
+		}
+		
+		if (peer._incomingLock.tryLock()) {
+			pollIncoming(peer, nullptr, completed);
+			peer._incomingLock.unlock();
+		}
+	}
+	
+	//! The callbacks may issue new transfers, so they run without the locks
+	for (transfer_callback_t &callback : completed) {
+		callback();
+	}
+}
+
+void SharedMemoryMessenger::sendMessage(Message *msg, ClusterNode *toNode)
+{
+	assert(msg->getDeliverable()->header.size != 0);
+	
+	FatalErrorHandler::failIf(
+		sizeof(record_header_t) + roundToRecord(sizeof(Message::msg_header) + msg->getDeliverable()->header.size) > _ringCapacity,
+		"A message does not fit in the rings of the shm communication. Increase NANOS6_SHM_RING_SIZE"
+	);
+	
+	enqueue(toNode->getCommIndex(), {msg, DataAccessRegion(), 0, 0, transfer_callback_t()});
+}
+
+void SharedMemoryMessenger::sendMessage(Message *msg, std::vector<ClusterNode *> const &toNodes)
+{
+	assert(!toNodes.empty());
+	
+	//! Each node gets its own copy, since each one is deleted once sent
+	for (size_t i = 0; i < toNodes.size(); ++i) {
+		Message *copy = msg;
+		if (i + 1 < toNodes.size()) {
+			Message::Deliverable *delv = msg->getDeliverable();
+			size_t size = sizeof(delv->header) + delv->header.size;
+			
+			Message::Deliverable *copyDelv = (Message::Deliverable *) malloc(size);
+			FatalErrorHandler::failIf(copyDelv == nullptr, "Could not allocate for creating message");
+			memcpy(copyDelv, delv, size);
+			
+			copy = GenericFactory<int, Message*, Message::Deliverable*>::getInstance().create(delv->header.type, copyDelv);
+		}
+		
+		sendMessage(copy, toNodes[i]);
+	}
+}
+
+void SharedMemoryMessenger::sendData(const DataAccessRegion &region, const ClusterNode *toNode, int messageId,
+	transfer_callback_t callback)
+{
+	if (region.getSize() == 0) {
+		if (callback) {
+			callback();
+		}
+		return;
+	}
+	
+	enqueue(toNode->getCommIndex(), {nullptr, region, 0, messageId, callback});
+}
+
+void SharedMemoryMessenger::fetchData(const DataAccessRegion &region, const ClusterNode *fromNode, int messageId,
+	transfer_callback_t callback)
+{
+	if (region.getSize() == 0) {
+		if (callback) {
+			callback();
+		}
+		return;
+	}
+	
+	int from = fromNode->getCommIndex();
+	assert(from != _nodeIndex);
+	assert(from < _clusterSize);
+	
+	peer_t &peer = _peers[from];
+	std::vector<transfer_callback_t> completed;
+	{
+		std::lock_guard<SpinLock> guard(peer._incomingLock);
+		peer._incoming.push_back({region, 0, messageId, callback});
+		
+		//! The data may be waiting in the ring already
+		pollIncoming(peer, nullptr, completed);
+	}
+	
+	for (transfer_callback_t &completedCallback : completed) {
+		completedCallback();
+	}
+}
+
+void SharedMemoryMessenger::synchronizeAll(void)
+{
+	unsigned int generation = _segment->_barrierGeneration.load();
+	
+	if (++_segment->_barrierCount == _clusterSize) {
+		_segment->_barrierCount = 0;
+		_segment->_barrierGeneration++;
+	} else {
+		while (_segment->_barrierGeneration.load() == generation) {
+			sched_yield();
+		}
+	}
+}
+
+Message *SharedMemoryMessenger::checkMail(void)
+{
+	Message *message = nullptr;
+	std::vector<transfer_callback_t> completed;
+	
+	//! Start from a different node each time, so that none starves
+	unsigned int first = _nextMailbox++;
+	for (int i = 0; (i < _clusterSize) && (message == nullptr); ++i) {
+		int from = (first + i) % _clusterSize;
+		if (from == _nodeIndex) {
+			continue;
+		}
+		
+		peer_t &peer = _peers[from];
+		if (peer._incomingLock.tryLock()) {
+			pollIncoming(peer, &message, completed);
+			peer._incomingLock.unlock();
+		}
+	}
+	
+	for (transfer_callback_t &callback : completed) {
+		callback();
+	}
+	
+	return message;
+}
@@ -0,0 +1,181 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __SHARED_MEMORY_MESSENGER_HPP__
+#define __SHARED_MEMORY_MESSENGER_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Messenger.hpp"
+#include "lowlevel/SpinLock.hpp"
+
+class Message;
+
+/** Messenger for the nodes that run as processes of the same host.
+ *
+ * The nodes communicate through a POSIX shared memory segment that
+ * contains a lock-free single-producer single-consumer ring for each
+ * ordered pair of nodes. The rings carry both the messages and the data
+ * transfers, which are copied through them in chunks, so no MPI is
+ * involved at all.
+ */
+class SharedMemoryMessenger : public Messenger {
+private:
+	//! A ring of the segment, followed by its buffer
+	struct ring_t {
+		//! Bytes consumed by the receiver
+		alignas(64) std::atomic<uint64_t> _head;
+		//! Bytes published by the sender
+		alignas(64) std::atomic<uint64_t> _tail;
+	};
+	
+	struct segment_header_t {
+		//! Set once the segment has been initialized
+		std::atomic<uint64_t> _magic;
+		uint64_t _clusterSize;
+		uint64_t _ringCapacity;
+		std::atomic<int> _attachedNodes;
+		
+		alignas(64) std::atomic<int> _barrierCount;
+		std::atomic<unsigned int> _barrierGeneration;
+	};
+	
+	enum record_kind_t {
+		message_record = 1,
+		data_record
+	};
+	
+	//! Header of each record of a ring. Records are padded to 8 bytes
+	struct record_header_t {
+		uint32_t _kind;
+		//! Message related to a data record
+		int32_t _messageId;
+		uint64_t _size;
+	};
+	
+	//! A message or a data transfer that has not fully entered its ring yet
+	struct outgoing_t {
+		Message *_message;
+		DataAccessRegion _region;
+		size_t _sent;
+		int _messageId;
+		transfer_callback_t _callback;
+	};
+	
+	//! A data transfer that has not been fully received yet
+	struct incoming_t {
+		DataAccessRegion _region;
+		size_t _received;
+		int _messageId;
+		transfer_callback_t _callback;
+	};
+	
+	struct peer_t {
+		ring_t *_sendRing;
+		ring_t *_receiveRing;
+		
+		SpinLock _outgoingLock;
+		std::deque<outgoing_t> _outgoing;
+		
+		//! Also serializes the consumption of the receive ring
+		SpinLock _incomingLock;
+		std::deque<incoming_t> _incoming;
+	};
+	
+	int _nodeIndex;
+	int _clusterSize;
+	
+	std::string _segmentName;
+	size_t _segmentSize;
+	segment_header_t *_segment;
+	size_t _ringCapacity;
+	
+	peer_t *_peers;
+	
+	//! Node whose ring is checked first for messages
+	std::atomic<unsigned int> _nextMailbox;
+	
+	ring_t *getRing(int from, int to) const;
+	
+	//! Copy to and from the circular buffer of a ring
+	void copyToRing(ring_t *ring, uint64_t position, void const *source, size_t size) const;
+	void copyFromRing(ring_t *ring, uint64_t position, void *destination, size_t size) const;
+	
+	//! Add an item to the queue of a node, and send whatever fits in its ring
+	void enqueue(int to, outgoing_t const &item);
+	
+	/** Move the queued items of a node to its ring while they fit
+	 *
+	 * \param completed gets the callbacks of the transfers that have
+	 * 	  fully entered the ring
+	 */
+	void pushOutgoing(peer_t &peer, std::vector<transfer_callback_t> &completed);
+	
+	/** Consume the records of the ring of a node
+	 *
+	 * Data records are copied to the transfer of the same message that
+	 * was posted first. The consumption stops at data records that do
+	 * not match any transfer yet.
+	 *
+	 * \param message gets the first message found, or stops at the
+	 * 	  messages if nullptr
+	 * \param completed gets the callbacks of the completed transfers
+	 */
+	void pollIncoming(peer_t &peer, Message **message, std::vector<transfer_callback_t> &completed);
+	
+	//! Polling service that progresses the transfers
+	static int progress(void *messenger);
+	
+	void progressTransfers();
+
+public:
+	SharedMemoryMessenger();
+	~SharedMemoryMessenger();
+	
+	void sendMessage(Message *msg, ClusterNode *toNode);
+	void sendMessage(Message *msg, std::vector<ClusterNode *> const &toNodes);
+	void synchronizeAll(void);
+	void sendData(const DataAccessRegion &region, const ClusterNode *toNode, int messageId,
+		transfer_callback_t callback = transfer_callback_t());
+	void fetchData(const DataAccessRegion &region, const ClusterNode *fromNode, int messageId,
+		transfer_callback_t callback = transfer_callback_t());
+	Message *checkMail();
+	
+	inline int getNodeIndex() const
+	{
+		return _nodeIndex;
+	}
+	
+	inline int getMasterIndex() const
+	{
+		return 0;
+	}
+	
+	inline int getClusterSize() const
+	{
+		return _clusterSize;
+	}
+	
+	inline bool isMasterNode() const
+	{
+		return _nodeIndex == 0;
+	}
+};
+
+//! Register SharedMemoryMessenger with the object factory
+namespace
+{
+	Messenger *createSharedMemoryMsn() { return new SharedMemoryMessenger; }
+	
+	const bool __attribute__((unused))_registered_shared_memory_msn =
+		REGISTER_MSN_CLASS("shm", createSharedMemoryMsn);
+}
+
+#endif /* __SHARED_MEMORY_MESSENGER_HPP__ */
@@ -0,0 +1,25 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __CLUSTER_DIRECTORY_HPP__
+#define __CLUSTER_DIRECTORY_HPP__
+
+class Task;
+
+//! Without cluster support there are no remote copies to track
+class ClusterDirectory {
+public:
+	static inline void localTaskHasRun(__attribute__((unused)) Task *task)
+	{
+	}
+	
+	static inline void invalidateAll()
+	{
+	}
+};
+
+
+#endif /* __CLUSTER_DIRECTORY_HPP__ */
@@ -25,6 +25,12 @@ public:
 	{
 	}
 	
+	static inline void setCompletionCallback(
+		__attribute__((unused)) void (*callback)(void *),
+		__attribute__((unused)) void *callbackArgs
+	) {
+	}
+	
 	static inline ClusterNode *getClusterNode(__attribute__((unused)) int nodeId = 0)
 	{
 		static ClusterNode ourDummyNode;
@@ -0,0 +1,49 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __CLUSTER_MEMORY_MANAGEMENT_HPP__
+#define __CLUSTER_MEMORY_MANAGEMENT_HPP__
+
+#include <cstdlib>
+
+#include <nanos6/cluster.h>
+
+class ClusterNode;
+
+//! Without cluster support all the memory belongs to the only node
+class ClusterMemoryManagement {
+public:
+	static inline void *dmalloc(
+		size_t size,
+		__attribute__((unused)) nanos6_data_distribution_t policy,
+		__attribute__((unused)) size_t blockSize
+	) {
+		return malloc(size);
+	}
+	
+	static inline void dfree(void *ptr, __attribute__((unused)) size_t size)
+	{
+		free(ptr);
+	}
+	
+	static inline void *lmalloc(size_t size)
+	{
+		return malloc(size);
+	}
+	
+	static inline void lfree(void *ptr, __attribute__((unused)) size_t size)
+	{
+		free(ptr);
+	}
+	
+	static inline ClusterNode *getHomeNode(__attribute__((unused)) void const *address)
+	{
+		return nullptr;
+	}
+};
+
+
+#endif /* __CLUSTER_MEMORY_MANAGEMENT_HPP__ */
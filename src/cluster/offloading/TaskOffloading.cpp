@@ -0,0 +1,422 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "TaskOffloading.hpp"
+
+#include <nanos6.h>
+#include <nanos6/library-mode.h>
+
+#include "cluster/ClusterDirectory.hpp"
+#include "cluster/ClusterManager.hpp"
+#include "cluster/messages/MessageDataFetch.hpp"
+#include "cluster/messages/MessageTaskFinished.hpp"
+#include "cluster/messages/MessageTaskNew.hpp"
+#include "cluster/messenger/Messenger.hpp"
+#include "executors/threads/TaskFinalization.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/SpinLock.hpp"
+#include "tasks/Task.hpp"
+#include "tasks/TaskImplementation.hpp"
+
+#include <ClusterNode.hpp>
+#include <DataAccessRegistration.hpp>
+#include <VirtualMemoryManagement.hpp>
+
+#include <link.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TaskOffloading {
+	struct module_search_t {
+		//! The address to look for, or the location to resolve
+		void const *_address;
+		static_object_location_t _location;
+		
+		//! Index of the module that is being visited
+		int _currentModule;
+		bool _found;
+	};
+	
+	//! Input data that is being received, which later tasks may also need
+	struct incoming_input_t {
+		DataAccessRegion _region;
+		
+		//! Called once the data has arrived
+		std::vector<Messenger::transfer_callback_t> _waiters;
+	};
+	
+	//! Locations of the static objects that have already been sent
+	static std::map<void const *, static_object_location_t> _knownLocations;
+	static SpinLock _knownLocationsLock;
+	
+	//! The transfers of input data that are in progress on this node
+	static std::list<incoming_input_t> _incomingInputs;
+	static SpinLock _incomingInputsLock;
+	
+	static int findModuleOfAddress(struct dl_phdr_info *info, __attribute__((unused)) size_t size, void *data)
+	{
+		module_search_t *search = (module_search_t *)data;
+		char const *address = (char const *)search->_address;
+		
+		for (int i = 0; i < info->dlpi_phnum; ++i) {
+			ElfW(Phdr) const &segment = info->dlpi_phdr[i];
+			if (segment.p_type != PT_LOAD) {
+				continue;
+			}
+			
+			char const *start = (char const *)(info->dlpi_addr + segment.p_vaddr);
+			if ((address >= start) && (address < start + segment.p_memsz)) {
+				search->_location._module = search->_currentModule;
+				search->_location._offset = address - (char const *)info->dlpi_addr;
+				search->_found = true;
+				return 1;
+			}
+		}
+		
+		search->_currentModule++;
+		return 0;
+	}
+	
+	static int findAddressOfLocation(struct dl_phdr_info *info, __attribute__((unused)) size_t size, void *data)
+	{
+		module_search_t *search = (module_search_t *)data;
+		
+		if (search->_currentModule == search->_location._module) {
+			search->_address = (char const *)info->dlpi_addr + search->_location._offset;
+			search->_found = true;
+			return 1;
+		}
+		
+		search->_currentModule++;
+		return 0;
+	}
+	
+	//! Find where a static object is, or return false if it is not static
+	static bool locateStaticObject(void const *object, static_object_location_t &location)
+	{
+		{
+			std::lock_guard<SpinLock> guard(_knownLocationsLock);
+			auto it = _knownLocations.find(object);
+			if (it != _knownLocations.end()) {
+				location = it->second;
+				return true;
+			}
+		}
+		
+		module_search_t search;
+		search._address = object;
+		search._currentModule = 0;
+		search._found = false;
+		dl_iterate_phdr(findModuleOfAddress, &search);
+		
+		if (!search._found) {
+			return false;
+		}
+		
+		location = search._location;
+		
+		std::lock_guard<SpinLock> guard(_knownLocationsLock);
+		_knownLocations[object] = location;
+		
+		return true;
+	}
+	
+	static void *findStaticObject(static_object_location_t const &location)
+	{
+		module_search_t search;
+		search._address = nullptr;
+		search._location = location;
+		search._currentModule = 0;
+		search._found = false;
+		dl_iterate_phdr(findAddressOfLocation, &search);
+		
+		FatalErrorHandler::failIf(
+			!search._found,
+			"Could not find the module of an offloaded task. All the cluster nodes must run the same program"
+		);
+		
+		return (void *)search._address;
+	}
+	
+	bool canBeOffloaded(Task *task)
+	{
+		assert(task != nullptr);
+		
+		if ((task->getParent() == nullptr) || task->isTaskloop() || task->isIf0() || task->mustDelayRelease()) {
+			return false;
+		}
+		
+		if (task->getDeviceType() != nanos6_device_t::nanos6_host_device) {
+			return false;
+		}
+		
+		//! The args block is sent as is, so it cannot contain objects
+		nanos6_task_info_t *taskInfo = task->getTaskInfo();
+		if (taskInfo->destroy_args_block != nullptr) {
+			return false;
+		}
+		
+		static_object_location_t location;
+		if (!locateStaticObject(taskInfo, location) || !locateStaticObject(task->getTaskInvokationInfo(), location)) {
+			return false;
+		}
+		
+		return DataAccessRegistration::processAllDataAccesses(
+			task,
+			[&](DataAccessRegion const &region, DataAccessType type, __attribute__((unused)) bool weak) -> bool {
+				if ((type != READ_ACCESS_TYPE) && (type != WRITE_ACCESS_TYPE) && (type != READWRITE_ACCESS_TYPE)) {
+					return false;
+				}
+				
+				return VirtualMemoryManagement::isClusterMemory(region.getStartAddress(), region.getSize());
+			}
+		);
+	}
+	
+	void offloadTask(Task *task, ClusterNode *remoteNode)
+	{
+		assert(task != nullptr);
+		assert(remoteNode != nullptr);
+		assert(remoteNode != ClusterManager::getClusterNode());
+		
+		/*! Only the parts of the input data that the remote node
+		 * does not hold yet are transferred */
+		std::vector<MessageTaskNew::AccessInfo> accesses;
+		std::vector<DataAccessRegion> transfers;
+		DataAccessRegistration::processAllDataAccesses(
+			task,
+			[&](DataAccessRegion const &region, DataAccessType type, bool weak) -> bool {
+				accesses.push_back({region, type, weak});
+				if (type != WRITE_ACCESS_TYPE) {
+					ClusterDirectory::requestCopy(region, remoteNode, transfers);
+				}
+				return true;
+			}
+		);
+		
+		static_object_location_t taskInfo, taskInvocationInfo;
+		__attribute__((unused)) bool located = locateStaticObject(task->getTaskInfo(), taskInfo);
+		assert(located);
+		located = locateStaticObject(task->getTaskInvokationInfo(), taskInvocationInfo);
+		assert(located);
+		
+		/*! The args block is allocated right before the task, with
+		 * its size rounded up to the alignment of the task */
+		size_t argsBlockSize = (char *)task - (char *)task->getArgsBlock();
+		
+		size_t flags = (task->isFinal() ? nanos6_final_task : 0);
+		
+		//! The task runs remotely until the TASK_FINISHED message arrives
+		task->setOffloaded(remoteNode);
+		task->setComputePlace(remoteNode);
+		
+		MessageTaskNew *msg = new MessageTaskNew(
+			ClusterManager::getClusterNode(), task,
+			taskInfo, taskInvocationInfo, flags,
+			task->getArgsBlock(), argsBlockSize, accesses, transfers
+		);
+		ClusterManager::getMessenger()->sendMessage(msg, remoteNode);
+	}
+	
+	//! Get the data that an offloaded task needs to receive and the data it produces
+	static void getTransfers(MessageTaskNew *msg, std::vector<DataAccessRegion> &inputs, std::vector<DataAccessRegion> &outputs)
+	{
+		DataAccessRegion const *transfers = msg->getTransfers();
+		inputs.assign(transfers, transfers + msg->getNumTransfers());
+		
+		MessageTaskNew::AccessInfo const *accesses = msg->getAccesses();
+		for (size_t i = 0; i < msg->getNumAccesses(); ++i) {
+			if (accesses[i]._type != READ_ACCESS_TYPE) {
+				outputs.push_back(accesses[i]._region);
+			}
+		}
+	}
+	
+	//! Body of the function that runs a task offloaded to this node
+	static void remoteTaskWrapper(void *args)
+	{
+		MessageTaskNew *msg = (MessageTaskNew *)args;
+		assert(msg != nullptr);
+		
+		Messenger *msn = ClusterManager::getMessenger();
+		ClusterNode *thisNode = ClusterManager::getClusterNode();
+		ClusterNode *offloader = ClusterManager::getClusterNode(msg->getSenderId());
+		
+		std::vector<DataAccessRegion> inputs, outputs;
+		getTransfers(msg, inputs, outputs);
+		
+		nanos6_task_info_t *taskInfo = (nanos6_task_info_t *)findStaticObject(msg->getTaskInfo());
+		nanos6_task_invocation_info_t *taskInvocationInfo =
+			(nanos6_task_invocation_info_t *)findStaticObject(msg->getTaskInvocationInfo());
+		
+		void *argsBlock = nullptr;
+		void *task = nullptr;
+		nanos6_create_task(taskInfo, taskInvocationInfo, msg->getArgsBlockSize(), &argsBlock, &task, msg->getFlags());
+		assert(argsBlock != nullptr);
+		assert(task != nullptr);
+		
+		memcpy(argsBlock, msg->getArgsBlock(), msg->getArgsBlockSize());
+		
+		/*! The task registers its accesses on this node, so it can
+		 * have its own subtasks. Wait for them too */
+		nanos6_submit_task(task);
+		nanos6_taskwait("remote task");
+		
+		//! The output data is sent right after the notification
+		MessageTaskFinished *finished = new MessageTaskFinished(thisNode, msg->getOffloadedTask(), outputs);
+		int finishedId = finished->getId();
+		msn->sendMessage(finished, offloader);
+		
+		if (outputs.empty()) {
+			return;
+		}
+		
+		/*! The data must not change until it has been sent, so this
+		 * function completes, and the message is deleted, after that */
+		void *eventCounter = nanos6_get_current_event_counter();
+		nanos6_increase_current_task_event_counter(eventCounter, outputs.size());
+		
+		for (DataAccessRegion const &region : outputs) {
+			msn->sendData(region, offloader, finishedId,
+				[eventCounter]() { nanos6_decrease_task_event_counter(eventCounter, 1); }
+			);
+		}
+	}
+		
+	//! Called once the function that runs an offloaded task has completed
+	static void remoteTaskCompleted(void *args)
+	{
+		delete (MessageTaskNew *)args;
+	}
+	
+	void remoteTaskCreated(MessageTaskNew *msg)
+	{
+		assert(msg != nullptr);
+		
+		Messenger *msn = ClusterManager::getMessenger();
+		ClusterNode *thisNode = ClusterManager::getClusterNode();
+		ClusterNode *offloader = ClusterManager::getClusterNode(msg->getSenderId());
+		
+		std::vector<DataAccessRegion> inputs, outputs;
+		getTransfers(msg, inputs, outputs);
+		
+		/*! The task is spawned once all of its input data has arrived,
+		 * so that no worker blocks on the transfers. The initial count
+		 * keeps it from starting while they are being posted */
+		std::shared_ptr<std::atomic<size_t>> pendingInputs =
+			std::make_shared<std::atomic<size_t>>(1);
+		Messenger::transfer_callback_t inputArrived = [msg, pendingInputs]() {
+			if (--(*pendingInputs) == 0) {
+				nanos6_spawn_function(remoteTaskWrapper, msg, remoteTaskCompleted, msg, "remote task");
+			}
+		};
+		
+		std::vector<std::list<incoming_input_t>::iterator> ownInputs;
+		{
+			std::lock_guard<SpinLock> guard(_incomingInputsLock);
+			
+			/*! The offloader does not send the data that this node
+			 * already holds, but it may still be arriving for a previous
+			 * task. The messages are handled in order, so its transfer
+			 * is already here */
+			MessageTaskNew::AccessInfo const *accesses = msg->getAccesses();
+			for (size_t i = 0; i < msg->getNumAccesses(); ++i) {
+				if (accesses[i]._type == WRITE_ACCESS_TYPE) {
+					continue;
+				}
+				
+				for (incoming_input_t &incoming : _incomingInputs) {
+					if (!incoming._region.intersect(accesses[i]._region).empty()) {
+						(*pendingInputs)++;
+						incoming._waiters.push_back(inputArrived);
+					}
+				}
+			}
+			
+			for (DataAccessRegion const &region : inputs) {
+				(*pendingInputs)++;
+				ownInputs.push_back(_incomingInputs.insert(_incomingInputs.end(), {region, {}}));
+			}
+		}
+		
+		if (!inputs.empty()) {
+			//! The offloader holds the last version of the data
+			MessageDataFetch *fetch = new MessageDataFetch(thisNode, inputs);
+			int fetchId = fetch->getId();
+		
+			for (size_t i = 0; i < inputs.size(); ++i) {
+				std::list<incoming_input_t>::iterator incoming = ownInputs[i];
+		
+				msn->fetchData(inputs[i], offloader, fetchId,
+					[incoming, inputArrived]() {
+						std::vector<Messenger::transfer_callback_t> waiters;
+						{
+							std::lock_guard<SpinLock> guard(_incomingInputsLock);
+							waiters.swap(incoming->_waiters);
+							_incomingInputs.erase(incoming);
+						}
+						
+						for (Messenger::transfer_callback_t const &waiter : waiters) {
+							waiter();
+						}
+						inputArrived();
+					}
+				);
+			}
+		
+			//! The receives are posted before the request, so the data never waits for them
+			msn->sendMessage(fetch, offloader);
+		}
+		
+		inputArrived();
+	}
+	
+	void remoteTaskFinished(MessageTaskFinished *msg)
+	{
+		assert(msg != nullptr);
+		
+		Task *task = (Task *)msg->getOffloadedTask();
+		assert(task != nullptr);
+		assert(task->isOffloaded());
+		
+		ClusterNode *remoteNode = ClusterManager::getClusterNode(msg->getSenderId());
+		assert(task->getClusterNode() == remoteNode);
+		
+		/*! The task releases its dependencies once all of its output
+		 * data has arrived, through its event counter, so that the
+		 * polling service never waits for the transfers */
+		size_t numRegions = msg->getNumRegions();
+		if (numRegions > 0) {
+			task->increaseReleaseCount(numRegions);
+		}
+		
+		Messenger *msn = ClusterManager::getMessenger();
+		DataAccessRegion const *regions = msg->getRegions();
+		for (size_t i = 0; i < numRegions; ++i) {
+			msn->fetchData(regions[i], remoteNode, msg->getId(),
+				[task]() { nanos6_decrease_task_event_counter(task, 1); }
+			);
+		}
+		
+		//! Before the successors of the task can be offloaded
+		ClusterDirectory::remoteTaskHasRun(task, remoteNode);
+		
+		if (task->markAsFinished(remoteNode)) {
+			DataAccessRegistration::unregisterTaskDataAccesses(task, nullptr);
+			
+			if (task->markAsReleased()) {
+				TaskFinalization::disposeOrUnblockTask(task, nullptr);
+			}
+		}
+	}
+}
@@ -0,0 +1,62 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __TASK_OFFLOADING_HPP__
+#define __TASK_OFFLOADING_HPP__
+
+#include <cstddef>
+
+class ClusterNode;
+class MessageTaskNew;
+class MessageTaskFinished;
+class Task;
+
+namespace TaskOffloading {
+	/** Location of a static object of the program.
+	 *
+	 * All the nodes run the same program, but the modules may be
+	 * loaded at different addresses. The objects are located by the
+	 * index of the module that contains them and their offset within it
+	 */
+	struct static_object_location_t {
+		int _module;
+		size_t _offset;
+	};
+	
+	/** Check whether a ready task can be executed by a remote node.
+	 *
+	 * Tasks that interact with their creator while they run, such as
+	 * if0 tasks or tasks with a wait clause, are always run locally.
+	 * The rest need their data to be in the memory that is common to
+	 * all the cluster nodes.
+	 */
+	bool canBeOffloaded(Task *task);
+	
+	/** Send a ready task to a remote node.
+	 *
+	 * The task keeps its accesses on this node until the remote node
+	 * notifies that it has finished.
+	 *
+	 * \param task is the task to offload, which must be offloadable
+	 * \param remoteNode is the node that will execute the task
+	 */
+	void offloadTask(Task *task, ClusterNode *remoteNode);
+	
+	/** Execute a task that another node has offloaded to this one.
+	 *
+	 * \param msg is the TASK_NEW message, which is deleted once the
+	 * 	  task has finished
+	 */
+	void remoteTaskCreated(MessageTaskNew *msg);
+	
+	/** Complete a task that this node has offloaded.
+	 *
+	 * \param msg is the TASK_FINISHED message
+	 */
+	void remoteTaskFinished(MessageTaskFinished *msg);
+}
+
+#endif /* __TASK_OFFLOADING_HPP__ */
@@ -2346,6 +2346,27 @@ namespace DataAccessRegistration {
 	}
 	
 	
+	bool processAllDataAccesses(Task *task, std::function<bool(DataAccessRegion const &, DataAccessType, bool)> processor)
+	{
+		assert(task != nullptr);
+		
+		TaskDataAccesses &accessStructures = task->getDataAccesses();
+		assert(!accessStructures.hasBeenDeleted());
+		TaskDataAccesses::accesses_t &accesses = accessStructures._accesses;
+		
+		std::lock_guard<TaskDataAccesses::spinlock_t> guard(accessStructures._lock);
+		
+		return accesses.processAll(
+			[&](TaskDataAccesses::accesses_t::iterator position) -> bool {
+				DataAccess *dataAccess = &(*position);
+				assert(dataAccess != nullptr);
+				
+				return processor(dataAccess->getAccessRegion(), dataAccess->getType(), dataAccess->isWeak());
+			}
+		);
+	}
+	
+	
 	void handleEnterBlocking(Task *task)
 	{
 		assert(task != nullptr);
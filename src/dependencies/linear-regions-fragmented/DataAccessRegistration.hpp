@@ -7,6 +7,8 @@
 #ifndef DATA_ACCESS_REGISTRATION_HPP
 #define DATA_ACCESS_REGISTRATION_HPP
 
+#include <functional>
+
 #include <DataAccessRegion.hpp>
 
 #include "../DataAccessType.hpp"
@@ -47,6 +49,14 @@ namespace DataAccessRegistration {
 	
 	void unregisterTaskDataAccesses(Task *task, ComputePlace *computePlace);
 	
+	//! \brief Call a function for each access of a task until it returns false
+	//! 
+	//! \param[in] task the task whose accesses are traversed
+	//! \param[in] processor a function that receives the region, the type and the weakness of each access
+	//! 
+	//! \returns false if the traversal was interrupted by the processor
+	bool processAllDataAccesses(Task *task, std::function<bool(DataAccessRegion const &, DataAccessType, bool)> processor);
+	
 	void handleEnterBlocking(Task *task);
 	void handleExitBlocking(Task *task);
 	void handleEnterTaskwait(Task *task, ComputePlace *computePlace);
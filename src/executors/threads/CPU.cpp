@@ -13,8 +13,8 @@
 #include <unistd.h>
 
 
-CPU::CPU(size_t systemCPUId, size_t virtualCPUId, size_t NUMANodeId)
-	: _activationStatus(uninitialized_status), _systemCPUId(systemCPUId), _virtualCPUId(virtualCPUId), _NUMANodeId(NUMANodeId)
+CPU::CPU(size_t systemCPUId, size_t virtualCPUId, size_t NUMANodeId, size_t L3CacheId)
+	: _activationStatus(uninitialized_status), _systemCPUId(systemCPUId), _virtualCPUId(virtualCPUId), _NUMANodeId(NUMANodeId), _L3CacheId(L3CacheId)
 {
 	CPU_ZERO_S(sizeof(cpu_set_t), &_cpuMask);
 	CPU_SET_S(systemCPUId, sizeof(cpu_set_t), &_cpuMask);
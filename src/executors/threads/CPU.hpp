@@ -56,6 +56,9 @@ struct CPU: public CPUPlace {
 	size_t _virtualCPUId;
 	size_t _NUMANodeId;
 	
+	//! \brief the L3 cache shared with other CPUs, or 0 if it is unknown
+	size_t _L3CacheId;
+	
 	//! \brief the CPU mask so that we can later on migrate threads to this CPU
 	cpu_set_t _cpuMask;
 	
@@ -65,7 +68,7 @@ struct CPU: public CPUPlace {
 	//! \brief Per-CPU data that is specific to the threading model
 	CPUThreadingModelData _threadingModelData;
 	
-	CPU(size_t systemCPUId, size_t virtualCPUId, size_t NUMANodeId);
+	CPU(size_t systemCPUId, size_t virtualCPUId, size_t NUMANodeId, size_t L3CacheId);
 	
 	// Not copyable
 	CPU(CPU const &) = delete;
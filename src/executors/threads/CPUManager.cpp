@@ -21,8 +21,7 @@
 std::vector<CPU *> CPUManager::_cpus;
 size_t CPUManager::_totalCPUs;
 std::atomic<bool> CPUManager::_finishedCPUInitialization;
-SpinLock CPUManager::_idleCPUsLock;
-boost::dynamic_bitset<> CPUManager::_idleCPUs;
+IdleCPUBitmap CPUManager::_idleCPUs;
 std::vector<boost::dynamic_bitset<>> CPUManager::_NUMANodeMask;
 std::vector<size_t> CPUManager::_systemToVirtualCPUId;
 
@@ -182,8 +181,8 @@ void CPUManager::preinitialize()
 	}
 	
 	// Set all CPUs as not idle
-	_idleCPUs.resize(_cpus.size());
-	_idleCPUs.reset();
+	std::vector<CPU *> usableCPUs(_cpus.begin(), _cpus.begin() + _totalCPUs);
+	_idleCPUs.initialize(usableCPUs, _NUMANodeMask.size());
 }
 
 
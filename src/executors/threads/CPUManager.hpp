@@ -18,6 +18,7 @@
 #include "lowlevel/FatalErrorHandler.hpp"
 
 #include "CPU.hpp"
+#include "IdleCPUBitmap.hpp"
 
 
 class CPUManager {
@@ -32,15 +33,13 @@ private:
 	static std::atomic<bool> _finishedCPUInitialization;
 	
 	//! \brief threads blocked due to idleness
-	static boost::dynamic_bitset<> _idleCPUs;
+	static IdleCPUBitmap _idleCPUs;
 
 	//! \brief NUMA node CPU mask
 	static std::vector<boost::dynamic_bitset<>> _NUMANodeMask;
 
 	//! \brief Map from system to virtual CPU id
 	static std::vector<size_t> _systemToVirtualCPUId;
-
-	static SpinLock _idleCPUsLock;
 	
 public:
 	static void preinitialize();
@@ -62,8 +61,8 @@ public:
 	//! \brief mark a CPU as idle
 	static inline void cpuBecomesIdle(CPU *cpu);
 
-	//! \brief get an idle CPU
-	static inline CPU *getIdleCPU();
+	//! \brief get an idle CPU, preferably one that shares the L3 cache or the NUMA node of a given hardware place
+	static inline CPU *getIdleCPU(ComputePlace *closeTo = nullptr);
 	
 	//! \brief get all idle CPUs
 	static inline void getIdleCPUs(std::vector<CPU *> &idleCPUs);
@@ -104,20 +103,16 @@ inline std::vector<CPU *> const &CPUManager::getCPUListReference()
 
 inline void CPUManager::cpuBecomesIdle(CPU *cpu)
 {
-	std::lock_guard<SpinLock> guard(_idleCPUsLock);
-	_idleCPUs[cpu->_virtualCPUId] = true;
+	_idleCPUs.setIdle(cpu);
 }
 
 
-inline CPU *CPUManager::getIdleCPU()
+inline CPU *CPUManager::getIdleCPU(ComputePlace *closeTo)
 {
-	std::lock_guard<SpinLock> guard(_idleCPUsLock);
-	boost::dynamic_bitset<>::size_type idleCPU = _idleCPUs.find_first();
-	if (idleCPU != boost::dynamic_bitset<>::npos) {
-		_idleCPUs[idleCPU] = false;
-		return _cpus[idleCPU];
+	if ((closeTo != nullptr) && (closeTo->getType() == nanos6_device_t::nanos6_host_device)) {
+		return _idleCPUs.claim((CPU *) closeTo);
 	} else {
-		return nullptr;
+		return _idleCPUs.claim(nullptr);
 	}
 }
 
@@ -125,26 +120,12 @@ inline void CPUManager::getIdleCPUs(std::vector<CPU *> &idleCPUs)
 {
 	assert(idleCPUs.empty());
 	
-	std::lock_guard<SpinLock> guard(_idleCPUsLock);
-	boost::dynamic_bitset<>::size_type idleCPU = _idleCPUs.find_first();
-	while (idleCPU != boost::dynamic_bitset<>::npos) {
-		_idleCPUs[idleCPU] = false;
-		idleCPUs.push_back(_cpus[idleCPU]);
-		idleCPU = _idleCPUs.find_next(idleCPU);
-	}
+	_idleCPUs.claimAll(idleCPUs);
 }
 
 inline CPU *CPUManager::getIdleNUMANodeCPU(size_t NUMANodeId)
 {
-	std::lock_guard<SpinLock> guard(_idleCPUsLock);
-	boost::dynamic_bitset<> tmpIdleCPUs = _idleCPUs & _NUMANodeMask[NUMANodeId];
-	boost::dynamic_bitset<>::size_type idleCPU = tmpIdleCPUs.find_first();
-	if (idleCPU != boost::dynamic_bitset<>::npos) {
-		_idleCPUs[idleCPU] = false;
-		return _cpus[idleCPU];
-	} else {
-		return nullptr;
-	}
+	return _idleCPUs.claimFromNUMANode(NUMANodeId);
 }
 
 
@@ -152,13 +133,7 @@ inline bool CPUManager::unidleCPU(CPU *cpu)
 {
 	assert(cpu != nullptr);
 	
-	std::lock_guard<SpinLock> guard(_idleCPUsLock);
-	if (_idleCPUs[cpu->_virtualCPUId]) {
-		_idleCPUs[cpu->_virtualCPUId] = false;
-		return true;
-	} else {
-		return false;
-	}
+	return _idleCPUs.clearIdle(cpu);
 }
 
 #endif // CPU_MANAGER_HPP
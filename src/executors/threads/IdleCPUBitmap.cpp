@@ -0,0 +1,77 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "IdleCPUBitmap.hpp"
+
+#include "lowlevel/FatalErrorHandler.hpp"
+
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <utility>
+
+
+IdleCPUBitmap::~IdleCPUBitmap()
+{
+	free(_words);
+	delete [] _summary;
+}
+
+
+void IdleCPUBitmap::initialize(std::vector<CPU *> const &cpus, size_t NUMANodeCount)
+{
+	assert(_words == nullptr);
+	
+	// Group the CPUs by NUMA node and L3 cache
+	std::map<std::pair<size_t, size_t>, std::vector<CPU *>> domainCPUs;
+	for (CPU *cpu : cpus) {
+		assert(cpu != nullptr);
+		domainCPUs[std::make_pair(cpu->_NUMANodeId, cpu->_L3CacheId)].push_back(cpu);
+	}
+	
+	_NUMANodeDomains.resize(NUMANodeCount);
+	_CPUToBit.resize(cpus.size());
+	_CPUToDomain.resize(cpus.size());
+	
+	// Each domain starts on its own cache line
+	size_t domainStart = 0;
+	for (auto const &domain : domainCPUs) {
+		std::vector<CPU *> const &members = domain.second;
+		size_t domainIndex = _domains.size();
+		size_t wordCount = (members.size() + bits_per_word - 1) / bits_per_word;
+		wordCount = (wordCount + words_per_cache_line - 1) / words_per_cache_line * words_per_cache_line;
+		
+		_domains.push_back({domain.first.first, domainStart, domainStart + wordCount});
+		assert(domain.first.first < NUMANodeCount);
+		_NUMANodeDomains[domain.first.first].push_back(domainIndex);
+		
+		_bitToCPU.resize((domainStart + wordCount) * bits_per_word, nullptr);
+		for (size_t i = 0; i < members.size(); i++) {
+			size_t position = domainStart * bits_per_word + i;
+			_bitToCPU[position] = members[i];
+			_CPUToBit[members[i]->_virtualCPUId] = position;
+			_CPUToDomain[members[i]->_virtualCPUId] = domainIndex;
+		}
+		
+		domainStart += wordCount;
+	}
+	
+	_wordCount = domainStart;
+	void *words = nullptr;
+	int rc = posix_memalign(&words, words_per_cache_line * sizeof(word_t), _wordCount * sizeof(word_t));
+	FatalErrorHandler::handle(rc, " when allocating the idle CPU bitmap");
+	
+	_words = (std::atomic<word_t> *) words;
+	for (size_t word = 0; word < _wordCount; word++) {
+		new (&_words[word]) std::atomic<word_t>(0);
+	}
+	
+	_summaryWordCount = (_domains.size() + bits_per_word - 1) / bits_per_word;
+	_summary = new std::atomic<word_t>[_summaryWordCount];
+	for (size_t word = 0; word < _summaryWordCount; word++) {
+		_summary[word] = 0;
+	}
+}
@@ -0,0 +1,222 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef IDLE_CPU_BITMAP_HPP
+#define IDLE_CPU_BITMAP_HPP
+
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CPU.hpp"
+
+
+//! \brief Lock-free set of the idle CPUs grouped by their topology
+//!
+//! The CPUs that share a NUMA node and an L3 cache form a domain, whose
+//! bits start on their own cache line. A summary word has a bit for each
+//! domain that may have idle CPUs. Claiming a CPU clears its bit with an
+//! atomic AND, so each idle CPU can only be claimed once.
+class IdleCPUBitmap {
+private:
+	typedef uint64_t word_t;
+	
+	enum bitmap_constants_t {
+		bits_per_word = 64,
+		words_per_cache_line = 64 / sizeof(word_t)
+	};
+	
+	struct Domain {
+		size_t _NUMANodeId;
+		size_t _firstWord;
+		size_t _endWord;
+	};
+	
+	std::vector<Domain> _domains;
+	std::vector<std::vector<size_t>> _NUMANodeDomains;
+	
+	//! \brief The bits of the idle CPUs
+	std::atomic<word_t> *_words;
+	size_t _wordCount;
+	
+	//! \brief The bits of the domains that may have idle CPUs
+	std::atomic<word_t> *_summary;
+	size_t _summaryWordCount;
+	
+	//! \brief The CPU of each bit, or null for the padding
+	std::vector<CPU *> _bitToCPU;
+	
+	//! \brief The bit of each CPU indexed by its virtual identifier
+	std::vector<size_t> _CPUToBit;
+	std::vector<size_t> _CPUToDomain;
+	
+	static inline word_t wordBit(size_t position)
+	{
+		return ((word_t) 1) << (position % bits_per_word);
+	}
+	
+	inline bool domainMayHaveIdleCPUs(size_t domainIndex) const
+	{
+		return (_summary[domainIndex / bits_per_word].load() & wordBit(domainIndex));
+	}
+	
+	inline bool domainHasIdleCPUs(Domain const &domain) const
+	{
+		for (size_t word = domain._firstWord; word < domain._endWord; word++) {
+			if (_words[word].load() != 0) {
+				return true;
+			}
+		}
+		
+		return false;
+	}
+	
+	inline CPU *claimFromDomain(size_t domainIndex)
+	{
+		Domain const &domain = _domains[domainIndex];
+		
+		while (true) {
+			for (size_t word = domain._firstWord; word < domain._endWord; word++) {
+				word_t value = _words[word].load(std::memory_order_relaxed);
+				while (value != 0) {
+					size_t bit = __builtin_ctzll(value);
+					word_t mask = ((word_t) 1) << bit;
+					
+					// Other threads may be claiming other CPUs of the same word
+					value = _words[word].fetch_and(~mask);
+					if (value & mask) {
+						return _bitToCPU[word * bits_per_word + bit];
+					}
+				}
+			}
+			
+			// Clear the summary before checking again, so that a CPU that becomes idle meanwhile is not missed
+			_summary[domainIndex / bits_per_word].fetch_and(~wordBit(domainIndex));
+			if (!domainHasIdleCPUs(domain)) {
+				return nullptr;
+			}
+			_summary[domainIndex / bits_per_word].fetch_or(wordBit(domainIndex));
+		}
+	}
+	
+	inline CPU *claimFromAnyDomain()
+	{
+		for (size_t summaryWord = 0; summaryWord < _summaryWordCount; summaryWord++) {
+			word_t value = _summary[summaryWord].load();
+			while (value != 0) {
+				size_t domainIndex = summaryWord * bits_per_word + __builtin_ctzll(value);
+				value &= value - 1;
+				
+				CPU *cpu = claimFromDomain(domainIndex);
+				if (cpu != nullptr) {
+					return cpu;
+				}
+			}
+		}
+		
+		return nullptr;
+	}
+
+public:
+	IdleCPUBitmap()
+		: _words(nullptr), _wordCount(0), _summary(nullptr), _summaryWordCount(0)
+	{
+	}
+	
+	IdleCPUBitmap(IdleCPUBitmap const &) = delete;
+	IdleCPUBitmap &operator=(IdleCPUBitmap const &) = delete;
+	
+	~IdleCPUBitmap();
+	
+	//! \brief Lay out the bitmap with all the CPUs marked as not idle
+	//!
+	//! \param[in] cpus the usable CPUs indexed by their virtual identifier
+	//! \param[in] NUMANodeCount the number of NUMA nodes
+	void initialize(std::vector<CPU *> const &cpus, size_t NUMANodeCount);
+	
+	inline void setIdle(CPU *cpu)
+	{
+		assert(cpu != nullptr);
+		size_t position = _CPUToBit[cpu->_virtualCPUId];
+		size_t domainIndex = _CPUToDomain[cpu->_virtualCPUId];
+		
+		_words[position / bits_per_word].fetch_or(wordBit(position));
+		
+		// Most of the time the domain already has other idle CPUs
+		if (!domainMayHaveIdleCPUs(domainIndex)) {
+			_summary[domainIndex / bits_per_word].fetch_or(wordBit(domainIndex));
+		}
+	}
+	
+	//! \brief Mark a CPU as not idle
+	//!
+	//! \returns true if it was idle
+	inline bool clearIdle(CPU *cpu)
+	{
+		assert(cpu != nullptr);
+		size_t position = _CPUToBit[cpu->_virtualCPUId];
+		
+		return (_words[position / bits_per_word].fetch_and(~wordBit(position)) & wordBit(position));
+	}
+	
+	//! \brief Claim an idle CPU, preferring the ones that share the L3 cache and then the NUMA node of another CPU
+	//!
+	//! \param[in] closeTo the CPU to be close to, or null
+	inline CPU *claim(CPU *closeTo)
+	{
+		if (closeTo != nullptr) {
+			size_t domainIndex = _CPUToDomain[closeTo->_virtualCPUId];
+			if (domainMayHaveIdleCPUs(domainIndex)) {
+				CPU *cpu = claimFromDomain(domainIndex);
+				if (cpu != nullptr) {
+					return cpu;
+				}
+			}
+			
+			CPU *cpu = claimFromNUMANode(_domains[domainIndex]._NUMANodeId);
+			if (cpu != nullptr) {
+				return cpu;
+			}
+		}
+		
+		return claimFromAnyDomain();
+	}
+	
+	inline CPU *claimFromNUMANode(size_t NUMANodeId)
+	{
+		assert(NUMANodeId < _NUMANodeDomains.size());
+		
+		for (size_t domainIndex : _NUMANodeDomains[NUMANodeId]) {
+			if (domainMayHaveIdleCPUs(domainIndex)) {
+				CPU *cpu = claimFromDomain(domainIndex);
+				if (cpu != nullptr) {
+					return cpu;
+				}
+			}
+		}
+		
+		return nullptr;
+	}
+	
+	inline void claimAll(std::vector<CPU *> &cpus)
+	{
+		for (size_t word = 0; word < _wordCount; word++) {
+			word_t value = _words[word].exchange(0);
+			while (value != 0) {
+				cpus.push_back(_bitToCPU[word * bits_per_word + __builtin_ctzll(value)]);
+				value &= value - 1;
+			}
+		}
+		
+		// The summary bits are cleared lazily by the next searches
+	}
+};
+
+
+#endif // IDLE_CPU_BITMAP_HPP
@@ -9,12 +9,14 @@
 #include "TaskFinalizationImplementation.hpp"
 #include "ThreadManager.hpp"
 #include "WorkerThread.hpp"
+#include "scheduling/GranularityCutoff.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/If0Task.hpp"
 #include "system/PollingAPI.hpp"
 #include "tasks/Task.hpp"
 #include "tasks/TaskImplementation.hpp"
 
+#include <ClusterDirectory.hpp>
 #include <DataAccessRegistration.hpp>
 
 #include <InstrumentComputePlaceManagement.hpp>
@@ -32,6 +34,7 @@
 #include <alloca.h>
 #include <pthread.h>
 #include <cstring>
+#include <time.h>
 
 void WorkerThread::initialize()
 {
@@ -139,16 +142,38 @@ void WorkerThread::handleTask(CPU *cpu)
 			}
 		}
 		
+		// Top level tasks may have written the data of the cluster outside of any task
+		if (_task->getParent() == nullptr) {
+			ClusterDirectory::invalidateAll();
+		}
+		
 		Instrument::startTask(taskId);
 		Instrument::taskIsExecuting(taskId);
 		
+		// Measure the task types for the granularity cutoff
+		bool measure = GranularityCutoff::isEnabled();
+		struct timespec startTime;
+		if (measure) {
+			clock_gettime(CLOCK_MONOTONIC, &startTime);
+		}
+		
 		// Run the task
 		std::atomic_thread_fence(std::memory_order_acquire);
 		_task->body(nullptr, translationTable);
 		std::atomic_thread_fence(std::memory_order_release);
 		
+		if (measure) {
+			struct timespec endTime;
+			clock_gettime(CLOCK_MONOTONIC, &endTime);
+			
+			uint64_t duration = (endTime.tv_sec - startTime.tv_sec) * 1000000000UL + endTime.tv_nsec - startTime.tv_nsec;
+			GranularityCutoff::taskHasRun(_task, duration);
+		}
+		
 		Instrument::taskIsZombie(taskId);
 		Instrument::endTask(taskId);
+		
+		ClusterDirectory::localTaskHasRun(_task);
 	}
 	
 	// Update the CPU since the thread may have migrated
@@ -105,7 +105,19 @@ void HostInfo::initialize()
 		hwloc_obj_t nodeNUMA = hwloc_get_ancestor_obj_by_type(topology, HWLOC_NUMA_ALIAS, obj);
 #endif
 		size_t NUMANodeId = nodeNUMA == NULL ? 0 : nodeNUMA->logical_index;
-		CPU * cpu = new CPU( /*systemCPUID*/ obj->os_index, /*virtualCPUID*/ obj->logical_index, NUMANodeId);
+		
+		//! The CPUs that share a last level cache are the closest ones when looking for an idle CPU
+#if HWLOC_API_VERSION >= 0x00020000
+		hwloc_obj_t L3Cache = hwloc_get_ancestor_obj_by_type(topology, HWLOC_OBJ_L3CACHE, obj);
+#else
+		hwloc_obj_t L3Cache = obj->parent;
+		while (L3Cache != nullptr && (L3Cache->type != HWLOC_OBJ_CACHE || L3Cache->attr->cache.depth != 3)) {
+			L3Cache = L3Cache->parent;
+		}
+#endif
+		size_t L3CacheId = L3Cache == nullptr ? 0 : L3Cache->logical_index;
+		
+		CPU * cpu = new CPU( /*systemCPUID*/ obj->os_index, /*virtualCPUID*/ obj->logical_index, NUMANodeId, L3CacheId);
 		_computePlaces[obj->logical_index] = cpu;
 	}
 	
@@ -18,6 +18,11 @@ class Task;
 
 
 namespace Instrument {
+	//! This function is called when the user code registers a type of task
+	//! before creating any instance of it.
+	//! \param[in] taskInfo the task type being registered
+	void registeredNewTaskType(nanos6_task_info_t *taskInfo);
+	
 	//! This function is called right after entering the runtime and must
 	//! return an instrumentation-specific task identifier.
 	//! The other 2 functions will also be called by the same thread sequentially.
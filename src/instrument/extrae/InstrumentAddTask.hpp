@@ -20,6 +20,10 @@ class Task;
 
 
 namespace Instrument {
+	inline void registeredNewTaskType(__attribute__((unused)) nanos6_task_info_t *taskInfo)
+	{
+	}
+	
 	inline task_id_t enterAddTask(
 		nanos6_task_info_t *taskInfo,
 		__attribute__((unused)) nanos6_task_invocation_info_t *taskInvokationInfo,
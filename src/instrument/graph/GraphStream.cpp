@@ -0,0 +1,201 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "GraphStream.hpp"
+
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/SpinLock.hpp"
+#include "system/RuntimeInfo.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+
+namespace Instrument {
+	namespace Graph {
+		namespace Stream {
+			EnvironmentVariable<bool> _enabled("NANOS6_GRAPH_STREAM", false);
+			
+			enum buffer_constants_t {
+				buffer_records = 64 * 1024
+			};
+			
+			static SpinLock _lock;
+			static int _fd = -1;
+			static std::string _filename;
+			
+			static record_t *_buffer = nullptr;
+			static size_t _bufferedRecords = 0;
+			
+			static struct timespec _startTime;
+			
+			//! \brief Identifiers of the task types that have already been written
+			static std::map<nanos6_task_info_t *, int> _taskTypes;
+			
+			
+			static void writeAll(void const *data, size_t size)
+			{
+				char const *position = (char const *) data;
+				
+				while (size > 0) {
+					ssize_t written = write(_fd, position, size);
+					if (written < 0) {
+						FatalErrorHandler::failIf(errno != EINTR, "Error writing the graph stream to '", _filename, "': ", strerror(errno));
+						continue;
+					}
+					
+					position += written;
+					size -= written;
+				}
+			}
+			
+			static void flush()
+			{
+				if (_bufferedRecords > 0) {
+					writeAll(_buffer, _bufferedRecords * sizeof(record_t));
+					_bufferedRecords = 0;
+				}
+			}
+			
+			static inline record_t &allocateRecord()
+			{
+				if (_bufferedRecords == buffer_records) {
+					flush();
+				}
+				
+				return _buffer[_bufferedRecords++];
+			}
+			
+			static inline uint64_t getTime()
+			{
+				struct timespec now;
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				
+				return (now.tv_sec - _startTime.tv_sec) * 1000000000UL + now.tv_nsec - _startTime.tv_nsec;
+			}
+			
+			static inline void fillRecord(
+				record_t &record,
+				record_type_t type, task_id_t taskId, compute_place_id_t computePlaceId,
+				task_id_t related, int value
+			) {
+				record._type = type;
+				record._cpu = (computePlaceId != compute_place_id_t() ? (uint16_t) computePlaceId : UINT16_MAX);
+				record._taskId = taskId;
+				record._related = related;
+				record._value = value;
+				record._time = getTime();
+			}
+			
+			
+			void initialize()
+			{
+				{
+					struct timeval tv;
+					gettimeofday(&tv, nullptr);
+					
+					std::ostringstream oss;
+					oss << "graph-"
+#if HAVE_GETHOSTID
+						<< gethostid() << "-"
+#endif
+						<< getpid() << "-" << tv.tv_sec << ".n6graph";
+					_filename = oss.str();
+				}
+				
+				_fd = open(_filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+				FatalErrorHandler::failIf(_fd == -1, "Cannot create the graph stream file '", _filename, "': ", strerror(errno));
+				
+				_buffer = new record_t[buffer_records];
+				clock_gettime(CLOCK_MONOTONIC, &_startTime);
+				
+				stream_header_t header;
+				header.initialize();
+				writeAll(&header, sizeof(header));
+				
+				RuntimeInfo::addEntry("graph_stream_file", "Graph Stream File", _filename);
+			}
+			
+			
+			void shutdown()
+			{
+				std::lock_guard<SpinLock> guard(_lock);
+				
+				flush();
+				close(_fd);
+				_fd = -1;
+				
+				delete [] _buffer;
+				_buffer = nullptr;
+			}
+			
+			
+			std::string const &getFilename()
+			{
+				return _filename;
+			}
+			
+			
+			void emit(
+				record_type_t type, task_id_t taskId, compute_place_id_t computePlaceId,
+				task_id_t related, int value
+			) {
+				std::lock_guard<SpinLock> guard(_lock);
+				
+				fillRecord(allocateRecord(), type, taskId, computePlaceId, related, value);
+			}
+			
+			
+			void emitCreatedTask(
+				task_id_t taskId, task_id_t parentId, compute_place_id_t computePlaceId,
+				nanos6_task_info_t *taskInfo, nanos6_task_invocation_info_t *taskInvocationInfo
+			) {
+				std::lock_guard<SpinLock> guard(_lock);
+				
+				int taskType;
+				auto it = _taskTypes.find(taskInfo);
+				if (it != _taskTypes.end()) {
+					taskType = it->second;
+				} else {
+					taskType = _taskTypes.size();
+					_taskTypes[taskInfo] = taskType;
+					
+					// The same criteria as the in-memory graph
+					std::string label;
+					if (taskInfo->implementations[0].task_label != nullptr) {
+						label = taskInfo->implementations[0].task_label;
+					} else if ((taskInvocationInfo != nullptr) && (taskInvocationInfo->invocation_source != nullptr)) {
+						label = taskInvocationInfo->invocation_source;
+					} else if (taskInfo->implementations[0].declaration_source != nullptr) {
+						label = taskInfo->implementations[0].declaration_source;
+					}
+					if (label.size() > max_task_type_name_length) {
+						label.resize(max_task_type_name_length);
+					}
+					
+					fillRecord(allocateRecord(), task_type_record, taskType, computePlaceId, label.size(), 0);
+					for (size_t part = 0; part < getNameRecords(label.size()); part++) {
+						record_t &nameRecord = allocateRecord();
+						memset(&nameRecord, 0, sizeof(nameRecord));
+						label.copy((char *) &nameRecord, sizeof(nameRecord), part * sizeof(nameRecord));
+					}
+				}
+				
+				fillRecord(allocateRecord(), task_created_record, taskId, computePlaceId, parentId, taskType);
+			}
+		}
+	}
+}
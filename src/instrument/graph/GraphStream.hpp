@@ -0,0 +1,78 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_GRAPH_STREAM_HPP
+#define INSTRUMENT_GRAPH_STREAM_HPP
+
+
+#include <nanos6.h>
+
+#include <cstdint>
+#include <string>
+
+#include "GraphStreamRecords.hpp"
+#include "dependencies/DataAccessType.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+
+#include <InstrumentComputePlaceId.hpp>
+#include <InstrumentDataAccessId.hpp>
+#include <InstrumentTaskId.hpp>
+
+
+namespace Instrument {
+	namespace Graph {
+		//! \brief Writes the execution to a file as it happens instead of keeping it in memory
+		//!
+		//! In this mode only the tasks, their dependencies and their execution are recorded. The
+		//! graph and the critical path are obtained afterwards with the nanos6-graph tool.
+		namespace Stream {
+			extern EnvironmentVariable<bool> _enabled;
+			
+			void initialize();
+			void shutdown();
+			
+			std::string const &getFilename();
+			
+			void emit(
+				record_type_t type, task_id_t taskId, compute_place_id_t computePlaceId,
+				task_id_t related = task_id_t(), int value = 0
+			);
+			
+			void emitCreatedTask(
+				task_id_t taskId, task_id_t parentId, compute_place_id_t computePlaceId,
+				nanos6_task_info_t *taskInfo, nanos6_task_invocation_info_t *taskInvocationInfo
+			);
+			
+			inline int getAccessFlags(DataAccessType accessType, bool weak)
+			{
+				return ((accessType == READ_ACCESS_TYPE) ? read_only_access : 0) | (weak ? weak_access : 0);
+			}
+			
+			//! \brief Get an identifier for a data access that encodes its originator and its access flags
+			//!
+			//! In this mode the accesses are not tracked, so their identifiers do not need to be unique
+			inline data_access_id_t getDataAccessId(task_id_t originatorTaskId, int accessFlags)
+			{
+				uint64_t originator = (uint32_t) (task_id_t::inner_type_t) originatorTaskId;
+				
+				return data_access_id_t((data_access_id_t::inner_type_t) ((originator << 32) | (uint32_t) accessFlags));
+			}
+			
+			inline task_id_t getOriginator(data_access_id_t dataAccessId)
+			{
+				return task_id_t((int32_t) ((uint64_t) (data_access_id_t::inner_type_t) dataAccessId >> 32));
+			}
+			
+			inline int getAccessFlags(data_access_id_t dataAccessId)
+			{
+				return (int) (uint32_t) (data_access_id_t::inner_type_t) dataAccessId;
+			}
+		}
+	}
+}
+
+
+#endif // INSTRUMENT_GRAPH_STREAM_HPP
@@ -0,0 +1,96 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_GRAPH_STREAM_RECORDS_HPP
+#define INSTRUMENT_GRAPH_STREAM_RECORDS_HPP
+
+
+#include <cstdint>
+#include <cstring>
+
+
+// This file is shared with the offline graph tool, so it must not depend on the rest of the runtime
+
+
+namespace Instrument {
+	namespace Graph {
+		namespace Stream {
+			enum stream_constants_t {
+				stream_version = 1,
+				//! Task type names are stored in the records that follow their definition, padded to a whole record
+				max_task_type_name_length = 1024
+			};
+			
+			enum record_type_t {
+				//! _taskId is the type identifier and _related is the length of the name that follows
+				task_type_record = 1,
+				//! _related is the parent task and _value the type identifier
+				task_created_record,
+				task_started_record,
+				task_finished_record,
+				//! _taskId has an access with the access_flags_t in _value
+				access_record,
+				//! _taskId is linked to an access of _related with the access_flags_t in _value
+				dependency_record,
+				//! _taskId is the task that waits
+				taskwait_entered_record,
+				taskwait_exited_record
+			};
+			
+			enum access_flags_t {
+				read_only_access = 1,
+				weak_access = 2
+			};
+			
+			struct stream_header_t {
+				char _magic[8];
+				uint32_t _version;
+				uint32_t _recordSize;
+				
+				void initialize();
+				
+				bool isValid() const;
+			};
+			
+			//! \brief A fixed size event of the execution
+			struct record_t {
+				uint16_t _type;
+				uint16_t _cpu;
+				int32_t _taskId;
+				int32_t _related;
+				int32_t _value;
+				//! \brief Nanoseconds since the start of the execution
+				uint64_t _time;
+			};
+			
+			static char const stream_magic[8] = "N6GRAPH";
+			
+			
+			inline void stream_header_t::initialize()
+			{
+				memcpy(_magic, stream_magic, sizeof(_magic));
+				_version = stream_version;
+				_recordSize = sizeof(record_t);
+			}
+			
+			inline bool stream_header_t::isValid() const
+			{
+				return (memcmp(_magic, stream_magic, sizeof(_magic)) == 0)
+					&& (_version == stream_version)
+					&& (_recordSize == sizeof(record_t));
+			}
+			
+			//! \brief Number of records occupied by a task type name
+			static inline size_t getNameRecords(size_t length)
+			{
+				return (length + sizeof(record_t) - 1) / sizeof(record_t);
+			}
+		}
+	}
+}
+
+
+#endif // INSTRUMENT_GRAPH_STREAM_RECORDS_HPP
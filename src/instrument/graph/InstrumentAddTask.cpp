@@ -12,6 +12,7 @@
 #include <instrument/support/InstrumentThreadLocalDataSupportImplementation.hpp>
 
 #include "ExecutionSteps.hpp"
+#include "GraphStream.hpp"
 #include "InstrumentGraph.hpp"
 
 
@@ -32,6 +33,10 @@ namespace Instrument {
 		__attribute__((unused)) size_t flags,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return _nextTaskId++;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		// Get an ID for the task
@@ -71,13 +76,22 @@ namespace Instrument {
 		task_id_t taskId,
 		__attribute__((unused)) InstrumentationContext const &context
 	) {
+		Task *task = (Task *) taskObject;
+		
+		if (Stream::_enabled) {
+			Stream::emitCreatedTask(
+				taskId, context._taskId, context._computePlaceId,
+				task->getTaskInfo(), task->getTaskInvokationInfo()
+			);
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		// Create the task information
 		task_info_t &taskInfo = _taskToInfoMap[taskId];
 		assert(taskInfo._phaseList.empty());
 		
-		Task *task = (Task *) taskObject;
 		taskInfo._nanos6_task_info = task->getTaskInfo();
 		taskInfo._nanos6_task_invocation_info = task->getTaskInvokationInfo();
 		taskInfo._parent = context._taskId;
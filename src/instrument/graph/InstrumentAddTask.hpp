@@ -13,6 +13,10 @@
 
 
 namespace Instrument {
+	inline void registeredNewTaskType(__attribute__((unused)) nanos6_task_info_t *taskInfo)
+	{
+	}
+	
 	task_id_t enterAddTask(nanos6_task_info_t *taskInfo, nanos6_task_invocation_info_t *taskInvokationInfo, size_t flags, InstrumentationContext const &context);
 	void createdTask(void *task, task_id_t taskId, InstrumentationContext const &context);
 	void exitAddTask(task_id_t taskId, InstrumentationContext const &context);
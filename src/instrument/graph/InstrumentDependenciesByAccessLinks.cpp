@@ -14,6 +14,7 @@
 #include <instrument/support/InstrumentThreadLocalDataSupportImplementation.hpp>
 
 #include "ExecutionSteps.hpp"
+#include "GraphStream.hpp"
 #include "InstrumentDependenciesByAccessLinks.hpp"
 
 #include "InstrumentDataAccessId.hpp"
@@ -31,6 +32,15 @@ namespace Instrument {
 		access_object_type_t objectType,
 		task_id_t originatorTaskId, InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			int accessFlags = Stream::getAccessFlags(accessType, weak);
+			if (objectType == regular_access_type) {
+				Stream::emit(Stream::access_record, originatorTaskId, context._computePlaceId, task_id_t(), accessFlags);
+			}
+			
+			return Stream::getDataAccessId(originatorTaskId, accessFlags);
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		data_access_id_t dataAccessId = Graph::_nextDataAccessId++;
@@ -130,6 +140,15 @@ namespace Instrument {
 			return;
 		}
 		
+		if (Stream::_enabled) {
+			task_id_t originatorTaskId = Stream::getOriginator(dataAccessId);
+			int accessFlags = Stream::getAccessFlags(newAccessType, newWeakness);
+			
+			Stream::emit(Stream::access_record, originatorTaskId, context._computePlaceId, task_id_t(), accessFlags);
+			dataAccessId = Stream::getDataAccessId(originatorTaskId, accessFlags);
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		upgrade_data_access_step_t *step = new upgrade_data_access_step_t(
@@ -152,6 +171,10 @@ namespace Instrument {
 		bool globallySatisfied,
 		task_id_t targetTaskId, InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		data_access_becomes_satisfied_step_t *step = new data_access_becomes_satisfied_step_t(
@@ -169,6 +192,10 @@ namespace Instrument {
 		DataAccessRegion newRegion,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		modified_data_access_region_step_t *step = new modified_data_access_region_step_t(
@@ -190,6 +217,11 @@ namespace Instrument {
 		DataAccessRegion newRegion,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			// The fragments keep the originator and the access flags
+			return dataAccessId;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		access_t *originalAccess = _accessIdToAccessMap[dataAccessId];
@@ -267,6 +299,11 @@ namespace Instrument {
 		data_access_id_t &dataAccessId,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			// The fragments keep the originator and the access flags
+			return dataAccessId;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		access_t *originalAccess = _accessIdToAccessMap[dataAccessId];
@@ -314,6 +351,10 @@ namespace Instrument {
 		data_access_id_t &dataAccessId,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		completed_data_access_step_t *step = new completed_data_access_step_t(
@@ -328,6 +369,10 @@ namespace Instrument {
 		data_access_id_t &dataAccessId,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		data_access_becomes_removable_step_t *step = new data_access_becomes_removable_step_t(
@@ -342,6 +387,10 @@ namespace Instrument {
 		data_access_id_t &dataAccessId,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		removed_data_access_step_t *step = new removed_data_access_step_t(
@@ -358,6 +407,17 @@ namespace Instrument {
 		bool direct, bool bidirectional,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			// Only the dependencies between tasks are kept
+			if ((sinkObjectType == regular_access_type) || (sinkObjectType == entry_fragment_type)) {
+				Stream::emit(
+					Stream::dependency_record, sinkTaskId, context._computePlaceId,
+					Stream::getOriginator(sourceAccessId), Stream::getAccessFlags(sourceAccessId)
+				);
+			}
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		access_t *sourceAccess = _accessIdToAccessMap[sourceAccessId];
@@ -382,6 +442,10 @@ namespace Instrument {
 		bool direct,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		unlinked_data_accesses_step_t *step = new unlinked_data_accesses_step_t(
@@ -398,6 +462,10 @@ namespace Instrument {
 		data_access_id_t &dataAccessId,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		reparented_data_access_step_t *step = new reparented_data_access_step_t(
@@ -414,6 +482,10 @@ namespace Instrument {
 		char const *longPropertyName,
 		InstrumentationContext const &context
 	) {
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		new_data_access_property_step_t *step = new new_data_access_property_step_t(
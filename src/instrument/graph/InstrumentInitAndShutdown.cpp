@@ -10,6 +10,7 @@
 #include "Color.hpp"
 #include "ExecutionSteps.hpp"
 #include "GenerateEdges.hpp"
+#include "GraphStream.hpp"
 #include "PathLength.hpp"
 #include "SortAccessGroups.hpp"
 
@@ -38,6 +39,10 @@ namespace Instrument {
 	void initialize()
 	{
 		RuntimeInfo::addEntry("instrumentation", "Instrumentation", "graph");
+		
+		if (Stream::_enabled) {
+			Stream::initialize();
+		}
 	}
 	
 	
@@ -1365,6 +1370,12 @@ namespace Instrument {
 	
 	void shutdown()
 	{
+		if (Stream::_enabled) {
+			Stream::shutdown();
+			std::cerr << std::endl << "Generated graph stream '" << Stream::getFilename() << "'. Use nanos6-graph to process it" << std::endl;
+			return;
+		}
+		
 		std::string filenameBase;
 		std::string logName;
 		{
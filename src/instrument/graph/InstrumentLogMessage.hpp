@@ -15,6 +15,7 @@
 #include "../api/InstrumentLogMessage.hpp"
 #include "../support/InstrumentThreadLocalDataSupport.hpp"
 #include "../support/InstrumentThreadLocalDataSupportImplementation.hpp"
+#include "GraphStream.hpp"
 #include "InstrumentExternalThreadLocalData.hpp"
 #include "InstrumentGraph.hpp"
 #include "InstrumentTaskId.hpp"
@@ -45,6 +46,10 @@ namespace Instrument {
 	template<typename... TS>
 	inline void logMessage(InstrumentationContext const &context, TS... contents)
 	{
+		if (Graph::Stream::_enabled) {
+			return;
+		}
+		
 		std::ostringstream stream;
 		fillStream(stream, contents...);
 		
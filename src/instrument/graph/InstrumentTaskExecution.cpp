@@ -5,6 +5,7 @@
 */
 
 #include "ExecutionSteps.hpp"
+#include "GraphStream.hpp"
 #include "InstrumentTaskExecution.hpp"
 #include "InstrumentGraph.hpp"
 
@@ -21,15 +22,25 @@ namespace Instrument {
 	using namespace Graph;
 	
 	
-	void startTask(__attribute__((unused)) task_id_t taskId, InstrumentationContext const &context)
+	void startTask(task_id_t taskId, InstrumentationContext const &context)
 	{
+		if (Stream::_enabled) {
+			Stream::emit(Stream::task_started_record, taskId, context._computePlaceId);
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		enter_task_step_t *enterTaskStep = new enter_task_step_t(context);
 		_executionSequence.push_back(enterTaskStep);
 	}
 	
-	void endTask(__attribute__((unused)) task_id_t taskId, InstrumentationContext const &context)
+	void endTask(task_id_t taskId, InstrumentationContext const &context)
 	{
+		if (Stream::_enabled) {
+			Stream::emit(Stream::task_finished_record, taskId, context._computePlaceId);
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		exit_task_step_t *exitTaskStep = new exit_task_step_t(context);
 		_executionSequence.push_back(exitTaskStep);
@@ -5,6 +5,7 @@
 */
 
 #include "ExecutionSteps.hpp"
+#include "GraphStream.hpp"
 #include "InstrumentTaskWait.hpp"
 #include "InstrumentGraph.hpp"
 
@@ -25,6 +26,11 @@ namespace Instrument {
 	
 	void enterTaskWait(task_id_t taskId, char const *invocationSource, task_id_t if0TaskId, InstrumentationContext const &context)
 	{
+		if (Stream::_enabled) {
+			Stream::emit(Stream::taskwait_entered_record, taskId, context._computePlaceId);
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		task_info_t &taskInfo = _taskToInfoMap[taskId];
 		
@@ -48,6 +54,11 @@ namespace Instrument {
 	
 	void exitTaskWait(task_id_t taskId, InstrumentationContext const &context)
 	{
+		if (Stream::_enabled) {
+			Stream::emit(Stream::taskwait_exited_record, taskId, context._computePlaceId);
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		task_info_t &taskInfo = _taskToInfoMap[taskId];
 		
@@ -7,6 +7,7 @@
 #include "system/ompss/UserMutex.hpp"
 
 #include "ExecutionSteps.hpp"
+#include "GraphStream.hpp"
 #include "InstrumentTaskId.hpp"
 #include "InstrumentUserMutex.hpp"
 
@@ -42,6 +43,10 @@ namespace Instrument {
 	
 	void acquiredUserMutex(UserMutex *userMutex, InstrumentationContext const &context)
 	{
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		usermutex_id_t usermutexId = getUserMutexId(userMutex, guard);
@@ -52,6 +57,10 @@ namespace Instrument {
 	
 	void blockedOnUserMutex(UserMutex *userMutex, InstrumentationContext const &context)
 	{
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		usermutex_id_t usermutexId = getUserMutexId(userMutex, guard);
@@ -62,6 +71,10 @@ namespace Instrument {
 	
 	void releasedUserMutex(UserMutex *userMutex, InstrumentationContext const &context)
 	{
+		if (Stream::_enabled) {
+			return;
+		}
+		
 		std::lock_guard<SpinLock> guard(_graphLock);
 		
 		usermutex_id_t usermutexId = getUserMutexId(userMutex, guard);
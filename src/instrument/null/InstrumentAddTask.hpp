@@ -12,6 +12,10 @@
 
 
 namespace Instrument {
+	inline void registeredNewTaskType(__attribute__((unused)) nanos6_task_info_t *taskInfo)
+	{
+	}
+	
 	inline task_id_t enterAddTask(
 		__attribute__((unused)) nanos6_task_info_t *taskInfo,
 		__attribute__((unused)) nanos6_task_invocation_info_t *taskInvokationInfo,
@@ -1 +0,0 @@
-../null/InstrumentAddTask.hpp
\ No newline at end of file
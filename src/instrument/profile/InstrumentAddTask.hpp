@@ -0,0 +1,44 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_PROFILE_ADD_TASK_HPP
+#define INSTRUMENT_PROFILE_ADD_TASK_HPP
+
+
+#include "../api/InstrumentAddTask.hpp"
+
+
+namespace Instrument {
+	inline void registeredNewTaskType(__attribute__((unused)) nanos6_task_info_t *taskInfo)
+	{
+	}
+	
+	inline task_id_t enterAddTask(
+		nanos6_task_info_t *taskInfo,
+		__attribute__((unused)) nanos6_task_invocation_info_t *taskInvokationInfo,
+		__attribute__((unused)) size_t flags,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+		return task_id_t(taskInfo);
+	}
+	
+	inline void createdTask(
+		__attribute__((unused)) void *task,
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+	
+	inline void exitAddTask(
+		__attribute__((unused)) task_id_t taskId,
+		__attribute__((unused)) InstrumentationContext const &context
+	) {
+	}
+	
+}
+
+
+#endif // INSTRUMENT_PROFILE_ADD_TASK_HPP
@@ -27,13 +27,16 @@
 #include <instrument/support/sampling/SigProf.hpp>
 
 #include <atomic>
+#include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
+#include <thread>
 
 
 
@@ -48,66 +51,46 @@ void Instrument::Profile::signalHandler(Sampling::ThreadLocalData &samplingThrea
 {
 	ThreadLocalData &threadLocal = (ThreadLocalData &) samplingThreadLocal;
 	
-	long depth = _singleton._profilingBacktraceDepth;
-	long bufferSize = _singleton._profilingBufferSize;
-	
-	// Pre-allocate the next buffer as soon as possible
-	if (!threadLocal._inMemoryAllocation && (threadLocal._nextBuffer == nullptr)) {
-		threadLocal.allocateNextBuffer(bufferSize);
-		
-		_singleton._bufferListSpinLock.lock();
-		_singleton._bufferList.push_back(threadLocal._nextBuffer);
-		_singleton._bufferListSpinLock.unlock();
-	}
-	
-	// Replace the current buffer if necessary
-	if (threadLocal._nextBufferPosition + depth > (bufferSize + 2)) {
-		threadLocal._currentBuffer = threadLocal._nextBuffer;
-		threadLocal._nextBuffer = nullptr;
-		threadLocal._nextBufferPosition = 0;
-	}
-	
-	// Either out of memory too many consecutive samples within a memory allocation
-	if (threadLocal._currentBuffer == nullptr) {
+	SampleTable *sampleTable = threadLocal._sampleTable;
+	if (sampleTable == nullptr) {
 		return;
 	}
 	
+	address_t *frames = sampleTable->getPendingFrames();
+	size_t frameCount = 0;
+	
 	BacktraceWalker::walk(
-		depth,
+		_singleton._profilingBacktraceDepth,
 		/* Skip */ 3,
 		[&](void *address, __attribute__((unused)) int currentFrame) {
-			threadLocal._currentBuffer[threadLocal._nextBufferPosition] = address;
-			threadLocal._nextBufferPosition++;
+			frames[frameCount] = address;
+			frameCount++;
 		}
 	);
 	
-	// End of backtrace mark
-	threadLocal._currentBuffer[threadLocal._nextBufferPosition] = 0;
-	threadLocal._nextBufferPosition++;
+	if (frameCount == 0) {
+		return;
+	}
 	
-	// We keep always an end mark in the buffer and add it to the list of buffers.
-	// This way we do not need to perform any kind of cleanup for the threads
-	threadLocal._currentBuffer[threadLocal._nextBufferPosition] = 0; // The end mark
+	nanos6_task_info_t const *taskInfo = threadLocal.getCurrentTaskType();
+	if (threadLocal._busyWaitDepth > 0) {
+		sampleTable->record(SampleTable::idle_sample, nullptr, frameCount);
+	} else if (taskInfo != nullptr) {
+		sampleTable->record(SampleTable::task_sample, taskInfo, frameCount);
+	} else {
+		sampleTable->record(SampleTable::runtime_sample, nullptr, frameCount);
+	}
 }
 
 
 void Instrument::Profile::doCreatedThread()
 {
 	ThreadLocalData &threadLocal = getThreadLocalData();
-	threadLocal.init(_profilingBufferSize);
-	threadLocal.allocateNextBuffer(_profilingBufferSize);
+	threadLocal.init(_profilingTableSize, _profilingBacktraceDepth);
 	
-	threadLocal._nextBufferPosition = 0;
-	
-	// We keep always an end mark in the buffer and add it to the list of buffers.
-	// This way we do not need to perform any kind of cleanup for the threads
-	
-	threadLocal._currentBuffer[threadLocal._nextBufferPosition] = 0; // End of backtrace
-	threadLocal._currentBuffer[threadLocal._nextBufferPosition+1] = 0; // End of buffer
-	
-	_bufferListSpinLock.lock();
-	_bufferList.push_back(threadLocal._currentBuffer);
-	_bufferListSpinLock.unlock();
+	_sampleTableListSpinLock.lock();
+	_sampleTableList.push_back(threadLocal._sampleTable);
+	_sampleTableListSpinLock.unlock();
 	
 	Sampling::SigProf::setUpThread(threadLocal);
 	
@@ -116,14 +99,64 @@ void Instrument::Profile::doCreatedThread()
 	Sampling::SigProf::forceHandler();
 	
 	// Remove the sample
-	threadLocal._nextBufferPosition = 0;
-	threadLocal._currentBuffer[0] = 0; // End of backtrace
-	threadLocal._currentBuffer[1] = 0; // End of buffer
+	threadLocal._sampleTable->clear();
 	
 	Sampling::SigProf::enableThread(threadLocal);
 }
 
 
+std::string Instrument::Profile::getTagName(TaggedBacktrace const &taggedBacktrace)
+{
+	if (taggedBacktrace._kind == SampleTable::idle_sample) {
+		return "idle";
+	} else if (taggedBacktrace._kind == SampleTable::runtime_sample) {
+		return "runtime";
+	}
+	
+	nanos6_task_info_t const *taskInfo = taggedBacktrace._taskInfo;
+	assert(taskInfo != nullptr);
+	
+	if (taskInfo->implementations[0].task_label != nullptr) {
+		return taskInfo->implementations[0].task_label;
+	} else if (taskInfo->implementations[0].declaration_source != nullptr) {
+		return taskInfo->implementations[0].declaration_source;
+	} else {
+		return "task";
+	}
+}
+
+
+void Instrument::Profile::resolveAddresses(std::set<std::pair<address_t, bool>> const &addresses)
+{
+	std::vector<std::pair<address_t, bool>> pending(addresses.begin(), addresses.end());
+	std::atomic<size_t> nextAddress(0);
+	
+	auto resolver = [&]() {
+		size_t index = nextAddress++;
+		while (index < pending.size()) {
+			CodeAddressInfo::resolveAddress(pending[index].first, pending[index].second);
+			index = nextAddress++;
+		}
+	};
+	
+	// The resolution of each address may involve reading the debugging information or running addr2line
+	size_t threadCount = std::thread::hardware_concurrency();
+	if (threadCount > pending.size()) {
+		threadCount = pending.size();
+	}
+	
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; i++) {
+		threads.emplace_back(resolver);
+	}
+	resolver();
+	
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+}
+
+
 void Instrument::Profile::doShutdown()
 {
 	// After this, on the next profiling signal, the corresponding timer gets disarmed
@@ -138,94 +171,124 @@ void Instrument::Profile::doShutdown()
 	CodeAddressInfo::init();
 	
 	
-	// Build frequency tables and resolve address information
+	// Merge the samples of all the threads
+	std::map<TaggedBacktrace, freq_t> taggedBacktrace2Frequency;
+	size_t droppedSamples = 0;
+	
+	_sampleTableListSpinLock.lock();
+	for (SampleTable *sampleTable : _sampleTableList) {
+		for (size_t index = 0; index < sampleTable->getCapacity(); index++) {
+			SampleTable::Sample const &sample = sampleTable->getSample(index);
+			if (sample._count == 0) {
+				continue;
+			}
+			
+			TaggedBacktrace taggedBacktrace(sample._kind, sample._taskInfo, sampleTable->getFrames(index), sample._frameCount);
+			taggedBacktrace2Frequency[taggedBacktrace] += sample._count;
+		}
+		
+		droppedSamples += sampleTable->getDroppedSamples();
+		delete sampleTable;
+	}
+	_sampleTableList.clear();
+	_sampleTableListSpinLock.unlock();
+	
+	FatalErrorHandler::warnIf(droppedSamples > 0,
+		droppedSamples, " profiling samples were dropped because the sample tables were full. Try increasing NANOS6_PROFILE_TABLE_SIZE");
+	
+	
+	// Resolve each address once in parallel, so that the rest of the lookups are cached
+	{
+		std::set<std::pair<address_t, bool>> addresses;
+		for (auto const &it : taggedBacktrace2Frequency) {
+			Backtrace const &backtrace = it.first._backtrace;
+			for (size_t position = 0; position < backtrace.size(); position++) {
+				addresses.insert(std::make_pair(backtrace[position], /* return address? */ (position > 0)));
+			}
+		}
+		
+		resolveAddresses(addresses);
+	}
+	
+	
+	// Build frequency tables
 	std::map<address_t, freq_t> address2Frequency;
 	std::map<Backtrace, freq_t> backtrace2Frequency;
 	std::map<SymbolicBacktrace, freq_t> symbolicBacktrace2Frequency;
+	std::map<std::string, freq_t> foldedBacktrace2Frequency;
 	
-	{
-		Backtrace backtrace(_profilingBacktraceDepth);
-		SymbolicBacktrace symbolicBacktrace(_profilingBacktraceDepth);
-		backtrace.clear();
-		symbolicBacktrace.clear();
-		int frame = 0;
+	for (auto const &it : taggedBacktrace2Frequency) {
+		TaggedBacktrace const &taggedBacktrace = it.first;
+		Backtrace const &backtrace = taggedBacktrace._backtrace;
+		freq_t frequency = it.second;
 		
-		_bufferListSpinLock.lock();
-		for (address_t *buffer : _bufferList) {
-			long position = 0;
-			frame = 0;
+		// The folded backtraces start by the tag and the outermost frame
+		std::string foldedBacktrace = getTagName(taggedBacktrace);
+		for (size_t position = backtrace.size(); position > 0; position--) {
+			address_t address = backtrace[position - 1];
+			CodeAddressInfo::Entry const &addrInfo = CodeAddressInfo::resolveAddress(address, /* return address? */ (position > 1));
 			
-			while (position < _profilingBufferSize) {
-				address_t address = buffer[position];
+			if (addrInfo.empty()) {
+				std::ostringstream oss;
+				oss << address;
+				foldedBacktrace += ";" + oss.str();
+			}
 				
-				if (address == 0) {
-					if (frame == 0) {
-						// End of buffer
-						break;
-					} else {
-	// 					// End of backtrace
-	// 					assert(frame <= _profilingBacktraceDepth);
-	// 					for (; frame < _profilingBacktraceDepth; frame++) {
-	// 						backtrace[frame] = 0;
-	// 						symbolicBacktrace[frame].clear();
-	// 					}
-						
-						// Increment the frequency of the backtrace
-						{
-							auto it = backtrace2Frequency.find(backtrace);
-							if (it == backtrace2Frequency.end()) {
-								backtrace2Frequency[backtrace] = 1;
-							} else {
-								it->second++;
-							}
-						}
-						{
-							auto it = symbolicBacktrace2Frequency.find(symbolicBacktrace);
-							if (it == symbolicBacktrace2Frequency.end()) {
-								symbolicBacktrace2Frequency[symbolicBacktrace] = 1;
-							} else {
-								it->second++;
-							}
-						}
-						
-						frame = 0;
-						position++;
-						backtrace.clear();
-						symbolicBacktrace.clear();
-						continue;
-					}
-				}
+			// The inlined frames go from the innermost to the outermost
+			for (auto frame = addrInfo._inlinedFrames.rbegin(); frame != addrInfo._inlinedFrames.rend(); frame++) {
+				std::string const &function = CodeAddressInfo::getFunctionName(frame->_functionId);
 				
-				CodeAddressInfo::Entry const &addrInfo = CodeAddressInfo::resolveAddress(address, /* return address? */ (position > 0));
-				for (CodeAddressInfo::InlineFrame const &frameContents : addrInfo._inlinedFrames) {
-					if (frameContents._functionId != id_t()) {
-						_id2sourceFunctionFrequency[frameContents._functionId]++;
-					}
-					if (frameContents._sourceLocationId != id_t()) {
-						_id2sourceLineFrequency[frameContents._sourceLocationId]++;
-					}
+				// A function must have the same name whether it is a caller or not
+				size_t suffixPosition = function.rfind(" [return address]");
+				if ((suffixPosition != std::string::npos) && (suffixPosition + strlen(" [return address]") == function.size())) {
+					foldedBacktrace += ";" + function.substr(0, suffixPosition);
+				} else {
+					foldedBacktrace += ";" + function;
+				}
+			}
+		}
+		foldedBacktrace2Frequency[foldedBacktrace] += frequency;
+		
+		// Busy waits are left out of the rest of the profiles
+		if (taggedBacktrace._kind == SampleTable::idle_sample) {
+			continue;
+		}
+		
+		SymbolicBacktrace symbolicBacktrace(0);
+		for (size_t position = 0; position < backtrace.size(); position++) {
+			CodeAddressInfo::Entry const &addrInfo = CodeAddressInfo::resolveAddress(backtrace[position], /* return address? */ (position > 0));
+			for (CodeAddressInfo::InlineFrame const &frameContents : addrInfo._inlinedFrames) {
+				if (frameContents._functionId != id_t()) {
+					_id2sourceFunctionFrequency[frameContents._functionId] += frequency;
+				}
+				if (frameContents._sourceLocationId != id_t()) {
+					_id2sourceLineFrequency[frameContents._sourceLocationId] += frequency;
 				}
+			}
+						
+			symbolicBacktrace.push_back(addrInfo);
+			
+			// Record the statistics per call site (as opposed to return address)
+			address2Frequency[addrInfo._realAddress] += frequency;
+		}
 				
-				backtrace.push_back(address); // In the backtrace we push the return address
-				symbolicBacktrace.push_back(addrInfo);
-				frame++;
+		backtrace2Frequency[backtrace] += frequency;
+		symbolicBacktrace2Frequency[symbolicBacktrace] += frequency;
+	}
+	taggedBacktrace2Frequency.clear();
 				
-				{
-					auto it = address2Frequency.find(addrInfo._realAddress); // Record the statistics per call site (as opposed to return address)
-					if (it != address2Frequency.end()) {
-						it->second++;
-					} else {
-						address2Frequency[addrInfo._realAddress] = 1;
-					}
-				}
 				
-				position++;
-			}
-			free(buffer);
+	{
+		std::ostringstream oss;
+		oss << "folded-profile-" << getpid() << ".txt";
+		
+		std::ofstream foldedProfile(oss.str().c_str());
+		for (auto const &it : foldedBacktrace2Frequency) {
+			foldedProfile << it.first << " " << it.second << "\n";
 		}
-		_bufferList.clear();
-		_bufferListSpinLock.unlock();
+		foldedProfile.close();
 	}
+	foldedBacktrace2Frequency.clear();
 	
 	
 	std::map<freq_t, std::list<Backtrace>, std::greater<freq_t>> backtracesByFrequency;
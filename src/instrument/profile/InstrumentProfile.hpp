@@ -13,6 +13,7 @@
 #include "Address.hpp"
 #include "InstrumentThreadId.hpp"
 #include "InstrumentThreadLocalData.hpp"
+#include "SampleTable.hpp"
 
 #include <BacktraceWalker.hpp>
 #include <CodeAddressInfo.hpp>
@@ -20,7 +21,9 @@
 
 #include <list>
 #include <map>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -30,15 +33,15 @@ namespace Instrument {
 		// Environment variables
 		EnvironmentVariable<long> _profilingNSResolution;
 		EnvironmentVariable<long> _profilingBacktraceDepth;
-		EnvironmentVariable<long> _profilingBufferSize;
+		EnvironmentVariable<long> _profilingTableSize;
 		
 		
-		typedef uint32_t freq_t;
+		typedef SampleTable::freq_t freq_t;
 		
 		
-		// All the buffers with the collected samples
-		SpinLock _bufferListSpinLock;
-		std::list<address_t *> _bufferList;
+		// The sample tables of all the threads
+		SpinLock _sampleTableListSpinLock;
+		std::list<SampleTable *> _sampleTableList;
 		
 		
 		class SymbolicBacktrace : public std::vector<CodeAddressInfo::Entry> {
@@ -138,11 +141,39 @@ namespace Instrument {
 		};
 		
 		
+		// A backtrace together with what the thread was doing
+		struct TaggedBacktrace {
+			SampleTable::sample_kind_t _kind;
+			nanos6_task_info_t const *_taskInfo;
+			Backtrace _backtrace;
+			
+			TaggedBacktrace(SampleTable::sample_kind_t kind, nanos6_task_info_t const *taskInfo, address_t const *frames, size_t frameCount)
+				: _kind(kind), _taskInfo(taskInfo), _backtrace(0)
+			{
+				_backtrace.assign(frames, frames + frameCount);
+			}
+			
+			bool operator<(TaggedBacktrace const &other) const
+			{
+				if (_kind != other._kind) {
+					return (_kind < other._kind);
+				} else if (_taskInfo != other._taskInfo) {
+					return (_taskInfo < other._taskInfo);
+				} else {
+					return (_backtrace < other._backtrace);
+				}
+			}
+		};
+		
+		
 		// Singleton object
 		static Profile _singleton;
 		
 		static void signalHandler(Sampling::ThreadLocalData &threadLocal);
 		
+		static std::string getTagName(TaggedBacktrace const &taggedBacktrace);
+		static void resolveAddresses(std::set<std::pair<address_t, bool>> const &addresses);
+		
 		
 		void doShutdown();
 		void doCreatedThread();
@@ -156,8 +187,8 @@ namespace Instrument {
 		Profile()
 			: _profilingNSResolution("NANOS6_PROFILE_NS_RESOLUTION", 1000),
 			_profilingBacktraceDepth("NANOS6_PROFILE_BACKTRACE_DEPTH", 4),
-			_profilingBufferSize("NANOS6_PROFILE_BUFFER_SIZE", /* 1 second */ 1000000000UL / _profilingNSResolution),
-			_bufferListSpinLock(), _bufferList()
+			_profilingTableSize("NANOS6_PROFILE_TABLE_SIZE", 4096),
+			_sampleTableListSpinLock(), _sampleTableList()
 		{
 		}
 		
@@ -188,26 +219,37 @@ namespace Instrument {
 		
 		static inline void lightweightEnableForCurrentThread()
 		{
+			// Otherwise the signal handler is safe within a memory allocation, since it does not allocate memory
 			if (BacktraceWalker::involves_libc_malloc) {
 				Sampling::SigProf::lightweightEnableThread();
-			} else {
-				ThreadLocalData &threadLocal = getThreadLocalData();
-				threadLocal._inMemoryAllocation--;
 			}
 		}
 		static inline void lightweightDisableForCurrentThread()
 		{
 			if (BacktraceWalker::involves_libc_malloc) {
 				Sampling::SigProf::lightweightDisableThread();
-			} else {
-				ThreadLocalData &threadLocal = getThreadLocalData();
-				threadLocal._inMemoryAllocation++;
 			}
 		}
 		
-		static inline long getBufferSize()
+		//! \brief Attribute the samples of the current thread to idleness until exitBusyWait is called
+		static inline void enterBusyWait()
+		{
+			ThreadLocalData &threadLocal = getThreadLocalData();
+			threadLocal._busyWaitDepth++;
+		}
+		static inline void exitBusyWait()
+		{
+			ThreadLocalData &threadLocal = getThreadLocalData();
+			threadLocal._busyWaitDepth--;
+		}
+		
+		static inline long getTableSize()
+		{
+			return _singleton._profilingTableSize;
+		}
+		static inline long getBacktraceDepth()
 		{
-			return _singleton._profilingBufferSize;
+			return _singleton._profilingBacktraceDepth;
 		}
 	};
 }
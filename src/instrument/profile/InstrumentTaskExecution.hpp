@@ -1 +0,0 @@
-../null/InstrumentTaskExecution.hpp
\ No newline at end of file
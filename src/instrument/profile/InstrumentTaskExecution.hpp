@@ -0,0 +1,42 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_PROFILE_TASK_EXECUTION_HPP
+#define INSTRUMENT_PROFILE_TASK_EXECUTION_HPP
+
+
+#include <InstrumentInstrumentationContext.hpp>
+
+#include "../api/InstrumentTaskExecution.hpp"
+#include "../support/InstrumentThreadLocalDataSupport.hpp"
+
+#include "InstrumentThreadLocalData.hpp"
+
+
+namespace Instrument {
+	inline void startTask(task_id_t taskId, __attribute__((unused)) InstrumentationContext const &context)
+	{
+		ThreadLocalData &threadLocal = getThreadLocalData();
+		threadLocal.pushTaskType(taskId._taskInfo);
+	}
+	
+	inline void returnToTask(__attribute__((unused)) task_id_t taskId, __attribute__((unused)) InstrumentationContext const &context)
+	{
+	}
+	
+	inline void endTask(__attribute__((unused)) task_id_t taskId, __attribute__((unused)) InstrumentationContext const &context)
+	{
+		ThreadLocalData &threadLocal = getThreadLocalData();
+		threadLocal.popTaskType();
+	}
+	
+	inline void destroyTask(__attribute__((unused)) task_id_t taskId, __attribute__((unused)) InstrumentationContext const &context)
+	{
+	}
+}
+
+
+#endif // INSTRUMENT_PROFILE_TASK_EXECUTION_HPP
@@ -1 +0,0 @@
-../null/InstrumentTaskId.hpp
\ No newline at end of file
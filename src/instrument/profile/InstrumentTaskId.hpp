@@ -0,0 +1,41 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2015-2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_PROFILE_TASK_ID_HPP
+#define INSTRUMENT_PROFILE_TASK_ID_HPP
+
+
+#include <nanos6.h>
+
+
+namespace Instrument {
+	//! The profiler only needs the type of the task to tag the samples
+	struct task_id_t {
+		nanos6_task_info_t const *_taskInfo;
+		
+		task_id_t()
+			: _taskInfo(nullptr)
+		{
+		}
+		
+		task_id_t(nanos6_task_info_t const *taskInfo)
+			: _taskInfo(taskInfo)
+		{
+		}
+		
+		bool operator==(task_id_t const &other) const
+		{
+			return (_taskInfo == other._taskInfo);
+		}
+		
+		operator long() const
+		{
+			return -1;
+		}
+	};
+}
+
+#endif // INSTRUMENT_PROFILE_TASK_ID_HPP
@@ -18,39 +18,64 @@
 
 #include <InstrumentInstrumentationContext.hpp>
 #include <instrument/support/sampling/ThreadLocalData.hpp>
-#include <lowlevel/FatalErrorHandler.hpp>
 
-#include "Address.hpp"
+#include "SampleTable.hpp"
 
-#include <cstdlib>
+#include <nanos6.h>
+
+#include <atomic>
 
 
 namespace Instrument {
 	struct ThreadLocalData : public Instrument::Sampling::ThreadLocalData {
-		address_t *_currentBuffer;
-		long _nextBufferPosition;
+		enum {
+			max_nested_tasks = 16
+		};
+		
+		SampleTable *_sampleTable;
+		
+		//! \brief The types of the tasks that the thread is running, with the innermost at the top
+		nanos6_task_info_t const *_taskTypes[max_nested_tasks];
+		int _nestedTasks;
 		
-		int _inMemoryAllocation;
-		address_t *_nextBuffer;
+		int _busyWaitDepth;
 		
 		ThreadLocalData()
 			: Instrument::Sampling::ThreadLocalData(),
-			_currentBuffer(nullptr), _nextBufferPosition(0),
-			_inMemoryAllocation(0), _nextBuffer(nullptr)
+			_sampleTable(nullptr), _nestedTasks(0), _busyWaitDepth(0)
+		{
+		}
+		
+		void init(size_t tableSize, size_t depth)
 		{
+			_sampleTable = new SampleTable(tableSize, depth);
+		}
+		
+		//! \brief The signal handler may read the stack at any point, so the entry is written before it becomes visible
+		void pushTaskType(nanos6_task_info_t const *taskInfo)
+		{
+			if (_nestedTasks < max_nested_tasks) {
+				_taskTypes[_nestedTasks] = taskInfo;
+			}
+			std::atomic_signal_fence(std::memory_order_release);
+			_nestedTasks++;
 		}
 		
-		void init(size_t bufferSize)
+		void popTaskType()
 		{
-			int rc = posix_memalign((void **) &_currentBuffer, 128, sizeof(address_t) * bufferSize);
-			FatalErrorHandler::handle(rc, " allocating a buffer of ", sizeof(address_t) * bufferSize, " bytes for profiling");
+			_nestedTasks--;
 		}
 		
-		void allocateNextBuffer(size_t bufferSize)
+		//! \brief Get the type of the innermost task, or null if the thread is running runtime code
+		nanos6_task_info_t const *getCurrentTaskType() const
 		{
-			if (_nextBuffer == nullptr) {
-				int rc = posix_memalign((void **) &_nextBuffer, 128, sizeof(address_t) * bufferSize);
-				FatalErrorHandler::handle(rc, " allocating a buffer of ", sizeof(address_t) * bufferSize, " bytes for profiling");
+			if (_nestedTasks == 0) {
+				return nullptr;
+			} else if (_nestedTasks <= max_nested_tasks) {
+				return _taskTypes[_nestedTasks - 1];
+			} else {
+				// Attribute the tasks nested too deep to the deepest one that is known
+				return _taskTypes[max_nested_tasks - 1];
 			}
 		}
 	};
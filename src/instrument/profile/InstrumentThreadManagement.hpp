@@ -38,7 +38,7 @@ namespace Instrument {
 		// Force the sentinel worker TLS to be initialized
 		{
 			ThreadLocalData &sentinelThreadLocal = getThreadLocalData();
-			sentinelThreadLocal.init(Profile::getBufferSize());
+			sentinelThreadLocal.init(Profile::getTableSize(), Profile::getBacktraceDepth());
 		}
 	}
 	
@@ -72,12 +72,12 @@ namespace Instrument {
 	
 	inline void threadEnterBusyWait(__attribute__((unused)) busy_wait_reason_t reason)
 	{
-		Profile::disableForCurrentThread();
+		Profile::enterBusyWait();
 	}
 	
 	inline void threadExitBusyWait()
 	{
-		Profile::enableForCurrentThread();
+		Profile::exitBusyWait();
 	}
 	
 }
@@ -0,0 +1,172 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_PROFILE_SAMPLE_TABLE_HPP
+#define INSTRUMENT_PROFILE_SAMPLE_TABLE_HPP
+
+
+#include <lowlevel/FatalErrorHandler.hpp>
+
+#include "Address.hpp"
+
+#include <nanos6.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace Instrument {
+	//! \brief Bounded hash table with the aggregated samples of a thread
+	//!
+	//! The table is filled from the signal handler, so it never allocates
+	//! memory. Samples with the same tag and backtrace share an entry that
+	//! counts them. A sample that does not find its entry or a free one
+	//! within a few probes is dropped.
+	class SampleTable {
+	public:
+		typedef uint32_t freq_t;
+		
+		enum sample_kind_t : uint8_t {
+			runtime_sample = 0,
+			task_sample,
+			idle_sample
+		};
+		
+		struct Sample {
+			uint64_t _hash;
+			nanos6_task_info_t const *_taskInfo;
+			freq_t _count;
+			uint16_t _frameCount;
+			sample_kind_t _kind;
+		};
+	
+	private:
+		enum sample_table_constants_t {
+			max_probes = 16
+		};
+		
+		size_t _capacity;
+		size_t _depth;
+		
+		Sample *_samples;
+		address_t *_frames;
+		
+		size_t _droppedSamples;
+		
+		static inline uint64_t hash(sample_kind_t kind, nanos6_task_info_t const *taskInfo, address_t const *frames, size_t frameCount)
+		{
+			// FNV-1a over the words of the key
+			uint64_t result = 14695981039346656037ULL;
+			result = (result ^ (uint64_t) kind) * 1099511628211ULL;
+			result = (result ^ (uint64_t) taskInfo) * 1099511628211ULL;
+			for (size_t frame = 0; frame < frameCount; frame++) {
+				result = (result ^ (uint64_t) frames[frame]) * 1099511628211ULL;
+			}
+			
+			return result;
+		}
+	
+	public:
+		//! \param[in] capacity the number of entries, which is rounded up to a power of two
+		//! \param[in] depth the maximum number of frames of a backtrace
+		SampleTable(size_t capacity, size_t depth)
+			: _capacity(1), _depth(depth), _droppedSamples(0)
+		{
+			while (_capacity < capacity) {
+				_capacity <<= 1;
+			}
+			
+			// One more backtrace to hold the one that is being recorded
+			_samples = (Sample *) malloc(sizeof(Sample) * _capacity);
+			_frames = (address_t *) malloc(sizeof(address_t) * (_capacity + 1) * _depth);
+			FatalErrorHandler::failIf(
+				(_samples == nullptr) || (_frames == nullptr),
+				"allocating ", sizeof(Sample) * _capacity + sizeof(address_t) * (_capacity + 1) * _depth, " bytes for profiling"
+			);
+			
+			clear();
+		}
+		
+		~SampleTable()
+		{
+			free(_samples);
+			free(_frames);
+		}
+		
+		SampleTable(SampleTable const &) = delete;
+		SampleTable &operator=(SampleTable const &) = delete;
+		
+		void clear()
+		{
+			memset(_samples, 0, sizeof(Sample) * _capacity);
+			_droppedSamples = 0;
+		}
+		
+		size_t getCapacity() const
+		{
+			return _capacity;
+		}
+		
+		size_t getDroppedSamples() const
+		{
+			return _droppedSamples;
+		}
+		
+		Sample const &getSample(size_t index) const
+		{
+			return _samples[index];
+		}
+		
+		address_t const *getFrames(size_t index) const
+		{
+			return &_frames[index * _depth];
+		}
+		
+		//! \brief Get the buffer where the backtrace of the next sample must be stored
+		address_t *getPendingFrames()
+		{
+			return &_frames[_capacity * _depth];
+		}
+		
+		//! \brief Count the backtrace of the pending frames
+		void record(sample_kind_t kind, nanos6_task_info_t const *taskInfo, size_t frameCount)
+		{
+			address_t const *frames = getPendingFrames();
+			uint64_t key = hash(kind, taskInfo, frames, frameCount);
+			
+			for (size_t probe = 0; probe < max_probes; probe++) {
+				size_t index = (key + probe) & (_capacity - 1);
+				Sample &sample = _samples[index];
+				address_t *sampleFrames = &_frames[index * _depth];
+				
+				if (sample._count == 0) {
+					memcpy(sampleFrames, frames, sizeof(address_t) * frameCount);
+					sample._hash = key;
+					sample._taskInfo = taskInfo;
+					sample._frameCount = frameCount;
+					sample._kind = kind;
+					sample._count = 1;
+					return;
+				}
+				
+				if (
+					(sample._hash == key) && (sample._kind == kind) && (sample._taskInfo == taskInfo)
+					&& (sample._frameCount == frameCount)
+					&& (memcmp(sampleFrames, frames, sizeof(address_t) * frameCount) == 0)
+				) {
+					sample._count++;
+					return;
+				}
+			}
+			
+			_droppedSamples++;
+		}
+	};
+}
+
+
+#endif // INSTRUMENT_PROFILE_SAMPLE_TABLE_HPP
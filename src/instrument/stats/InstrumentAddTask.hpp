@@ -15,6 +15,11 @@
 
 namespace Instrument {
 	
+	inline void registeredNewTaskType(nanos6_task_info_t *taskInfo)
+	{
+		Stats::getTaskTypeIndex(taskInfo);
+	}
+	
 	inline task_id_t enterAddTask(
 		nanos6_task_info_t *taskInfo,
 		__attribute__((unused)) nanos6_task_invocation_info_t *taskInvokationInfo,
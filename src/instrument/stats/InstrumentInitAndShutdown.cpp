@@ -5,6 +5,7 @@
 */
 
 #include "InstrumentInitAndShutdown.hpp"
+#include "InstrumentLiveStats.hpp"
 #include "InstrumentStats.hpp"
 #include "lowlevel/EnvironmentVariable.hpp"
 #include <executors/threads/ThreadManager.hpp>
@@ -17,6 +18,23 @@
 
 namespace Instrument {
 	namespace Stats {
+		static void emitLatencies(std::ofstream &output, std::string const &name, char const *state, LatencyHistogram const &histogram)
+		{
+			static const double percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+			
+			if (histogram.getTotalCount() == 0) {
+				return;
+			}
+			
+			for (double percentile : percentiles) {
+				output << "STATS\t" << name << " p" << percentile << " " << state << " time\t"
+					<< histogram.getValueAtPercentile(percentile) << "\t" << Timer::getUnits() << std::endl;
+			}
+			output << "STATS\t" << name << " max " << state << " time\t"
+				<< histogram.getMax() << "\t" << Timer::getUnits() << std::endl;
+		}
+		
+		
 		static void emitTaskInfo(std::ofstream &output, std::string const &name, TaskInfo &taskInfo)
 		{
 			TaskTimes meanTimes = taskInfo._times / taskInfo._numInstances;
@@ -46,6 +64,11 @@ namespace Instrument {
 			output << "STATS\t" << name << " mean lifetime\t"
 				<< meanTimes.getTotal() << "\t" << Timer::getUnits() << std::endl;
 			
+			emitLatencies(output, name, "pending", taskInfo._latencies._pendingTime);
+			emitLatencies(output, name, "ready", taskInfo._latencies._readyTime);
+			emitLatencies(output, name, "execution", taskInfo._latencies._executionTime);
+			emitLatencies(output, name, "blocked", taskInfo._latencies._blockedTime);
+			
 			for (HardwareCounters::counter_value_t const &counterValue : taskInfo._hardwareCounters[0]) {
 				output << "STATS\t" << name << " " << counterValue._name << "\t";
 				
@@ -77,6 +100,8 @@ namespace Instrument {
 		_phasesSpinLock.writeLock();
 		_phaseTimes.emplace_back(true);
 		_phasesSpinLock.writeUnlock();
+		
+		Live::initialize();
 	}
 	
 	
@@ -85,6 +110,7 @@ namespace Instrument {
 		_totalTime.stop();
 		double totalTime = _totalTime;
 		
+		Live::shutdown();
 		HardwareCounters::shutdown();
 		
 		ThreadInfo accumulatedThreadInfo(false);
@@ -107,8 +133,10 @@ namespace Instrument {
 		double averageThreadTime = totalThreadTime / (double) numThreads;
 		
 		TaskInfo accumulatedTaskInfo;
-		for (auto &taskInfoEntry : accumulatedPhaseInfo._perTask) {
-			accumulatedTaskInfo += taskInfoEntry.second;
+		for (TaskInfo const *taskInfo : accumulatedPhaseInfo._perTask) {
+			if (taskInfo != nullptr) {
+				accumulatedTaskInfo += *taskInfo;
+			}
 		}
 		
 		EnvironmentVariable<std::string> _outputFilename("NANOS6_STATS_FILE", "/dev/stderr");
@@ -130,21 +158,16 @@ namespace Instrument {
 		}
 		
 		
-		for (auto &taskInfoEntry : accumulatedPhaseInfo._perTask) {
-			nanos6_task_info_t const *userSideTaskInfo = taskInfoEntry.first;
-			
-			assert(userSideTaskInfo != 0);
-			std::string name;
-			if ((userSideTaskInfo->implementations[0].task_label != nullptr) && (userSideTaskInfo->implementations[0].task_label[0] != '\0')) {
-				name = userSideTaskInfo->implementations[0].task_label;
-			} else if (userSideTaskInfo->implementations[0].declaration_source != 0) {
-				name = userSideTaskInfo->implementations[0].declaration_source;
-			} else {
-				name = "Unknown task";
+		for (size_t typeIndex = 0; typeIndex < accumulatedPhaseInfo._perTask.size(); typeIndex++) {
+			TaskInfo *taskInfo = accumulatedPhaseInfo._perTask[typeIndex];
+			if (taskInfo == nullptr) {
+				continue;
 			}
 			
+			std::string name = getTaskTypeName(TaskTypeRegistry::getTaskInfo(typeIndex));
+			
 			output << std::endl;
-			emitTaskInfo(output, name, taskInfoEntry.second);
+			emitTaskInfo(output, name, *taskInfo);
 		}
 		
 		{
@@ -152,19 +175,14 @@ namespace Instrument {
 			for (auto &phaseInfo : accumulatedThreadInfo._phaseInfo) {
 				TaskInfo currentPhaseAccumulatedTaskInfo;
 				
-				for (auto &taskInfoEntry : phaseInfo._perTask) {
-					nanos6_task_info_t const *userSideTaskInfo = taskInfoEntry.first;
-					
-					assert(userSideTaskInfo != 0);
-					std::string name;
-					if ((userSideTaskInfo->implementations[0].task_label != nullptr) && (userSideTaskInfo->implementations[0].task_label[0] != '\0')) {
-						name = userSideTaskInfo->implementations[0].task_label;
-					} else if (userSideTaskInfo->implementations[0].declaration_source != 0) {
-						name = userSideTaskInfo->implementations[0].declaration_source;
-					} else {
-						name = "Unknown task";
+				for (size_t typeIndex = 0; typeIndex < phaseInfo._perTask.size(); typeIndex++) {
+					TaskInfo *taskInfo = phaseInfo._perTask[typeIndex];
+					if (taskInfo == nullptr) {
+						continue;
 					}
 					
+					std::string name = getTaskTypeName(TaskTypeRegistry::getTaskInfo(typeIndex));
+					
 					if (name == "main") {
 						// Main ends up in the last phase despite the fact that it contributes to all of them
 						continue;
@@ -174,9 +192,9 @@ namespace Instrument {
 					oss << "Phase " << (phase+1) << " " << name;
 					
 					output << std::endl;
-					emitTaskInfo(output, oss.str(), taskInfoEntry.second);
+					emitTaskInfo(output, oss.str(), *taskInfo);
 					
-					currentPhaseAccumulatedTaskInfo += taskInfoEntry.second;
+					currentPhaseAccumulatedTaskInfo += *taskInfo;
 				}
 				
 				if (currentPhaseAccumulatedTaskInfo._numInstances > 0) {
@@ -1 +0,0 @@
-../null/InstrumentLeaderThread.hpp
\ No newline at end of file
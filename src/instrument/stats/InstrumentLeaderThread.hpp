@@ -0,0 +1,25 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2015-2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_STATS_LEADER_THREAD_HPP
+#define INSTRUMENT_STATS_LEADER_THREAD_HPP
+
+
+#include "../api/InstrumentLeaderThread.hpp"
+
+#include "InstrumentLiveStats.hpp"
+
+
+namespace Instrument {
+	inline void leaderThreadSpin()
+	{
+		Stats::Live::publishIfDue();
+	}
+	
+}
+
+
+#endif // INSTRUMENT_STATS_LEADER_THREAD_HPP
@@ -0,0 +1,217 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "InstrumentLiveStats.hpp"
+#include "InstrumentStats.hpp"
+#include "LiveStatsSegment.hpp"
+
+#include "executors/threads/CPUManager.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "system/RuntimeInfo.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace Instrument {
+	namespace Stats {
+		namespace Live {
+			bool _enabled(false);
+			std::atomic<int64_t> _readyTasks(0);
+			
+			unsigned int _cpuCount(0);
+			CPUActivity *_cpuActivity(nullptr);
+			
+			uint64_t _interval(0);
+			uint64_t _nextUpdate(0);
+			
+			static uint64_t _startTime(0);
+			static std::string _segmentName;
+			static size_t _segmentSize(0);
+			static SegmentHeader *_header(nullptr);
+			
+			
+			void initialize()
+			{
+				EnvironmentVariable<unsigned long> interval("NANOS6_STATS_LIVE_INTERVAL", 0);
+				if (interval.getValue() == 0) {
+					return;
+				}
+				
+				_cpuCount = CPUManager::getTotalCPUs();
+				_segmentName = getSegmentName(getpid());
+				_segmentSize = getSegmentSize(_cpuCount);
+				
+				int fd = shm_open(_segmentName.c_str(), O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR);
+				FatalErrorHandler::warnIf(fd == -1, "Cannot create the live statistics segment ", _segmentName, ": ", strerror(errno));
+				if (fd == -1) {
+					return;
+				}
+				
+				int rc = ftruncate(fd, _segmentSize);
+				FatalErrorHandler::handle(rc == 0 ? 0 : errno, " resizing the live statistics segment ", _segmentName);
+				
+				void *segment = mmap(nullptr, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				FatalErrorHandler::handle(segment == MAP_FAILED ? errno : 0, " mapping the live statistics segment ", _segmentName);
+				close(fd);
+				
+				_header = new (segment) SegmentHeader();
+				_header->_magic = segment_magic;
+				_header->_version = segment_version;
+				_header->_sequence.store(0);
+				_header->_pid = getpid();
+				_header->_cpuCount = _cpuCount;
+				_header->_interval = interval.getValue() * 1000000UL;
+				
+				_cpuActivity = new CPUActivity[_cpuCount];
+				
+				_interval = _header->_interval;
+				_startTime = getTimestamp();
+				_nextUpdate = _startTime + _interval;
+				for (unsigned int cpu = 0; cpu < _cpuCount; cpu++) {
+					_cpuActivity[cpu]._lastTransition = _startTime;
+				}
+				
+				_enabled = true;
+				
+				RuntimeInfo::addEntry("live_stats_segment", "Live Statistics Segment", _segmentName);
+				RuntimeInfo::addEntry("live_stats_interval", "Live Statistics Update Interval", interval.getValue(), "ms");
+			}
+			
+			
+			void shutdown()
+			{
+				if (!_enabled) {
+					return;
+				}
+				
+				// Leave the final values for any attached monitor
+				publish();
+				_enabled = false;
+				
+				munmap(_header, _segmentSize);
+				shm_unlink(_segmentName.c_str());
+				_header = nullptr;
+				
+				delete[] _cpuActivity;
+				_cpuActivity = nullptr;
+			}
+			
+			
+			static void fillTaskTypeEntry(TaskTypeEntry &entry, nanos6_task_info_t const *type, TaskInfo &taskInfo)
+			{
+				std::string label = getTaskTypeName(type);
+				strncpy(entry._label, label.c_str(), task_type_label_length - 1);
+				entry._label[task_type_label_length - 1] = '\0';
+				
+				entry._instances = taskInfo._numInstances;
+				entry._pendingTime = (long) taskInfo._times._pendingTime;
+				entry._readyTime = (long) taskInfo._times._readyTime;
+				entry._executionTime = (long) taskInfo._times._executionTime;
+				entry._blockedTime = (long) taskInfo._times._blockedTime;
+				
+				entry._counterCount = 0;
+				for (HardwareCounters::counter_value_t const &counterValue : taskInfo._hardwareCounters[0]) {
+					if (entry._counterCount == max_task_type_counters) {
+						break;
+					}
+					
+					CounterEntry &counterEntry = entry._counters[entry._counterCount];
+					strncpy(counterEntry._name, counterValue._name.c_str(), counter_name_length - 1);
+					counterEntry._name[counter_name_length - 1] = '\0';
+					if (counterValue._isInteger) {
+						counterEntry._value = counterValue._integerValue;
+					} else {
+						counterEntry._value = counterValue._floatValue;
+					}
+					
+					entry._counterCount++;
+				}
+			}
+			
+			
+			void publish()
+			{
+				assert(_header != nullptr);
+				
+				// Gather the per task type statistics without stopping the workers for longer than a copy
+				PhaseInfo accumulated(false);
+				unsigned int threadCount = 0;
+				{
+					std::lock_guard<SpinLock> guard(_threadInfoListSpinLock);
+					for (ThreadInfo *threadInfo : _threadInfoList) {
+						std::lock_guard<SpinLock> threadGuard(threadInfo->_lock);
+						for (PhaseInfo const &phaseInfo : threadInfo->_phaseInfo) {
+							accumulated += phaseInfo;
+						}
+						threadCount++;
+					}
+				}
+				
+				uint64_t now = getTimestamp();
+				
+				// Odd sequence numbers tell the readers that the contents are being modified
+				_header->_sequence.fetch_add(1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				
+				_header->_timestamp = now - _startTime;
+				_header->_updates++;
+				_header->_readyTasks = _readyTasks.load(std::memory_order_relaxed);
+				_header->_threadCount = threadCount;
+				
+				CPUEntry *cpuEntries = getCPUEntries(_header);
+				for (unsigned int cpu = 0; cpu < _cpuCount; cpu++) {
+					CPUActivity &activity = _cpuActivity[cpu];
+					
+					uint64_t busyTime = activity._busyTime.load(std::memory_order_relaxed);
+					uint64_t idleTime = activity._idleTime.load(std::memory_order_relaxed);
+					uint64_t last = activity._lastTransition.load(std::memory_order_relaxed);
+					
+					// Account for the current state up to now
+					if (now > last) {
+						if (activity._busy.load(std::memory_order_relaxed)) {
+							busyTime += now - last;
+						} else {
+							idleTime += now - last;
+						}
+					}
+					
+					cpuEntries[cpu]._busyTime = busyTime;
+					cpuEntries[cpu]._idleTime = idleTime;
+				}
+				
+				TaskTypeEntry *taskTypeEntries = getTaskTypeEntries(_header);
+				unsigned int taskTypeCount = 0;
+				for (size_t typeIndex = 0; typeIndex < accumulated._perTask.size(); typeIndex++) {
+					if (taskTypeCount == max_task_types) {
+						break;
+					}
+					
+					TaskInfo *taskInfo = accumulated._perTask[typeIndex];
+					nanos6_task_info_t const *type = TaskTypeRegistry::getTaskInfo(typeIndex);
+					if ((taskInfo == nullptr) || (type == nullptr)) {
+						continue;
+					}
+					
+					fillTaskTypeEntry(taskTypeEntries[taskTypeCount], type, *taskInfo);
+					taskTypeCount++;
+				}
+				_header->_taskTypeCount = taskTypeCount;
+				
+				_header->_sequence.fetch_add(1, std::memory_order_release);
+			}
+		}
+	}
+}
@@ -0,0 +1,131 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef INSTRUMENT_LIVE_STATS_HPP
+#define INSTRUMENT_LIVE_STATS_HPP
+
+
+#include <atomic>
+#include <cstdint>
+
+#include <time.h>
+
+
+namespace Instrument {
+	namespace Stats {
+		//! \brief Periodic publication of the statistics while the program runs
+		//!
+		//! It is enabled by setting NANOS6_STATS_LIVE_INTERVAL to the number
+		//! of milliseconds between updates. The leader thread then copies the
+		//! accumulated statistics into a shared memory segment (see
+		//! LiveStatsSegment.hpp) that the nanos6-stats-monitor command reads.
+		namespace Live {
+			struct CPUActivity {
+				std::atomic<uint64_t> _busyTime;
+				std::atomic<uint64_t> _idleTime;
+				std::atomic<uint64_t> _lastTransition;
+				std::atomic<bool> _busy;
+				
+				CPUActivity()
+					: _busyTime(0), _idleTime(0), _lastTransition(0), _busy(false)
+				{
+				}
+			};
+			
+			
+			//! \brief Set once at initialization time if the publication has been requested
+			extern bool _enabled;
+			
+			//! \brief Tasks that have become ready and have not started to run
+			extern std::atomic<int64_t> _readyTasks;
+			
+			extern unsigned int _cpuCount;
+			extern CPUActivity *_cpuActivity;
+			
+			extern uint64_t _interval;
+			extern uint64_t _nextUpdate;
+			
+			
+			void initialize();
+			void shutdown();
+			
+			//! \brief Copy the current statistics into the shared memory segment
+			void publish();
+			
+			
+			inline uint64_t getTimestamp()
+			{
+				struct timespec ts;
+				clock_gettime(CLOCK_MONOTONIC, &ts);
+				
+				return ((uint64_t) ts.tv_sec) * 1000000000UL + (uint64_t) ts.tv_nsec;
+			}
+			
+			//! \brief Called periodically by the leader thread
+			inline void publishIfDue()
+			{
+				if (!_enabled) {
+					return;
+				}
+				
+				uint64_t now = getTimestamp();
+				if (now < _nextUpdate) {
+					return;
+				}
+				
+				_nextUpdate = now + _interval;
+				publish();
+			}
+			
+			inline void cpuBecomesBusy(unsigned int cpu)
+			{
+				if (!_enabled || (cpu >= _cpuCount)) {
+					return;
+				}
+				
+				CPUActivity &activity = _cpuActivity[cpu];
+				uint64_t now = getTimestamp();
+				uint64_t last = activity._lastTransition.exchange(now, std::memory_order_relaxed);
+				
+				if (!activity._busy.exchange(true, std::memory_order_relaxed)) {
+					activity._idleTime.fetch_add(now - last, std::memory_order_relaxed);
+				}
+			}
+			
+			inline void cpuBecomesIdle(unsigned int cpu)
+			{
+				if (!_enabled || (cpu >= _cpuCount)) {
+					return;
+				}
+				
+				CPUActivity &activity = _cpuActivity[cpu];
+				uint64_t now = getTimestamp();
+				uint64_t last = activity._lastTransition.exchange(now, std::memory_order_relaxed);
+				
+				if (activity._busy.exchange(false, std::memory_order_relaxed)) {
+					activity._busyTime.fetch_add(now - last, std::memory_order_relaxed);
+				}
+			}
+			
+			inline void taskBecomesReady()
+			{
+				if (_enabled) {
+					_readyTasks.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			
+			inline void readyTaskStarts()
+			{
+				if (_enabled) {
+					_readyTasks.fetch_sub(1, std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+}
+
+
+#endif // INSTRUMENT_LIVE_STATS_HPP
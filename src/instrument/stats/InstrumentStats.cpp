@@ -13,7 +13,7 @@
 namespace Instrument {
 	namespace Stats {
 		RWTicketSpinLock _phasesSpinLock;
-		int _currentPhase(0);
+		std::atomic<int> _currentPhase(0);
 		std::vector<Timer> _phaseTimes;
 		
 		SpinLock _threadInfoListSpinLock;
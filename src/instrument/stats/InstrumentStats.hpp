@@ -7,14 +7,20 @@
 #ifndef INSTRUMENT_STATS_HPP
 #define INSTRUMENT_STATS_HPP
 
+#include <atomic>
+#include <cassert>
 #include <list>
-#include <map>
+#include <string>
 #include <vector>
 
 #include <nanos6.h>
 
+#include "lowlevel/FatalErrorHandler.hpp"
 #include "lowlevel/RWTicketSpinLock.hpp"
 #include "lowlevel/SpinLock.hpp"
+#include "tasks/TaskTypeRegistry.hpp"
+#include "InstrumentLiveStats.hpp"
+#include "LatencyHistogram.hpp"
 #include "Timer.hpp"
 
 #include "performance/HardwareCounters.hpp"
@@ -22,10 +28,36 @@
 
 namespace Instrument {
 	namespace Stats {
+		//! \brief Protects _phaseTimes, which is only accessed when a thread detects a phase change
 		extern RWTicketSpinLock _phasesSpinLock;
-		extern int _currentPhase;
+		
+		//! \brief Index of the current phase, which is published after extending _phaseTimes
+		extern std::atomic<int> _currentPhase;
 		extern std::vector<Timer> _phaseTimes;
 		
+		
+		inline std::string getTaskTypeName(nanos6_task_info_t const *userSideTaskInfo)
+		{
+			assert(userSideTaskInfo != 0);
+			
+			if ((userSideTaskInfo->implementations[0].task_label != nullptr) && (userSideTaskInfo->implementations[0].task_label[0] != '\0')) {
+				return userSideTaskInfo->implementations[0].task_label;
+			} else if (userSideTaskInfo->implementations[0].declaration_source != 0) {
+				return userSideTaskInfo->implementations[0].declaration_source;
+			} else {
+				return "Unknown task";
+			}
+		}
+		
+		inline size_t getTaskTypeIndex(nanos6_task_info_t const *type)
+		{
+			size_t typeIndex = TaskTypeRegistry::getIndex(type);
+			FatalErrorHandler::failIf(typeIndex == TaskTypeRegistry::invalid_index,
+				"The stats instrumentation supports up to ", (size_t) TaskTypeRegistry::max_task_types, " task types");
+			
+			return typeIndex;
+		}
+		
 		struct TaskTimes {
 			Timer _instantiationTime;
 			Timer _pendingTime;
@@ -87,13 +119,48 @@ namespace Instrument {
 		};
 		
 		
+		//! \brief Distribution of the time that the instances of a task type spend in each state
+		struct TaskLatencies {
+			LatencyHistogram _pendingTime;
+			LatencyHistogram _readyTime;
+			LatencyHistogram _executionTime;
+			LatencyHistogram _blockedTime;
+			
+			TaskLatencies()
+				: _pendingTime(), _readyTime(), _executionTime(), _blockedTime()
+			{
+			}
+			
+			TaskLatencies &operator+=(TaskTimes const &instanceTimes)
+			{
+				_pendingTime.record((long) instanceTimes._pendingTime);
+				_readyTime.record((long) instanceTimes._readyTime);
+				_executionTime.record((long) instanceTimes._executionTime);
+				_blockedTime.record((long) instanceTimes._blockedTime);
+				
+				return *this;
+			}
+			
+			TaskLatencies &operator+=(TaskLatencies const &other)
+			{
+				_pendingTime += other._pendingTime;
+				_readyTime += other._readyTime;
+				_executionTime += other._executionTime;
+				_blockedTime += other._blockedTime;
+				
+				return *this;
+			}
+		};
+		
+		
 		struct TaskInfo {
 			long _numInstances;
 			TaskTimes _times;
+			TaskLatencies _latencies;
 			HardwareCounters::Counters<> _hardwareCounters;
 			
 			TaskInfo()
-				: _numInstances(0), _times(true), _hardwareCounters()
+				: _numInstances(0), _times(true), _latencies(), _hardwareCounters()
 			{
 			}
 			
@@ -101,6 +168,7 @@ namespace Instrument {
 			{
 				_numInstances++;
 				_times += instanceTimes;
+				_latencies += instanceTimes;
 				
 				return *this;
 			}
@@ -116,6 +184,7 @@ namespace Instrument {
 			{
 				_numInstances += other._numInstances;
 				_times += other._times;
+				_latencies += other._latencies;
 				_hardwareCounters += other._hardwareCounters;
 				
 				return *this;
@@ -129,20 +198,25 @@ namespace Instrument {
 		
 		struct TaskTypeAndTimes {
 			nanos6_task_info_t const *_type;
+			size_t _typeIndex;
 			TaskTimes _times;
 			bool _hasParent;
 			Timer *_currentTimer;
 			HardwareCounters::ThreadCounters<> _hardwareCounters;
 			
 			TaskTypeAndTimes(nanos6_task_info_t const *type, bool hasParent)
-				: _type(type), _times(false), _hasParent(hasParent), _currentTimer(&_times._instantiationTime), _hardwareCounters()
+				: _type(type), _typeIndex(getTaskTypeIndex(type)), _times(false), _hasParent(hasParent), _currentTimer(&_times._instantiationTime), _hardwareCounters()
 			{
 			}
 		};
 		
 		
 		struct PhaseInfo {
-			std::map<nanos6_task_info_t const *, TaskInfo> _perTask;
+			//! \brief The statistics of each task type indexed by its TaskTypeRegistry index
+			//!
+			//! The entries are allocated on their first use, since most threads and
+			//! phases only run a few of the task types.
+			std::vector<TaskInfo *> _perTask;
 			Timer _runningTime;
 			Timer _blockedTime;
 			HardwareCounters::Counters<> _hardwareCounters;
@@ -155,10 +229,36 @@ namespace Instrument {
 			{
 			}
 			
+			PhaseInfo(PhaseInfo const &other) = delete;
+			PhaseInfo &operator=(PhaseInfo const &other) = delete;
+			
+			~PhaseInfo()
+			{
+				for (TaskInfo *taskInfo : _perTask) {
+					delete taskInfo;
+				}
+			}
+			
+			TaskInfo &getTaskInfo(size_t typeIndex)
+			{
+				if (typeIndex >= _perTask.size()) {
+					_perTask.resize(typeIndex + 1, nullptr);
+				}
+				
+				TaskInfo *&taskInfo = _perTask[typeIndex];
+				if (taskInfo == nullptr) {
+					taskInfo = new TaskInfo();
+				}
+				
+				return *taskInfo;
+			}
+			
 			PhaseInfo &operator+=(PhaseInfo const &other)
 			{
-				for (auto &perTaskEntry : other._perTask) {
-					_perTask[perTaskEntry.first] += perTaskEntry.second;
+				for (size_t typeIndex = 0; typeIndex < other._perTask.size(); typeIndex++) {
+					if (other._perTask[typeIndex] != nullptr) {
+						getTaskInfo(typeIndex) += *other._perTask[typeIndex];
+					}
 				}
 				
 				_runningTime += other._runningTime;
@@ -199,12 +299,30 @@ namespace Instrument {
 		struct ThreadInfo {
 			std::list<PhaseInfo> _phaseInfo;
 			
+			//! \brief Protects the contents against the live statistics publisher
+			SpinLock _lock;
+			
 			ThreadInfo(bool active=true)
-				: _phaseInfo()
+				: _phaseInfo(), _lock()
 			{
 				_phaseInfo.emplace_back(active);
 			}
 			
+			//! \brief Must surround any modification if the contents are published while running
+			void beginUpdate()
+			{
+				if (Live::_enabled) {
+					_lock.lock();
+				}
+			}
+			
+			void endUpdate()
+			{
+				if (Live::_enabled) {
+					_lock.unlock();
+				}
+			}
+			
 			ThreadInfo &operator+=(ThreadInfo const &other)
 			{
 				unsigned int phases = other._phaseInfo.size();
@@ -227,25 +345,32 @@ namespace Instrument {
 			
 			PhaseInfo &getCurrentPhaseRef()
 			{
+				int lastStartedPhase = _phaseInfo.size() - 1;
+				
+				// Fast path: the phase has not changed since the last call of this thread
+				if (lastStartedPhase == _currentPhase.load(std::memory_order_acquire)) {
+					return _phaseInfo.back();
+				}
+				
 				Instrument::Stats::_phasesSpinLock.readLock();
 				
-				assert(_currentPhase == (_phaseTimes.size() - 1));
-				int lastStartedPhase = _phaseInfo.size() - 1;
+				int currentPhase = _currentPhase.load(std::memory_order_relaxed);
+				assert(currentPhase == (int) (_phaseTimes.size() - 1));
 				
 				if (lastStartedPhase == -1) {
 					// Add the previous phases as empty
-					for (int phase = 0; phase < _currentPhase-1; phase++) {
+					for (int phase = 0; phase < currentPhase-1; phase++) {
 						_phaseInfo.emplace_back(false);
 					}
 					// Start the new phase
 					_phaseInfo.emplace_back(true);
-				} else if (lastStartedPhase < _currentPhase) {
+				} else if (lastStartedPhase < currentPhase) {
 					// Fix the stopping time of the last phase
 					bool isRunning = _phaseInfo.back().isRunning();
 					_phaseInfo.back().stoppedAt(_phaseTimes[lastStartedPhase]);
 					
 					// Mark any already finished phase that is missing and the current phase as blocked
-					for (int phase = lastStartedPhase+1; phase <= _currentPhase; phase++) {
+					for (int phase = lastStartedPhase+1; phase <= currentPhase; phase++) {
 						_phaseInfo.emplace_back(false);
 						
 						if (isRunning) {
@@ -34,10 +34,12 @@ namespace Instrument {
 		taskId->_currentTimer = 0;
 		
 		ThreadLocalData &threadLocal = getThreadLocalData();
+		threadLocal._threadInfo.beginUpdate();
 		Instrument::Stats::PhaseInfo &phaseInfo = threadLocal._threadInfo.getCurrentPhaseRef();
-		Instrument::Stats::TaskInfo &taskInfo = phaseInfo._perTask[taskId->_type];
+		Instrument::Stats::TaskInfo &taskInfo = phaseInfo.getTaskInfo(taskId->_typeIndex);
 		taskInfo += taskId->_times;
 		taskInfo += taskId->_hardwareCounters;
+		threadLocal._threadInfo.endUpdate();
 		
 		delete taskId;
 	}
@@ -34,6 +34,8 @@ namespace Instrument {
 		
 		taskId->_currentTimer->continueAt(taskId->_times._readyTime);
 		taskId->_currentTimer = &taskId->_times._readyTime;
+		
+		Stats::Live::taskBecomesReady();
 	}
 	
 	inline void taskIsExecuting(
@@ -42,6 +44,10 @@ namespace Instrument {
 	{
 		assert(taskId->_currentTimer != 0);
 		
+		if (taskId->_currentTimer == &taskId->_times._readyTime) {
+			Stats::Live::readyTaskStarts();
+		}
+		
 		taskId->_currentTimer->continueAt(taskId->_times._executionTime);
 		taskId->_currentTimer = &taskId->_times._executionTime;
 		
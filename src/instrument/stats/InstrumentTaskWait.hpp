@@ -36,11 +36,12 @@ namespace Instrument {
 		if (!taskId->_hasParent) {
 			Instrument::Stats::_phasesSpinLock.writeLock();
 			
-			assert(Instrument::Stats::_currentPhase == (Instrument::Stats::_phaseTimes.size() - 1));
+			assert(Instrument::Stats::_currentPhase == (int) (Instrument::Stats::_phaseTimes.size() - 1));
 			Instrument::Stats::_phaseTimes.back().stop();
 			Instrument::Stats::_phaseTimes.emplace_back(true);
 			
-			Instrument::Stats::_currentPhase++;
+			// Threads detect the new phase through this counter and only then take the lock
+			Instrument::Stats::_currentPhase.fetch_add(1, std::memory_order_release);
 			
 			Instrument::Stats::_phasesSpinLock.writeUnlock();
 		}
@@ -50,20 +50,28 @@ namespace Instrument {
 	{
 	}
 	
-	inline void threadWillSuspend(__attribute__((unused)) thread_id_t threadId, __attribute__((unused)) compute_place_id_t computePlaceId)
+	inline void threadWillSuspend(__attribute__((unused)) thread_id_t threadId, compute_place_id_t computePlaceId)
 	{
 		ThreadLocalData &threadLocal = getThreadLocalData();
 		
+		threadLocal._threadInfo.beginUpdate();
 		Instrument::Stats::PhaseInfo &currentPhase = threadLocal._threadInfo.getCurrentPhaseRef();
 		currentPhase._runningTime.continueAt(currentPhase._blockedTime);
+		threadLocal._threadInfo.endUpdate();
+		
+		Stats::Live::cpuBecomesIdle(computePlaceId);
 	}
 	
-	inline void threadHasResumed(__attribute__((unused)) thread_id_t threadId, __attribute__((unused)) compute_place_id_t computePlaceId)
+	inline void threadHasResumed(__attribute__((unused)) thread_id_t threadId, compute_place_id_t computePlaceId)
 	{
 		ThreadLocalData &threadLocal = getThreadLocalData();
 		
+		Stats::Live::cpuBecomesBusy(computePlaceId);
+		
+		threadLocal._threadInfo.beginUpdate();
 		Instrument::Stats::PhaseInfo &currentPhase = threadLocal._threadInfo.getCurrentPhaseRef();
 		currentPhase._blockedTime.continueAt(currentPhase._runningTime);
+		threadLocal._threadInfo.endUpdate();
 	}
 	
 	inline void threadWillSuspend(__attribute__((unused)) external_thread_id_t threadId)
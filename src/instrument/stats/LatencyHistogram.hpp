@@ -0,0 +1,152 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+
+namespace Instrument {
+	namespace Stats {
+		//! \brief Log-linear histogram of durations in nanoseconds
+		//!
+		//! Values below 2^sub_bucket_bits are counted exactly. Above that, each
+		//! power of two is split into 2^sub_bucket_bits buckets, so the value
+		//! reported for a percentile is within 1/2^sub_bucket_bits of the real
+		//! one. Histograms are merged by adding their buckets, which allows each
+		//! thread to record into its own instance without synchronization.
+		class LatencyHistogram {
+		public:
+			enum histogram_constants_t {
+				sub_bucket_bits = 4,
+				sub_buckets = 1 << sub_bucket_bits,
+				//! Values of 2^max_exponent ns (about 78 hours) or more share the last bucket
+				max_exponent = 48,
+				bucket_count = sub_buckets * (max_exponent - sub_bucket_bits + 1)
+			};
+		
+		private:
+			uint64_t _counts[bucket_count];
+			uint64_t _totalCount;
+			uint64_t _max;
+			
+			static inline unsigned int getBucketIndex(uint64_t value)
+			{
+				if (value < sub_buckets) {
+					return value;
+				}
+				
+				unsigned int exponent = 63 - __builtin_clzll(value);
+				if (exponent >= max_exponent) {
+					return bucket_count - 1;
+				}
+				
+				unsigned int subBucket = (value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+				return (exponent - sub_bucket_bits + 1) * sub_buckets + subBucket;
+			}
+			
+			//! \brief Highest value that falls in a given bucket
+			static inline uint64_t getBucketUpperBound(unsigned int index)
+			{
+				if (index < sub_buckets) {
+					return index;
+				} else if (index == bucket_count - 1) {
+					return UINT64_MAX;
+				}
+				
+				unsigned int exponent = index / sub_buckets + sub_bucket_bits - 1;
+				uint64_t subBucket = index % sub_buckets;
+				uint64_t lowerBound = (sub_buckets + subBucket) << (exponent - sub_bucket_bits);
+				
+				return lowerBound + (((uint64_t) 1) << (exponent - sub_bucket_bits)) - 1;
+			}
+		
+		public:
+			LatencyHistogram()
+				: _totalCount(0), _max(0)
+			{
+				memset(_counts, 0, sizeof(_counts));
+			}
+			
+			inline void record(uint64_t value)
+			{
+				_counts[getBucketIndex(value)]++;
+				_totalCount++;
+				if (value > _max) {
+					_max = value;
+				}
+			}
+			
+			LatencyHistogram &operator+=(LatencyHistogram const &other)
+			{
+				if (other._totalCount == 0) {
+					return *this;
+				}
+				
+				for (unsigned int index = 0; index < bucket_count; index++) {
+					_counts[index] += other._counts[index];
+				}
+				_totalCount += other._totalCount;
+				if (other._max > _max) {
+					_max = other._max;
+				}
+				
+				return *this;
+			}
+			
+			uint64_t getTotalCount() const
+			{
+				return _totalCount;
+			}
+			
+			uint64_t getMax() const
+			{
+				return _max;
+			}
+			
+			//! \brief Get the smallest value that is greater or equal to the given percentage of the recorded values
+			//!
+			//! \param[in] percentile the percentage in the range (0, 100]
+			//!
+			//! \returns the upper bound of the bucket that contains the value, but never more than the maximum
+			uint64_t getValueAtPercentile(double percentile) const
+			{
+				assert(percentile > 0.0);
+				assert(percentile <= 100.0);
+				
+				if (_totalCount == 0) {
+					return 0;
+				}
+				
+				// Round to the nearest count, so that floating point errors do not skip to the next bucket
+				uint64_t target = (uint64_t) ((percentile / 100.0) * (double) _totalCount + 0.5);
+				if (target == 0) {
+					target = 1;
+				} else if (target > _totalCount) {
+					target = _totalCount;
+				}
+				
+				uint64_t accumulated = 0;
+				for (unsigned int index = 0; index < bucket_count; index++) {
+					accumulated += _counts[index];
+					if (accumulated >= target) {
+						uint64_t upperBound = getBucketUpperBound(index);
+						return (upperBound < _max ? upperBound : _max);
+					}
+				}
+				
+				return _max;
+			}
+		};
+	}
+}
+
+
+#endif // LATENCY_HISTOGRAM_HPP
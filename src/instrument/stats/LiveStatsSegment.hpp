@@ -0,0 +1,127 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef LIVE_STATS_SEGMENT_HPP
+#define LIVE_STATS_SEGMENT_HPP
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include <sys/types.h>
+
+
+//! \file Layout of the shared memory segment through which the stats
+//! instrumentation publishes its counters while the program runs.
+//!
+//! The segment is named after the process identifier and consists of a header,
+//! followed by one CPUEntry per CPU and a fixed number of TaskTypeEntry slots.
+//! The writer brackets each update with increments of the sequence number, so
+//! readers must retry their copy if it was odd or changed in the meantime.
+//!
+//! This header is shared with the nanos6-stats-monitor command and must not
+//! depend on any other part of the runtime.
+
+
+namespace Instrument {
+	namespace Stats {
+		namespace Live {
+			enum segment_constants_t : uint32_t {
+				segment_magic = 0x4E364C53, // "N6LS"
+				segment_version = 1,
+				max_task_types = 256,
+				max_task_type_counters = 8,
+				task_type_label_length = 64,
+				counter_name_length = 32
+			};
+			
+			
+			struct CPUEntry {
+				//! \brief Nanoseconds during which a worker was running on the CPU
+				uint64_t _busyTime;
+				
+				//! \brief Nanoseconds during which the CPU had no running worker
+				uint64_t _idleTime;
+			};
+			
+			
+			struct CounterEntry {
+				char _name[counter_name_length];
+				double _value;
+			};
+			
+			
+			struct TaskTypeEntry {
+				char _label[task_type_label_length];
+				uint64_t _instances;
+				uint64_t _pendingTime;
+				uint64_t _readyTime;
+				uint64_t _executionTime;
+				uint64_t _blockedTime;
+				uint32_t _counterCount;
+				CounterEntry _counters[max_task_type_counters];
+			};
+			
+			
+			struct SegmentHeader {
+				uint32_t _magic;
+				uint32_t _version;
+				
+				//! \brief Odd while the writer is updating the contents
+				std::atomic<uint64_t> _sequence;
+				
+				pid_t _pid;
+				uint32_t _cpuCount;
+				
+				//! \brief Configured update interval in nanoseconds
+				uint64_t _interval;
+				
+				//! \brief Nanoseconds since the runtime started at the time of the last update
+				uint64_t _timestamp;
+				
+				//! \brief Number of updates published so far
+				uint64_t _updates;
+				
+				//! \brief Tasks that are ready but have not started their execution
+				int64_t _readyTasks;
+				
+				uint32_t _threadCount;
+				uint32_t _taskTypeCount;
+			};
+			
+			
+			inline size_t getSegmentSize(uint32_t cpuCount)
+			{
+				return sizeof(SegmentHeader)
+					+ sizeof(CPUEntry) * cpuCount
+					+ sizeof(TaskTypeEntry) * max_task_types;
+			}
+			
+			inline CPUEntry *getCPUEntries(SegmentHeader *header)
+			{
+				return (CPUEntry *) (header + 1);
+			}
+			
+			inline TaskTypeEntry *getTaskTypeEntries(SegmentHeader *header)
+			{
+				return (TaskTypeEntry *) (getCPUEntries(header) + header->_cpuCount);
+			}
+			
+			inline std::string getSegmentName(pid_t pid)
+			{
+				std::ostringstream oss;
+				oss << "/nanos6-stats-" << pid;
+				return oss.str();
+			}
+		}
+	}
+}
+
+
+#endif // LIVE_STATS_SEGMENT_HPP
@@ -4,6 +4,12 @@
 	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
 */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <dlfcn.h>
+#include <link.h>
+
 #include "Addr2LineCodeAddressInfo.hpp"
 #include "../DL/DLCodeAddressInfo.hpp"
 
@@ -19,6 +25,24 @@
 std::map<void *, Addr2LineCodeAddressInfo::MemoryMapSegment> Addr2LineCodeAddressInfo::_executableMemoryMap;
 
 
+inline Addr2LineCodeAddressInfo::Entry const *Addr2LineCodeAddressInfo::findCachedEntry(void *address, bool callSiteFromReturnAddress)
+{
+	if (callSiteFromReturnAddress) {
+		auto it = _returnAddress2Entry.find(address);
+		if (it != _returnAddress2Entry.end()) {
+			return &it->second;
+		}
+	} else {
+		auto it = _address2Entry.find(address);
+		if (it != _address2Entry.end()) {
+			return &it->second;
+		}
+	}
+	
+	return nullptr;
+}
+
+
 void Addr2LineCodeAddressInfo::init()
 {
 	// Already initialized
@@ -119,18 +143,16 @@ void Addr2LineCodeAddressInfo::shutdown()
 
 Addr2LineCodeAddressInfo::Entry const &Addr2LineCodeAddressInfo::resolveAddress(void *address, bool callSiteFromReturnAddress)
 {
-	if (callSiteFromReturnAddress) {
-		auto it = _returnAddress2Entry.find(address);
-		if (it != _returnAddress2Entry.end()) {
-			return it->second;
-		}
-	} else {
-		auto it = _address2Entry.find(address);
-		if (it != _address2Entry.end()) {
-			return it->second;
+	{
+		std::lock_guard<std::mutex> guard(_lock);
+		
+		Entry const *cachedEntry = findCachedEntry(address, callSiteFromReturnAddress);
+		if (cachedEntry != nullptr) {
+			return *cachedEntry;
 		}
 	}
 	
+	// The memory map is not modified after the initialization
 	auto it = _executableMemoryMap.upper_bound(address);
 	if (it == _executableMemoryMap.begin()) {
 		// The address cannot be resolved
@@ -155,7 +177,15 @@ Addr2LineCodeAddressInfo::Entry const &Addr2LineCodeAddressInfo::resolveAddress(
 		entry._realAddress = (void *) ((size_t) address - 1);
 	}
 	
-	size_t relativeAddress = (size_t)entry._realAddress - (size_t)it->first;
+	// addr2line expects the address within the object, so remove its load bias
+	size_t relativeAddress = (size_t)entry._realAddress - (size_t)it->first + memoryMapSegment._offset;
+	{
+		Dl_info dlInfo;
+		struct link_map *linkMap = nullptr;
+		if ((dladdr1(entry._realAddress, &dlInfo, (void **) &linkMap, RTLD_DL_LINKMAP) != 0) && (linkMap != nullptr)) {
+			relativeAddress = (size_t)entry._realAddress - (size_t)linkMap->l_addr;
+		}
+	}
 	
 	std::ostringstream addr2lineCommandLine;
 	addr2lineCommandLine << "addr2line -i -f -e " << memoryMapSegment._filename << " " << std::hex << relativeAddress;
@@ -172,6 +202,15 @@ Addr2LineCodeAddressInfo::Entry const &Addr2LineCodeAddressInfo::resolveAddress(
 	std::string cpp_buffer(buffer, length);
 	pclose(addr2lineOutput);
 	
+	// Running addr2line is the slow part, so several threads can do it at the same time
+	std::lock_guard<std::mutex> guard(_lock);
+	
+	// Another thread may have resolved the same address meanwhile
+	Entry const *cachedEntry = findCachedEntry(address, callSiteFromReturnAddress);
+	if (cachedEntry != nullptr) {
+		return *cachedEntry;
+	}
+	
 	std::istringstream output(cpp_buffer);
 	std::string mangledFunction;
 	std::string sourceLine;
@@ -29,6 +29,9 @@ private:
 	
 	static std::map<void *, MemoryMapSegment> _executableMemoryMap;
 	
+	//! \brief Look up an address in the cache, which requires holding the lock
+	static inline Entry const *findCachedEntry(void *address, bool callSiteFromReturnAddress);
+	
 public:
 	static void init();
 	static void shutdown();
@@ -12,6 +12,8 @@
 #include <sstream>
 
 
+std::mutex CodeAddressInfoBase::_lock;
+
 CodeAddressInfoBase::Entry CodeAddressInfoBase::_nullEntry;
 std::string CodeAddressInfoBase::_unknownFunctionName = "??";
 std::string CodeAddressInfoBase::_unknownSourceLocation = "??:??";
@@ -11,6 +11,7 @@
 #include <support/Objectified.hpp>
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -146,6 +147,11 @@ public:
 	
 	
 protected:
+	//! \brief Protects the caches and the name tables, so that several threads can resolve addresses at the same time
+	//!
+	//! The name lookups are not protected, and thus cannot be performed while other threads resolve addresses
+	static std::mutex _lock;
+	
 	static Entry _nullEntry;
 	static std::string _unknownFunctionName;
 	static std::string _unknownSourceLocation;
@@ -31,6 +31,8 @@ void DLCodeAddressInfo::shutdown()
 
 CodeAddressInfoBase::Entry const &DLCodeAddressInfo::resolveAddress(void *address, bool callSiteFromReturnAddress)
 {
+	std::lock_guard<std::mutex> guard(_lock);
+	
 	// Check in the cache
 	if (callSiteFromReturnAddress) {
 		auto it = _returnAddress2Entry.find(address);
@@ -102,6 +102,9 @@ void ElfUtilsCodeAddressInfo::shutdown()
 
 ElfUtilsCodeAddressInfo::Entry const &ElfUtilsCodeAddressInfo::resolveAddress(void *address, bool callSiteFromReturnAddress)
 {
+	// The DWARF information is not accessed concurrently
+	std::unique_lock<std::mutex> guard(_lock);
+	
 	if (callSiteFromReturnAddress) {
 		auto it = _returnAddress2Entry.find(address);
 		if (it != _returnAddress2Entry.end()) {
@@ -116,6 +119,7 @@ ElfUtilsCodeAddressInfo::Entry const &ElfUtilsCodeAddressInfo::resolveAddress(vo
 	
 	if (_dwfl == nullptr) {
 		// Fall back to resolving through DL
+		guard.unlock();
 		return DLCodeAddressInfo::resolveAddress(address, callSiteFromReturnAddress);
 	}
 	
@@ -127,6 +131,7 @@ ElfUtilsCodeAddressInfo::Entry const &ElfUtilsCodeAddressInfo::resolveAddress(vo
 	Dwfl_Module *module = dwfl_addrmodule(_dwfl, dwflAddress);
 	if (module == nullptr) {
 		// Fall back to resolving through DL
+		guard.unlock();
 		return DLCodeAddressInfo::resolveAddress(address, callSiteFromReturnAddress);
 	}
 	
@@ -134,6 +139,7 @@ ElfUtilsCodeAddressInfo::Entry const &ElfUtilsCodeAddressInfo::resolveAddress(vo
 	Dwarf_Die *compilationUnitDebugInformationEntry = dwfl_module_addrdie(module, dwflAddress, &addressBias);
 	if (compilationUnitDebugInformationEntry == nullptr) {
 		// The module does not have debugging information
+		guard.unlock();
 		return DLCodeAddressInfo::resolveAddress(address, callSiteFromReturnAddress);
 	}
 	
@@ -168,6 +174,7 @@ ElfUtilsCodeAddressInfo::Entry const &ElfUtilsCodeAddressInfo::resolveAddress(vo
 	
 	if (mangledFunction.empty()) {
 		// Fall back to resolving through DL
+		guard.unlock();
 		return DLCodeAddressInfo::resolveAddress(address, callSiteFromReturnAddress);
 	}
 	
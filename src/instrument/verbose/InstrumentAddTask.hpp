@@ -11,4 +11,11 @@
 #include "../api/InstrumentAddTask.hpp"
 
 
+namespace Instrument {
+	inline void registeredNewTaskType(__attribute__((unused)) nanos6_task_info_t *taskInfo)
+	{
+	}
+}
+
+
 #endif // INSTRUMENT_VERBOSE_ADD_TASK_HPP
@@ -0,0 +1,161 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef COHORT_LOCK_HPP
+#define COHORT_LOCK_HPP
+
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "LockProfiling.hpp"
+#include "MCSLock.hpp"
+
+
+//! \brief NUMA-aware lock that passes the ownership within a NUMA node first
+//!
+//! The threads of each NUMA node queue on a local MCS lock, and the owner of
+//! a local lock competes for a global ticket lock. When the owner releases
+//! the lock and other threads of its NUMA node are waiting, it hands them the
+//! global lock directly, so the protected data stays in the caches of the
+//! node. The number of consecutive local handoffs is bounded to keep the
+//! other NUMA nodes from starving.
+template <int MAX_NUMA_NODES = 8, int MAX_LOCAL_HANDOFFS = 64>
+class CohortLock {
+private:
+	struct alignas(64) LocalLock {
+		MCSLock _lock;
+		
+		//! \brief Whether the global lock was handed over by the previous owner, protected by _lock
+		bool _ownsGlobalLock;
+		int _handoffs;
+		
+		LocalLock()
+			: _lock(), _ownsGlobalLock(false), _handoffs(0)
+		{
+		}
+	};
+	
+	// The global lock can be released by a thread that did not acquire it
+	alignas(64) std::atomic<uint32_t> _currentTicket;
+	std::atomic<uint32_t> _nextFreeTicket;
+	
+	LocalLock _localLocks[MAX_NUMA_NODES];
+	
+	//! \brief The local lock of the holder, only accessed while holding the lock
+	LocalLock *_holderLocalLock;
+	
+	CohortLock(CohortLock const &) = delete;
+	CohortLock &operator=(CohortLock const &) = delete;
+	
+	//! \brief Get the NUMA node of the current thread
+	//!
+	//! The worker threads are bound to CPUs, so it is only queried once per thread
+	static inline size_t getCurrentNUMANode()
+	{
+		static thread_local int currentNUMANode = -1;
+		
+		if (currentNUMANode == -1) {
+			unsigned int cpu = 0;
+			unsigned int NUMANode = 0;
+			if (syscall(SYS_getcpu, &cpu, &NUMANode, nullptr) != 0) {
+				NUMANode = 0;
+			}
+			currentNUMANode = NUMANode;
+		}
+		
+		return currentNUMANode;
+	}
+	
+	inline void lockGlobal(LockProfiling::Acquisition &acquisition)
+	{
+		uint32_t ticket = _nextFreeTicket.fetch_add(1, std::memory_order_relaxed);
+		if (_currentTicket.load(std::memory_order_acquire) != ticket) {
+			acquisition.contended();
+			MCSLock::spinUntil([&]() { return (_currentTicket.load(std::memory_order_acquire) == ticket); });
+		}
+	}
+	
+	inline void unlockGlobal()
+	{
+		_currentTicket.fetch_add(1, std::memory_order_release);
+	}
+
+public:
+	CohortLock()
+		: _currentTicket(0), _nextFreeTicket(0), _holderLocalLock(nullptr)
+	{
+	}
+	
+	~CohortLock()
+	{
+		// Not locked
+		assert(_currentTicket.load() == _nextFreeTicket.load());
+	}
+	
+	inline void lock()
+	{
+		LockProfiling::Acquisition acquisition;
+		
+		LocalLock &localLock = _localLocks[getCurrentNUMANode() % MAX_NUMA_NODES];
+		localLock._lock.lock(acquisition);
+		
+		if (!localLock._ownsGlobalLock) {
+			lockGlobal(acquisition);
+			localLock._ownsGlobalLock = true;
+		}
+		
+		_holderLocalLock = &localLock;
+		acquisition.acquired();
+	}
+	
+	inline bool tryLock()
+	{
+		LocalLock &localLock = _localLocks[getCurrentNUMANode() % MAX_NUMA_NODES];
+		if (!localLock._lock.tryLock()) {
+			return false;
+		}
+		
+		if (!localLock._ownsGlobalLock) {
+			uint32_t ticket = _currentTicket.load(std::memory_order_relaxed);
+			if (!_nextFreeTicket.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire)) {
+				localLock._lock.unlock();
+				return false;
+			}
+			localLock._ownsGlobalLock = true;
+		}
+		
+		_holderLocalLock = &localLock;
+		return true;
+	}
+	
+	inline void unlock()
+	{
+		LocalLock *localLock = _holderLocalLock;
+		assert(localLock != nullptr);
+		assert(localLock->_ownsGlobalLock);
+		_holderLocalLock = nullptr;
+		
+		if (localLock->_lock.hasWaiters() && (localLock->_handoffs < MAX_LOCAL_HANDOFFS)) {
+			// Keep the global lock within the NUMA node
+			localLock->_handoffs++;
+		} else {
+			localLock->_handoffs = 0;
+			localLock->_ownsGlobalLock = false;
+			unlockGlobal();
+		}
+		
+		localLock->_lock.unlock();
+	}
+};
+
+
+#endif // COHORT_LOCK_HPP
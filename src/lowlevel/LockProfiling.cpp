@@ -0,0 +1,142 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "LockProfiling.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <unistd.h>
+
+
+struct CallSiteStatistics {
+	std::atomic<void *> _callSite;
+	std::atomic<uint64_t> _acquisitions;
+	std::atomic<uint64_t> _contendedAcquisitions;
+	std::atomic<uint64_t> _waitTime;
+};
+
+enum call_site_table_constants_t {
+	max_call_sites = 4096,
+	max_probes = 32
+};
+
+// The locks can be used during the static initialization, so these are zero-initialized
+static CallSiteStatistics _callSites[max_call_sites];
+static CallSiteStatistics _otherCallSites;
+
+
+void *LockProfiling::getCallSite()
+{
+	return __builtin_return_address(0);
+}
+
+
+void LockProfiling::record(void *callSite, bool contended, uint64_t waitTime)
+{
+	CallSiteStatistics *statistics = &_otherCallSites;
+	
+	size_t hash = ((size_t) callSite) * 0x9E3779B97F4A7C15UL;
+	hash ^= (hash >> 32);
+	for (size_t probe = 0; probe < max_probes; probe++) {
+		CallSiteStatistics &entry = _callSites[(hash + probe) % max_call_sites];
+		
+		void *current = entry._callSite.load(std::memory_order_relaxed);
+		if (current == nullptr) {
+			entry._callSite.compare_exchange_strong(current, callSite);
+			if (current == nullptr) {
+				// Claimed by this thread
+				current = callSite;
+			}
+		}
+		
+		if (current == callSite) {
+			statistics = &entry;
+			break;
+		}
+	}
+	
+	statistics->_acquisitions.fetch_add(1, std::memory_order_relaxed);
+	if (contended) {
+		statistics->_contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+		statistics->_waitTime.fetch_add(waitTime, std::memory_order_relaxed);
+	}
+}
+
+
+static std::string getCallSiteName(void *callSite)
+{
+	if (callSite == nullptr) {
+		return "other call sites";
+	}
+	
+	std::ostringstream oss;
+	
+	Dl_info dlInfo;
+	if (dladdr(callSite, &dlInfo) == 0) {
+		oss << callSite;
+	} else if (dlInfo.dli_sname != nullptr) {
+		int status = 0;
+		char *demangledName = abi::__cxa_demangle(dlInfo.dli_sname, nullptr, nullptr, &status);
+		oss << ((status == 0) ? demangledName : dlInfo.dli_sname) << "+" << (void *) ((size_t) callSite - (size_t) dlInfo.dli_saddr);
+		free(demangledName);
+	} else {
+		// The offset can be translated with addr2line
+		char const *objectName = strrchr(dlInfo.dli_fname, '/');
+		oss << ((objectName != nullptr) ? objectName + 1 : dlInfo.dli_fname) << "+" << (void *) ((size_t) callSite - (size_t) dlInfo.dli_fbase);
+	}
+	
+	return oss.str();
+}
+
+
+void LockProfiling::report()
+{
+	std::vector<CallSiteStatistics *> statistics;
+	for (CallSiteStatistics &entry : _callSites) {
+		if (entry._callSite.load() != nullptr) {
+			statistics.push_back(&entry);
+		}
+	}
+	if (_otherCallSites._acquisitions.load() > 0) {
+		statistics.push_back(&_otherCallSites);
+	}
+	
+	std::sort(
+		statistics.begin(), statistics.end(),
+		[](CallSiteStatistics const *a, CallSiteStatistics const *b) {
+			if (a->_waitTime.load() != b->_waitTime.load()) {
+				return (a->_waitTime.load() > b->_waitTime.load());
+			}
+			return (a->_contendedAcquisitions.load() > b->_contendedAcquisitions.load());
+		}
+	);
+	
+	std::ostringstream oss;
+	oss << "lock-profile-" << getpid() << ".txt";
+	
+	std::ofstream output(oss.str().c_str());
+	output << "# Wait time (ns)\tAcquisitions\tContended acquisitions\tCall site\n";
+	for (CallSiteStatistics const *entry : statistics) {
+		output << entry->_waitTime.load()
+			<< "\t" << entry->_acquisitions.load()
+			<< "\t" << entry->_contendedAcquisitions.load()
+			<< "\t" << getCallSiteName(entry->_callSite.load())
+			<< "\n";
+	}
+	output.close();
+}
@@ -0,0 +1,93 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef LOCK_PROFILING_HPP
+#define LOCK_PROFILING_HPP
+
+
+#include <cstdint>
+
+#ifdef ENABLE_LOCK_PROFILING
+#include <time.h>
+#endif
+
+
+//! \brief Contention statistics of the runtime locks per call site
+//!
+//! When the runtime is configured with --enable-lock-profiling, the locks
+//! count their acquisitions, the ones that had to wait and the time spent
+//! waiting, grouped by the code address that acquires them. Otherwise the
+//! hooks are empty and the locks are not affected.
+class LockProfiling {
+public:
+#ifdef ENABLE_LOCK_PROFILING
+	//! \brief Get the address of the code where the caller has been inlined
+	static void *getCallSite() __attribute__((noinline));
+	
+	static void record(void *callSite, bool contended, uint64_t waitTime);
+	
+	//! \brief Write the statistics collected so far
+	static void report();
+	
+	static inline uint64_t getTime()
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return ((uint64_t) now.tv_sec) * 1000000000UL + now.tv_nsec;
+	}
+	
+	
+	//! \brief The acquisition of a lock by a thread
+	class Acquisition {
+	private:
+		uint64_t _waitStart;
+		bool _contended;
+	
+	public:
+		inline Acquisition()
+			: _waitStart(0), _contended(false)
+		{
+		}
+		
+		//! \brief Note that the lock is busy, which can be called repeatedly while waiting
+		inline void contended()
+		{
+			if (!_contended) {
+				_contended = true;
+				_waitStart = getTime();
+			}
+		}
+		
+		__attribute__((always_inline)) inline void acquired()
+		{
+			uint64_t waitTime = 0;
+			if (_contended) {
+				waitTime = getTime() - _waitStart;
+			}
+			
+			record(getCallSite(), _contended, waitTime);
+		}
+	};
+#else
+	class Acquisition {
+	public:
+		inline void contended()
+		{
+		}
+		
+		inline void acquired()
+		{
+		}
+	};
+	
+	static inline void report()
+	{
+	}
+#endif
+};
+
+
+#endif // LOCK_PROFILING_HPP
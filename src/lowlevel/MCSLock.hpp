@@ -0,0 +1,184 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef MCS_LOCK_HPP
+#define MCS_LOCK_HPP
+
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#include <sched.h>
+
+#include "LockProfiling.hpp"
+
+
+#ifndef QUEUE_LOCK_SPINS_BEFORE_YIELD
+#define QUEUE_LOCK_SPINS_BEFORE_YIELD 1000
+#endif
+
+
+template <int MAX_NUMA_NODES, int MAX_LOCAL_HANDOFFS>
+class CohortLock;
+
+
+//! \brief Queue lock in which each waiter spins on its own cache line
+//!
+//! The waiters form a queue and the lock is handed to them in FIFO order.
+//! Unlike the ticket and test-and-set locks, a release only invalidates the
+//! cache line of the next waiter. The queue nodes come from a per-thread
+//! pool, so it can replace the other locks without changing their callers.
+class MCSLock {
+private:
+	struct alignas(64) Node {
+		std::atomic<Node *> _next;
+		std::atomic<bool> _waiting;
+		
+		//! \brief Link in the pool of free nodes of a thread
+		Node *_nextFree;
+	};
+	
+	std::atomic<Node *> _tail;
+	
+	//! \brief The node of the holder, only accessed while holding the lock
+	Node *_holder;
+	
+	MCSLock(MCSLock const &) = delete;
+	MCSLock &operator=(MCSLock const &) = delete;
+	
+	static inline Node *&getFreeNodes()
+	{
+		static thread_local Node *freeNodes = nullptr;
+		return freeNodes;
+	}
+	
+	static inline Node *allocateNode()
+	{
+		Node *&freeNodes = getFreeNodes();
+		Node *node = freeNodes;
+		if (node != nullptr) {
+			freeNodes = node->_nextFree;
+		} else {
+			// The nodes are never freed, since they may end up in the pool of another thread
+			void *memory = nullptr;
+			if (posix_memalign(&memory, alignof(Node), sizeof(Node)) != 0) {
+				throw std::bad_alloc();
+			}
+			node = new (memory) Node();
+		}
+		
+		node->_next.store(nullptr, std::memory_order_relaxed);
+		node->_waiting.store(true, std::memory_order_relaxed);
+		
+		return node;
+	}
+	
+	static inline void freeNode(Node *node)
+	{
+		Node *&freeNodes = getFreeNodes();
+		node->_nextFree = freeNodes;
+		freeNodes = node;
+	}
+	
+	//! \brief Wait for a condition, yielding the CPU now and then in case the thread that must fulfill it has been preempted
+	template <typename CONDITION_T>
+	static inline void spinUntil(CONDITION_T condition)
+	{
+		int spinsLeft = QUEUE_LOCK_SPINS_BEFORE_YIELD;
+		while (!condition()) {
+			if (--spinsLeft == 0) {
+				sched_yield();
+				spinsLeft = QUEUE_LOCK_SPINS_BEFORE_YIELD;
+			}
+		}
+	}
+	
+	inline void lock(LockProfiling::Acquisition &acquisition)
+	{
+		Node *node = allocateNode();
+		
+		Node *predecessor = _tail.exchange(node, std::memory_order_acq_rel);
+		if (predecessor != nullptr) {
+			acquisition.contended();
+			
+			predecessor->_next.store(node, std::memory_order_release);
+			spinUntil([&]() { return !node->_waiting.load(std::memory_order_acquire); });
+		}
+		
+		_holder = node;
+	}
+	
+	template <int MAX_NUMA_NODES, int MAX_LOCAL_HANDOFFS>
+	friend class CohortLock;
+
+public:
+	MCSLock()
+		: _tail(nullptr), _holder(nullptr)
+	{
+	}
+	
+	~MCSLock()
+	{
+		// Not locked
+		assert(_tail.load() == nullptr);
+	}
+	
+	inline void lock()
+	{
+		LockProfiling::Acquisition acquisition;
+		lock(acquisition);
+		acquisition.acquired();
+	}
+	
+	inline bool tryLock()
+	{
+		Node *node = allocateNode();
+		
+		Node *expected = nullptr;
+		if (!_tail.compare_exchange_strong(expected, node, std::memory_order_acq_rel)) {
+			freeNode(node);
+			return false;
+		}
+		
+		_holder = node;
+		
+		return true;
+	}
+	
+	inline void unlock()
+	{
+		Node *node = _holder;
+		assert(node != nullptr);
+		_holder = nullptr;
+		
+		Node *successor = node->_next.load(std::memory_order_acquire);
+		if (successor == nullptr) {
+			Node *expected = node;
+			if (_tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+				freeNode(node);
+				return;
+			}
+			
+			// A new waiter has enqueued itself but has not linked its node yet
+			spinUntil([&]() { return ((successor = node->_next.load(std::memory_order_acquire)) != nullptr); });
+		}
+		
+		successor->_waiting.store(false, std::memory_order_release);
+		freeNode(node);
+	}
+	
+	//! \brief Check if other threads are waiting, which must be called while holding the lock
+	inline bool hasWaiters() const
+	{
+		assert(_holder != nullptr);
+		return (_tail.load(std::memory_order_relaxed) != _holder);
+	}
+};
+
+
+#endif // MCS_LOCK_HPP
@@ -7,6 +7,7 @@
 #ifndef SPIN_LOCK_HPP
 #define SPIN_LOCK_HPP
 
+#include "LockProfiling.hpp"
 #include "SpinLockNoDebug.hpp"
 #include "SpinLockOwnerDebug.hpp"
 
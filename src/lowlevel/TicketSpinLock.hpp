@@ -12,6 +12,8 @@
 #include <cassert>
 #include <cstddef>
 
+#include "LockProfiling.hpp"
+
 
 #ifndef SPIN_LOCK_READS_BETWEEN_CMPXCHG
 #define SPIN_LOCK_READS_BETWEEN_CMPXCHG 1000
@@ -59,9 +61,13 @@ public:
 	
 	inline void lock()
 	{
+		LockProfiling::Acquisition acquisition;
+		
 		TICKET_T ticket = _nextFreeTicket++;
 		
 		while (_currentTicket.load(std::memory_order_acquire) != ticket) {
+			acquisition.contended();
+			
 			int spinsLeft = SPIN_LOCK_READS_BETWEEN_CMPXCHG;
 			TICKET_T current;
 			do {
@@ -72,6 +78,8 @@ public:
 		
 		assertUnowned();
 		setOwner();
+		
+		acquisition.acquired();
 	}
 	
 	inline bool tryLock()
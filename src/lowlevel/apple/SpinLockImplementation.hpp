@@ -30,9 +30,17 @@ inline void CustomizableSpinLock<DEBUG_KIND>::lock()
 {
 	DEBUG_KIND::assertNotCurrentOwner();
 	DEBUG_KIND::willLock();
-	OSSpinLockLock(&_lock);
+	
+	LockProfiling::Acquisition acquisition;
+	if (!OSSpinLockTry(&_lock)) {
+		acquisition.contended();
+		OSSpinLockLock(&_lock);
+	}
+	
 	DEBUG_KIND::assertUnowned();
 	DEBUG_KIND::setOwner();
+	
+	acquisition.acquired();
 }
 
 template <class DEBUG_KIND>
@@ -37,8 +37,12 @@ inline void CustomizableSpinLock<DEBUG_KIND>::lock()
 	DEBUG_KIND::assertNotCurrentOwner();
 	DEBUG_KIND::willLock();
 	
+	LockProfiling::Acquisition acquisition;
+	
 	bool expected = false;
 	while (!_lock.compare_exchange_weak(expected, true, std::memory_order_acquire)) {
+		acquisition.contended();
+		
 		int spinsLeft = SPIN_LOCK_READS_BETWEEN_CMPXCHG;
 		do {
 			expected = _lock.load(std::memory_order_relaxed);
@@ -50,6 +54,8 @@ inline void CustomizableSpinLock<DEBUG_KIND>::lock()
 	
 	DEBUG_KIND::assertUnowned();
 	DEBUG_KIND::setOwner();
+	
+	acquisition.acquired();
 }
 
 template <class DEBUG_KIND>
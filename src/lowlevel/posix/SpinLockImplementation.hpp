@@ -31,9 +31,17 @@ inline void CustomizableSpinLock<DEBUG_KIND>::lock()
 {
 	DEBUG_KIND::assertNotCurrentOwner();
 	DEBUG_KIND::willLock();
-	pthread_spin_lock(&_lock);
+	
+	LockProfiling::Acquisition acquisition;
+	if (pthread_spin_trylock(&_lock) != 0) {
+		acquisition.contended();
+		pthread_spin_lock(&_lock);
+	}
+	
 	DEBUG_KIND::assertUnowned();
 	DEBUG_KIND::setOwner();
+	
+	acquisition.acquired();
 }
 
 template <class DEBUG_KIND>
@@ -8,9 +8,11 @@
 #define __CPU_OBJECT_CACHE_HPP__
 
 #include "lowlevel/SpinLock.hpp"
-#include <deque>
+#include <algorithm>
+#include <vector>
 
 #include <NUMAObjectCache.hpp>
+#include <ObjectFreeList.hpp>
 #include <VirtualMemoryManagement.hpp>
 #include <MemoryAllocator.hpp>
 
@@ -20,9 +22,16 @@ class CPUObjectCache {
 	size_t _NUMANodeId;
 	size_t _numaNodeCount;
 	
+	//! Maximum number of objects that a pool keeps before returning some to the NUMA layer
+	size_t _highWaterMark;
+	
+	//! Maximum number of objects that move between the layers at once
+	size_t _batchSize;
+	
+	//! Number of objects of the next refill, which grows up to _batchSize
 	size_t _allocationSize = 1;
 	
-	typedef std::deque<T *> pool_t;
+	typedef ObjectFreeList<T> pool_t;
 	
 	/** Pools of available objects in the cache.
 	 *
@@ -30,17 +39,19 @@ class CPUObjectCache {
 	 * allocations, e.g. for ExternalThreads. When allocating an object
 	 * the local pool will be used. When deleting an object it will be
 	 * placed in the pool of the NUMA node in which the underlying memory
-	 * belongs to. When the pool of a NUMA node other than ours reaches a
-	 * certain limit, the objects of that pool will be returned to the
-	 * cache of that NUMA node.
+	 * belongs to. When the pool of a NUMA node other than ours reaches
+	 * the batch size, the objects of that pool will be returned to the
+	 * cache of that NUMA node. When our own pool goes above the high-water
+	 * mark, a batch of objects is returned to the cache of our NUMA node.
 	 *
 	 * These pools are not thread safe, i.e. they are meant to be accessed
 	 * only by the thread that runs on the current CPU. */
-	std::deque<pool_t> _available;
-	
+	std::vector<pool_t> _available;
+
 public:
-	CPUObjectCache(NUMAObjectCache<T> *pool, size_t numaId, size_t numaNodeCount)
-		: _NUMAObjectCache(pool), _NUMANodeId(numaId), _numaNodeCount(numaNodeCount)
+	CPUObjectCache(NUMAObjectCache<T> *pool, size_t numaId, size_t numaNodeCount, size_t highWaterMark)
+		: _NUMAObjectCache(pool), _NUMANodeId(numaId), _numaNodeCount(numaNodeCount),
+		_highWaterMark(std::max(highWaterMark, (size_t) 2)), _batchSize(_highWaterMark / 2)
 	{
 		_available.resize(numaNodeCount + 1);
 	}
@@ -56,7 +67,7 @@ public:
 		pool_t &local = _available[_NUMANodeId];
 		if (local.empty()) {
 			//! Try to recycle from NUMA pool
-			_allocationSize *= 2;
+			_allocationSize = std::min(_allocationSize * 2, _batchSize);
 			size_t allocated = _NUMAObjectCache->fillCPUPool(_NUMANodeId, local,
 					_allocationSize);
 			
@@ -65,13 +76,13 @@ public:
 				T *ptr = (T *) MemoryAllocator::alloc(
 						_allocationSize * sizeof(T));
 				for (size_t i = 0; i < _allocationSize; ++i) {
-					local.push_back(&ptr[i]);
+					local.push(&ptr[i]);
 				}
+				_NUMAObjectCache->getStatistics()._allocatedBytes += _allocationSize * sizeof(T);
 			}
 		}
 		
-		T *ret = local.front();
-		local.pop_front();
+		T *ret = local.pop();
 		new (ret) T(std::forward<TS>(args)...);
 		return ret;
 	}
@@ -83,11 +94,30 @@ public:
 		
 		ptr->~T();
 		
-		_available[nodeId].push_front(ptr);
-		if ((nodeId != _NUMANodeId) && (_available[nodeId].size() == 64)) {
-			_NUMAObjectCache->returnObjects(nodeId, _available[nodeId]);
+		pool_t &pool = _available[nodeId];
+		pool.push(ptr);
+		if (nodeId != _NUMANodeId) {
+			if (pool.size() >= _batchSize) {
+				_NUMAObjectCache->returnObjects(nodeId, pool);
+			}
+		} else if (pool.size() > _highWaterMark) {
+			//! Keep the most recently freed objects, which are more likely to be in the cache
+			pool_t spilled;
+			pool.truncate(pool.size() - _batchSize, spilled);
+			_NUMAObjectCache->returnObjects(nodeId, spilled);
 		}
 	}
+	
+	//! Get the number of free objects held by this cache
+	size_t getCachedObjects() const
+	{
+		size_t cachedObjects = 0;
+		for (pool_t const &pool : _available) {
+			cachedObjects += pool.size();
+		}
+		
+		return cachedObjects;
+	}
 };
 
 #endif /* __CPU_OBJECT_CACHE_HPP__ */
@@ -4,9 +4,15 @@
 	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
 */
 
+#include <nanos6/polling.h>
+
+#include <algorithm>
+
 #include "executors/threads/CPU.hpp"
 #include "executors/threads/WorkerThread.hpp"
 #include "hardware/HardwareInfo.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+#include "system/RuntimeInfo.hpp"
 #include <VirtualMemoryManagement.hpp>
 
 #include "MemoryPool.hpp"
@@ -18,6 +24,10 @@ std::vector<MemoryPoolGlobal *> MemoryAllocator::_globalMemoryPool;
 std::vector<MemoryAllocator::size_to_pool_t> MemoryAllocator::_localMemoryPool;
 MemoryAllocator::size_to_pool_t MemoryAllocator::_externalMemoryPool;
 SpinLock MemoryAllocator::_externalMemoryPoolLock;
+SpinLock MemoryAllocator::_localMemoryPoolCreationLock;
+uint64_t MemoryAllocator::_scavengeIdlePeriod;
+bool MemoryAllocator::_lazyScavenge;
+std::atomic<size_t> MemoryAllocator::_scavengedBytes(0);
 
 MemoryPool *MemoryAllocator::getPool(size_t size)
 {
@@ -42,6 +52,8 @@ MemoryPool *MemoryAllocator::getPool(size_t size)
 			if (it == _localMemoryPool[cpuId].end()) {
 				// No pool of this size locally
 				pool = new MemoryPool(_globalMemoryPool[numaNodeId], roundedSize);
+				
+				std::lock_guard<SpinLock> guard(_localMemoryPoolCreationLock);
 				_localMemoryPool[cpuId][cacheLines] = pool;
 			} else {
 				pool = it->second;
@@ -78,13 +90,34 @@ void MemoryAllocator::initialize()
 	_localMemoryPool.resize(cpuCount);
 	
 	//! Initialize the Object caches
-	ObjectAllocator<DataAccess>::initialize();
-	ObjectAllocator<ReductionInfo>::initialize();
-	ObjectAllocator<BottomMapEntry>::initialize();
+	EnvironmentVariable<size_t> highWaterMark("NANOS6_OBJECT_CACHE_HIGH_WATER_MARK", 1024);
+	RuntimeInfo::addEntry("object_cache_high_water_mark", "Maximum number of free objects of each type kept by a CPU", highWaterMark.getValue());
+	
+	ObjectAllocator<DataAccess>::initialize("data_access", highWaterMark.getValue());
+	ObjectAllocator<ReductionInfo>::initialize("reduction_info", highWaterMark.getValue());
+	ObjectAllocator<BottomMapEntry>::initialize("bottom_map_entry", highWaterMark.getValue());
+	
+	//! Return the memory of the pools that have been idle for a while to the OS
+	EnvironmentVariable<uint64_t> scavengeIdlePeriod("NANOS6_MEMORY_SCAVENGE_IDLE_PERIOD", 10000);
+	EnvironmentVariable<bool> lazyScavenge("NANOS6_MEMORY_SCAVENGE_LAZY", false);
+	_scavengeIdlePeriod = scavengeIdlePeriod.getValue() * 1000000UL;
+	_lazyScavenge = lazyScavenge.getValue();
+	
+	RuntimeInfo::addEntry("memory_scavenge_idle_period", "Time without obtaining memory after which a pool returns its free memory", scavengeIdlePeriod.getValue(), "ms");
+	if (_scavengeIdlePeriod != 0) {
+		RuntimeInfo::addCounterEntry("memory_scavenged", "Memory returned to the operating system", _scavengedBytes, "bytes");
+		
+		// Check the pools twice per idle period
+		nanos6_register_periodic_polling_service("memory scavenger", &MemoryAllocator::scavenge, nullptr, std::max(scavengeIdlePeriod.getValue() * 500UL, 1UL));
+	}
 }
 
 void MemoryAllocator::shutdown()
 {
+	if (_scavengeIdlePeriod != 0) {
+		nanos6_unregister_polling_service("memory scavenger", &MemoryAllocator::scavenge, nullptr);
+	}
+	
 	for (size_t i = 0; i < _globalMemoryPool.size(); ++i) {
 		delete _globalMemoryPool[i];
 	}
@@ -105,6 +138,31 @@ void MemoryAllocator::shutdown()
 	ObjectAllocator<DataAccess>::shutdown();
 }
 
+int MemoryAllocator::scavenge(__attribute__((unused)) void *)
+{
+	size_t scavengedBytes = 0;
+	
+	{
+		std::lock_guard<SpinLock> guard(_localMemoryPoolCreationLock);
+		for (size_to_pool_t &pools : _localMemoryPool) {
+			for (auto &it : pools) {
+				scavengedBytes += it.second->scavenge(_scavengeIdlePeriod, _lazyScavenge);
+			}
+		}
+	}
+	
+	{
+		std::lock_guard<SpinLock> guard(_externalMemoryPoolLock);
+		for (auto &it : _externalMemoryPool) {
+			scavengedBytes += it.second->scavenge(_scavengeIdlePeriod, _lazyScavenge);
+		}
+	}
+	
+	_scavengedBytes += scavengedBytes;
+	
+	return 0;
+}
+
 void *MemoryAllocator::alloc(size_t size)
 {
 	MemoryPool *pool = getPool(size);
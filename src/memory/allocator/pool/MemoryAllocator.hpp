@@ -7,6 +7,8 @@
 #ifndef MEMORY_ALLOCATOR_HPP
 #define MEMORY_ALLOCATOR_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -25,8 +27,19 @@ private:
 	static size_to_pool_t _externalMemoryPool;
 	static SpinLock _externalMemoryPoolLock;
 	
+	//! Protects the creation of the CPU pools against the scavenger, which traverses them
+	static SpinLock _localMemoryPoolCreationLock;
+	
+	//! Time in nanoseconds that a pool must go without obtaining memory to be scavenged, or 0 to disable it
+	static uint64_t _scavengeIdlePeriod;
+	static bool _lazyScavenge;
+	static std::atomic<size_t> _scavengedBytes;
+	
 	static MemoryPool *getPool(size_t size);
 	
+	//! Polling service that returns the free memory of the idle pools to the OS
+	static int scavenge(void *);
+	
 public:
 	static void initialize();
 	static void shutdown();
@@ -1,23 +1,47 @@
 /*
 	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
 	
-	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
+	Copyright (C) 2015-2018 Barcelona Supercomputing Center (BSC)
 */
 
 #ifndef MEMORY_POOL_HPP
 #define MEMORY_POOL_HPP
 
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <time.h>
+
 #include "MemoryPoolGlobal.hpp"
 
 #define NEXT_CHUNK(_r) *((void **)_r)
 
 class MemoryPool {
 private:
-	// There is one pool per CPU. No need to lock
+	typedef std::pair<void *, size_t> global_chunk_t;
+	
+	// There is one pool per CPU. The lock is only contended by the scavenger
+	SpinLock _lock;
 	MemoryPoolGlobal *_globalAllocator;
 	size_t _chunkSize;
 	void *_topChunk;
 	
+	//! The chunks obtained from the global pool, sorted by address
+	std::vector<global_chunk_t> _globalChunks;
+	
+	//! Time in nanoseconds at which the pool last obtained memory from the global pool
+	uint64_t _lastFillTime;
+	
+	
+	static inline uint64_t getTime()
+	{
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return ((uint64_t) now.tv_sec) * 1000000000UL + now.tv_nsec;
+	}
 	
 	void fillPool()
 	{
@@ -37,18 +61,49 @@ private:
 		}
 		
 		NEXT_CHUNK(prevChunk) = nullptr;
+		
+		global_chunk_t globalChunk(_topChunk, globalChunkSize);
+		_globalChunks.insert(std::upper_bound(_globalChunks.begin(), _globalChunks.end(), globalChunk), globalChunk);
+		_lastFillTime = getTime();
+	}
+	
+	//! Get the index of the global chunk that contains a chunk, or the number of global chunks if none does
+	size_t findGlobalChunk(void *chunk) const
+	{
+		auto it = std::upper_bound(
+			_globalChunks.begin(), _globalChunks.end(), chunk,
+			[](void *address, global_chunk_t const &globalChunk) {
+				return (address < globalChunk.first);
+			}
+		);
+		
+		if (it == _globalChunks.begin()) {
+			return _globalChunks.size();
+		}
+		
+		--it;
+		if ((char *) chunk >= (char *) it->first + it->second) {
+			return _globalChunks.size();
+		}
+		
+		return it - _globalChunks.begin();
 	}
 
 public:
 	MemoryPool(MemoryPoolGlobal *globalAllocator, size_t chunkSize)
-		: _globalAllocator(globalAllocator),
+		: _lock(),
+		_globalAllocator(globalAllocator),
 		_chunkSize(chunkSize),
-		_topChunk(nullptr)
+		_topChunk(nullptr),
+		_globalChunks(),
+		_lastFillTime(0)
 	{
 	}
 	
 	void *getChunk()
 	{
+		std::lock_guard<SpinLock> guard(_lock);
+		
 		if(_topChunk == nullptr) {
 			fillPool();
 		}
@@ -61,9 +116,75 @@ public:
 	
 	void returnChunk(void *chunk)
 	{
+		std::lock_guard<SpinLock> guard(_lock);
+		
 		NEXT_CHUNK(chunk) = _topChunk;
 		_topChunk = chunk;
 	}
+	
+	//! \brief Return the global chunks whose chunks are all free to the OS
+	//!
+	//! Chunks that have been freed into the pool of another CPU keep their
+	//! global chunk alive. Pools that have obtained memory recently are
+	//! skipped, since they are likely to need it again.
+	//!
+	//! \param[in] idlePeriod the time in nanoseconds that the pool must have gone without obtaining memory
+	//! \param[in] lazy whether the OS may postpone the release until there is memory pressure
+	//!
+	//! \returns the number of bytes that have been released
+	size_t scavenge(uint64_t idlePeriod, bool lazy)
+	{
+		std::lock_guard<SpinLock> guard(_lock);
+		
+		if (_globalChunks.empty() || (getTime() - _lastFillTime < idlePeriod)) {
+			return 0;
+		}
+		
+		std::vector<size_t> freeChunks(_globalChunks.size(), 0);
+		for (void *chunk = _topChunk; chunk != nullptr; chunk = NEXT_CHUNK(chunk)) {
+			size_t index = findGlobalChunk(chunk);
+			if (index != _globalChunks.size()) {
+				freeChunks[index]++;
+			}
+		}
+		
+		std::vector<bool> releasable(_globalChunks.size(), false);
+		bool anyReleasable = false;
+		for (size_t index = 0; index < _globalChunks.size(); index++) {
+			if (freeChunks[index] == _globalChunks[index].second / _chunkSize) {
+				releasable[index] = true;
+				anyReleasable = true;
+			}
+		}
+		
+		if (!anyReleasable) {
+			return 0;
+		}
+		
+		// Unlink the chunks of the global chunks that are released, keeping the order of the rest
+		void **link = &_topChunk;
+		while (*link != nullptr) {
+			size_t index = findGlobalChunk(*link);
+			if ((index != _globalChunks.size()) && releasable[index]) {
+				*link = NEXT_CHUNK(*link);
+			} else {
+				link = (void **) *link;
+			}
+		}
+		
+		size_t releasedBytes = 0;
+		std::vector<global_chunk_t> remainingGlobalChunks;
+		for (size_t index = 0; index < _globalChunks.size(); index++) {
+			if (releasable[index]) {
+				releasedBytes += _globalAllocator->releaseMemory(_globalChunks[index].first, _globalChunks[index].second, lazy);
+			} else {
+				remainingGlobalChunks.push_back(_globalChunks[index]);
+			}
+		}
+		_globalChunks.swap(remainingGlobalChunks);
+		
+		return releasedBytes;
+	}
 };
 
 #endif // MEMORY_POOL_HPP
@@ -6,8 +6,11 @@
 
 #ifndef MEMORY_POOL_GLOBAL_HPP
 #define MEMORY_POOL_GLOBAL_HPP
+#include <utility>
 #include <vector>
 
+#include <sys/mman.h>
+
 #if HAVE_CONFIG_H
 #include <config.h>
 #endif
@@ -20,6 +23,7 @@
 
 #include "lowlevel/SpinLock.hpp"
 #include "lowlevel/EnvironmentVariable.hpp"
+#include "memory/vmm/HugePages.hpp"
 #include <VirtualMemoryManagement.hpp>
 
 class MemoryPoolGlobal {
@@ -28,7 +32,6 @@ private:
 	EnvironmentVariable<size_t> _memoryChunkSize;
 
 	SpinLock _lock;
-	size_t _pageSize;
 	std::vector<void *> _oldMemoryChunks;
 	void *_curMemoryChunk;
 	size_t _curAvailable;
@@ -36,13 +39,19 @@ private:
 #if HAVE_MEMKIND
 	memkind_t _memoryKind;
 #endif
+	
+	//! Chunks whose pages have been returned to the OS, which are handed out before carving new ones
+	std::vector<std::pair<void *, size_t>> _releasedChunks;
 
 	void fillPool()
 	{
 		_curAvailable = _globalAllocSize;
 #if HAVE_MEMKIND
-		int rc = memkind_posix_memalign(_memoryKind, &_curMemoryChunk, _pageSize, _globalAllocSize);
+		int rc = memkind_posix_memalign(_memoryKind, &_curMemoryChunk, HugePages::getAlignment(), _globalAllocSize);
 		FatalErrorHandler::check(rc == MEMKIND_SUCCESS, " when trying to allocate a memory chunk for the global allocator");
+		
+		// The memory belongs to memkind, so its mapping cannot be replaced
+		HugePages::back(_curMemoryChunk, _globalAllocSize, false);
 #else
 		_curMemoryChunk = VirtualMemoryManagement::allocLocalNUMA(_globalAllocSize, _NUMANodeId);
 		FatalErrorHandler::failIf(
@@ -50,7 +59,9 @@ private:
 			"could not allocate a memory chunk for the global allocator"
 		);
 
+		HugePages::back(_curMemoryChunk, _globalAllocSize);
 #endif
+		// After backing it, since explicit huge pages replace the mapping and its policy
 		numa_setlocal_memory(_curMemoryChunk, _globalAllocSize);
 		_oldMemoryChunks.push_back(_curMemoryChunk);
 	}
@@ -59,7 +70,7 @@ public:
 	MemoryPoolGlobal(size_t NUMANodeId)
 		: _globalAllocSize("NANOS6_GLOBAL_ALLOC_SIZE", 8 * 1024 * 1024),
 		_memoryChunkSize("NANOS6_ALLOCATOR_CHUNK_SIZE", 128 * 1024),
-		_pageSize(sysconf(_SC_PAGESIZE)), _oldMemoryChunks(0),
+		_oldMemoryChunks(0),
 		_curMemoryChunk(nullptr), _curAvailable(0),
 		_NUMANodeId(NUMANodeId)
 	{
@@ -84,6 +95,16 @@ public:
 	void *getMemory(size_t minSize, size_t &chunkSize)
 	{
 		std::lock_guard<SpinLock> guard(_lock);
+		
+		// The pages of a released chunk are faulted in again as zeros when used
+		if (!_releasedChunks.empty() && (_releasedChunks.back().second >= minSize)) {
+			void *chunk = _releasedChunks.back().first;
+			chunkSize = _releasedChunks.back().second;
+			_releasedChunks.pop_back();
+			
+			return chunk;
+		}
+		
 		if (_curAvailable < _memoryChunkSize) {
 			if (_curAvailable != 0) {
 				// Chunk size was changed previously, update also alloc size to make all sizes fit again
@@ -112,6 +133,41 @@ public:
 		
 		return curAddr;
 	}
+	
+	//! \brief Return the pages of a chunk obtained through getMemory that is not used anymore to the OS
+	//!
+	//! The chunk is kept to be handed out again by getMemory
+	//!
+	//! \param[in] chunk the start of the chunk
+	//! \param[in] chunkSize the size of the chunk
+	//! \param[in] lazy whether the OS may postpone the release until there is memory pressure
+	//!
+	//! \returns the number of bytes that have been released
+	size_t releaseMemory(void *chunk, size_t chunkSize, __attribute__((unused)) bool lazy)
+	{
+		// Only whole pages can be released, and releasing part of a huge page would split it
+		size_t pageSize = HugePages::getAlignment();
+		size_t start = ((size_t) chunk + pageSize - 1) & ~(pageSize - 1);
+		size_t end = ((size_t) chunk + chunkSize) & ~(pageSize - 1);
+		size_t releasedBytes = 0;
+		
+		if (start < end) {
+			int advice = MADV_DONTNEED;
+#ifdef MADV_FREE
+			if (lazy) {
+				advice = MADV_FREE;
+			}
+#endif
+			if (madvise((void *) start, end - start, advice) == 0) {
+				releasedBytes = end - start;
+			}
+		}
+		
+		std::lock_guard<SpinLock> guard(_lock);
+		_releasedChunks.emplace_back(chunk, chunkSize);
+		
+		return releasedBytes;
+	}
 };
 
 #endif // MEMORY_POOL_GLOBAL_HPP
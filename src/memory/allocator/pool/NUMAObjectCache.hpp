@@ -9,14 +9,40 @@
 
 #include "lowlevel/PaddedSpinLock.hpp"
 
+#include <atomic>
 #include <deque>
 #include <mutex>
 
+#include "ObjectFreeList.hpp"
+
+
+/** Memory footprint counters of the object cache of a type.
+ *
+ * They are only updated when the objects move between the layers of the
+ * cache or come from the memory allocator, so they do not add any cost to
+ * the allocations that are served from the local free lists. */
+struct ObjectCacheStatistics {
+	//! Bytes obtained from the memory allocator, which are never released
+	std::atomic<size_t> _allocatedBytes;
+	
+	//! Bytes of free objects held by the NUMA layer
+	std::atomic<size_t> _NUMACachedBytes;
+	
+	//! Number of times that a CPU has returned objects to the NUMA layer
+	std::atomic<size_t> _spills;
+	
+	ObjectCacheStatistics()
+		: _allocatedBytes(0), _NUMACachedBytes(0), _spills(0)
+	{
+	}
+};
+
+
 template <typename T>
 class NUMAObjectCache {
 	size_t _NUMANodeCount;
 	
-	typedef std::deque<T *> pool_t;
+	typedef ObjectFreeList<T> pool_t;
 	typedef struct {
 		pool_t _pool;
 		PaddedSpinLock<64> _lock;
@@ -24,9 +50,11 @@ class NUMAObjectCache {
 	
 	std::deque<NUMApool_t> _NUMAPools;
 	
+	ObjectCacheStatistics &_statistics;
+
 public:
-	NUMAObjectCache(size_t NUMANodeCount)
-		: _NUMANodeCount(NUMANodeCount)
+	NUMAObjectCache(size_t NUMANodeCount, ObjectCacheStatistics &statistics)
+		: _NUMANodeCount(NUMANodeCount), _statistics(statistics)
 	{
 		_NUMAPools.resize(_NUMANodeCount + 1);
 	}
@@ -35,6 +63,11 @@ public:
 	{
 	}
 	
+	inline ObjectCacheStatistics &getStatistics()
+	{
+		return _statistics;
+	}
+	
 	/** This is called from a CPUNUMAObjectCache to fill up its pool of
 	 *  objects.
 	 *
@@ -42,34 +75,32 @@ public:
 	 * pool. The method returns how many objects it managed to ultimately
 	 * allocate
 	 */
-	inline int fillCPUPool(size_t numaId, std::deque<T *> &pool, size_t requestedObjects)
+	inline size_t fillCPUPool(size_t numaId, pool_t &pool, size_t requestedObjects)
 	{
 		std::lock_guard<PaddedSpinLock<64>> lock(_NUMAPools[numaId]._lock);
 		pool_t &numaPool = _NUMAPools[numaId]._pool;
 		
-		size_t poolSize = numaPool.size();
-		if (poolSize == 0) {
-			return 0;
-		}
-		
-		size_t nrObjects = std::min(requestedObjects, poolSize);
-		std::move(numaPool.begin(), numaPool.begin() + nrObjects, std::front_inserter(pool));
-		numaPool.erase(numaPool.begin(), numaPool.begin() + nrObjects);
+		size_t nrObjects = numaPool.moveTo(pool, requestedObjects);
+		_statistics._NUMACachedBytes -= nrObjects * sizeof(T);
 		
 		return nrObjects;
 	}
 	
 	/** Method to return objects to a NUMA pool from a CPUNUMAObjectCache.
 	 *
-	 * This is typically called from a CPUNUMAObjectCache in order to return
-	 * objects related with a different NUMA node than the one it belongs.
+	 * This is called from a CPUNUMAObjectCache in order to return objects
+	 * related with a different NUMA node than the one it belongs, or the
+	 * objects that exceed the size of its own pool. All the objects of
+	 * the pool are moved.
 	 */
-	void returnObjects(size_t numaId, std::deque<T *> &pool)
+	void returnObjects(size_t numaId, pool_t &pool)
 	{
+		size_t nrObjects = pool.size();
+		
 		std::lock_guard<PaddedSpinLock<64>> lock(_NUMAPools[numaId]._lock);
-		pool_t &numaPool = _NUMAPools[numaId]._pool;
-		std::move(pool.begin(), pool.end(), std::back_inserter(numaPool));
-		pool.erase(pool.begin(), pool.end());
+		_NUMAPools[numaId]._pool.splice(pool);
+		_statistics._NUMACachedBytes += nrObjects * sizeof(T);
+		_statistics._spills++;
 	}
 };
 
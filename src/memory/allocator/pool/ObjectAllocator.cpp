@@ -9,3 +9,6 @@
 template<> ObjectAllocator<DataAccess>::inner_type *ObjectAllocator<DataAccess>::_cache = nullptr;
 template<> ObjectAllocator<ReductionInfo>::inner_type *ObjectAllocator<ReductionInfo>::_cache = nullptr;
 template<> ObjectAllocator<BottomMapEntry>::inner_type *ObjectAllocator<BottomMapEntry>::_cache = nullptr;
+template<> ObjectCacheStatistics ObjectAllocator<DataAccess>::_statistics = {};
+template<> ObjectCacheStatistics ObjectAllocator<ReductionInfo>::_statistics = {};
+template<> ObjectCacheStatistics ObjectAllocator<BottomMapEntry>::_statistics = {};
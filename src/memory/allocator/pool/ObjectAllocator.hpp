@@ -12,6 +12,10 @@
 #include <BottomMapEntry.hpp>
 #include <ObjectCache.hpp>
 
+#include "system/RuntimeInfo.hpp"
+
+#include <string>
+
 template <typename T>
 class ObjectAllocator {
 public:
@@ -19,11 +23,18 @@ public:
 	
 private:
 	static inner_type *_cache;
+	static ObjectCacheStatistics _statistics;
 	
 public:
-	static void initialize()
+	//! \param[in] name the name of the type in the runtime information
+	//! \param[in] highWaterMark the maximum number of free objects that each CPU keeps
+	static void initialize(std::string const &name, size_t highWaterMark)
 	{
-		_cache = new ObjectCache<T>();
+		_cache = new ObjectCache<T>(highWaterMark, _statistics);
+		
+		RuntimeInfo::addCounterEntry(name + "_allocated_memory", "Memory allocated for " + name + " objects", _statistics._allocatedBytes, "bytes");
+		RuntimeInfo::addCounterEntry(name + "_numa_cached_memory", "Memory of the free " + name + " objects held by the NUMA caches", _statistics._NUMACachedBytes, "bytes");
+		RuntimeInfo::addCounterEntry(name + "_cache_spills", "Number of times that a CPU returned " + name + " objects to a NUMA cache", _statistics._spills);
 	}
 	
 	static void shutdown()
@@ -47,5 +58,8 @@ public:
 template<> ObjectAllocator<DataAccess>::inner_type *ObjectAllocator<DataAccess>::_cache;
 template<> ObjectAllocator<ReductionInfo>::inner_type *ObjectAllocator<ReductionInfo>::_cache;
 template<> ObjectAllocator<BottomMapEntry>::inner_type *ObjectAllocator<BottomMapEntry>::_cache;
+template<> ObjectCacheStatistics ObjectAllocator<DataAccess>::_statistics;
+template<> ObjectCacheStatistics ObjectAllocator<ReductionInfo>::_statistics;
+template<> ObjectCacheStatistics ObjectAllocator<BottomMapEntry>::_statistics;
 
 #endif /* __OBJECT_ALLOCATOR_HPP__ */
@@ -28,27 +28,31 @@ class ObjectCache {
 	SpinLock _externalLock;
 	
 public:
-	ObjectCache()
+	//! \param[in] highWaterMark the maximum number of free objects that each CPU keeps
+	//! \param[in] statistics the counters of the memory footprint of the type
+	ObjectCache(size_t highWaterMark, ObjectCacheStatistics &statistics)
 	{
 		size_t numaNodeCount = HardwareInfo::getMemoryPlaceCount(nanos6_device_t::nanos6_host_device);
 		size_t cpuCount = HardwareInfo::getComputePlaceCount(nanos6_device_t::nanos6_host_device);
 		HostInfo *deviceInfo = (HostInfo *)HardwareInfo::getDeviceInfo(nanos6_device_t::nanos6_host_device);
 		std::vector<ComputePlace *> cpus = deviceInfo->getComputePlaces();
 		
-		_NUMACache = new NUMAObjectCache<T>(numaNodeCount);
+		_NUMACache = new NUMAObjectCache<T>(numaNodeCount, statistics);
 		_CPUCaches.resize(cpuCount);
 		for (size_t i = 0; i < cpuCount; ++i) {
 			CPU *cpu = (CPU *)cpus[i];
 			_CPUCaches[i] = new CPUObjectCache<T>(
 						_NUMACache,
 						cpu->_NUMANodeId,
-						numaNodeCount
+						numaNodeCount,
+						highWaterMark
 					);
 		}
 		_externalObjectCache = new CPUObjectCache<T>(
 						_NUMACache,
 						/* NUMA Id */ 0,
-						numaNodeCount
+						numaNodeCount,
+						highWaterMark
 					);
 	}
 	
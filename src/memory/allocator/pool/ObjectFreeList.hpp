@@ -0,0 +1,136 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __OBJECT_FREE_LIST_HPP__
+#define __OBJECT_FREE_LIST_HPP__
+
+#include <cassert>
+#include <cstddef>
+
+
+/** Singly linked list of free objects that is threaded through the objects.
+ *
+ * The link is stored in the memory of the object itself, so the objects
+ * must have been destroyed before being added to the list, and the list
+ * does not need any memory of its own. The tail is kept to be able to
+ * move a whole list to another one in constant time.
+ *
+ * The lists are not thread safe. */
+template <typename T>
+class ObjectFreeList {
+	struct Link {
+		Link *_next;
+	};
+	
+	static_assert(sizeof(T) >= sizeof(Link), "The objects must be able to hold a pointer");
+	static_assert(alignof(T) >= alignof(Link), "The objects must be aligned as a pointer");
+	
+	Link *_head;
+	Link *_tail;
+	size_t _size;
+
+public:
+	ObjectFreeList()
+		: _head(nullptr), _tail(nullptr), _size(0)
+	{
+	}
+	
+	inline bool empty() const
+	{
+		return (_size == 0);
+	}
+	
+	inline size_t size() const
+	{
+		return _size;
+	}
+	
+	inline void push(T *object)
+	{
+		Link *link = (Link *) object;
+		link->_next = _head;
+		_head = link;
+		if (_tail == nullptr) {
+			_tail = link;
+		}
+		_size++;
+	}
+	
+	inline T *pop()
+	{
+		assert(!empty());
+		
+		Link *link = _head;
+		_head = link->_next;
+		if (_head == nullptr) {
+			_tail = nullptr;
+		}
+		_size--;
+		
+		return (T *) link;
+	}
+	
+	//! Move all the objects of another list to the front of this one
+	inline void splice(ObjectFreeList &other)
+	{
+		if (other.empty()) {
+			return;
+		}
+		
+		other._tail->_next = _head;
+		if (_tail == nullptr) {
+			_tail = other._tail;
+		}
+		_head = other._head;
+		_size += other._size;
+		
+		other._head = nullptr;
+		other._tail = nullptr;
+		other._size = 0;
+	}
+	
+	//! Keep a number of objects at the front of this list and move the rest to the front of another one
+	inline void truncate(size_t count, ObjectFreeList &other)
+	{
+		if (count >= _size) {
+			return;
+		}
+		
+		ObjectFreeList rest;
+		if (count == 0) {
+			rest.splice(*this);
+		} else {
+			Link *last = _head;
+			for (size_t i = 1; i < count; i++) {
+				last = last->_next;
+			}
+			
+			rest._head = last->_next;
+			rest._tail = _tail;
+			rest._size = _size - count;
+			
+			last->_next = nullptr;
+			_tail = last;
+			_size = count;
+		}
+		
+		other.splice(rest);
+	}
+	
+	//! Move up to a number of objects from the front of this list to the front of another one and return how many
+	inline size_t moveTo(ObjectFreeList &other, size_t count)
+	{
+		size_t moved = 0;
+		while ((moved < count) && !empty()) {
+			other.push(pop());
+			moved++;
+		}
+		
+		return moved;
+	}
+};
+
+#endif /* __OBJECT_FREE_LIST_HPP__ */
@@ -0,0 +1,229 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "NUMAMemoryManagement.hpp"
+#include "executors/threads/CPU.hpp"
+#include "executors/threads/WorkerThread.hpp"
+#include "hardware/HardwareInfo.hpp"
+#include "hardware/places/NUMAPlace.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "memory/vmm/VirtualMemoryArea.hpp"
+
+#if HAVE_DATA_ACCESS_TRAVERSAL
+#include <DataAccessRegistration.hpp>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <numa.h>
+#include <sys/mman.h>
+
+
+std::map<char *, NUMAMemoryManagement::allocation_t> NUMAMemoryManagement::_allocations;
+RWSpinLock NUMAMemoryManagement::_lock;
+
+
+size_t NUMAMemoryManagement::getCurrentNode()
+{
+	//! Like the rest of the runtime, threads that do not run on a CPU of the runtime use the first NUMA node
+	WorkerThread *currentThread = WorkerThread::getCurrentWorkerThread();
+	if ((currentThread != nullptr) && (currentThread->getComputePlace() != nullptr)) {
+		return currentThread->getComputePlace()->_NUMANodeId;
+	}
+	
+	return 0;
+}
+
+int NUMAMemoryManagement::getOSNode(size_t node)
+{
+	NUMAPlace *place = (NUMAPlace *) HardwareInfo::getMemoryPlace(nanos6_device_t::nanos6_host_device, node);
+	assert(place != nullptr);
+	
+	return place->getOSIndex();
+}
+
+void *NUMAMemoryManagement::alloc(size_t size, nanos6_numa_policy_t policy, size_t node, size_t blockSize)
+{
+	if (size == 0) {
+		return nullptr;
+	}
+	
+	size_t pageSize = HardwareInfo::getPageSize();
+	size_t nodeCount = HardwareInfo::getMemoryPlaceCount(nanos6_device_t::nanos6_host_device);
+	size = ROUND_UP(size, pageSize);
+	
+	allocation_t allocation;
+	allocation._size = size;
+	allocation._policy = policy;
+	allocation._node = 0;
+	allocation._blockSize = size;
+	
+	switch (policy) {
+		case nanos6_numa_local_policy:
+			allocation._node = getCurrentNode();
+			break;
+		case nanos6_numa_node_policy:
+			FatalErrorHandler::failIf(
+				node >= nodeCount,
+				"nanos6_numa_alloc called with NUMA node ", node, " but there are only ", nodeCount
+			);
+			allocation._node = node;
+			break;
+		case nanos6_numa_interleaved_policy:
+			allocation._blockSize = pageSize;
+			break;
+		case nanos6_numa_block_policy:
+			allocation._blockSize = ROUND_UP((blockSize > 0) ? blockSize : pageSize, pageSize);
+			break;
+		default:
+			FatalErrorHandler::failIf(true, "Unknown policy passed to nanos6_numa_alloc");
+			return nullptr;
+	}
+	
+	void *address = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if (address == MAP_FAILED) {
+		return nullptr;
+	}
+	
+	//! The pages are placed when they are first touched, so the policy must be set before returning them
+	if ((numa_available() != -1) && (nodeCount > 1)) {
+		switch (policy) {
+			case nanos6_numa_local_policy:
+			case nanos6_numa_node_policy:
+				numa_tonode_memory(address, size, getOSNode(allocation._node));
+				break;
+			case nanos6_numa_interleaved_policy:
+			{
+				struct bitmask *nodes = numa_allocate_nodemask();
+				for (size_t i = 0; i < nodeCount; ++i) {
+					numa_bitmask_setbit(nodes, getOSNode(i));
+				}
+				numa_interleave_memory(address, size, nodes);
+				numa_free_nodemask(nodes);
+				break;
+			}
+			case nanos6_numa_block_policy:
+				for (size_t offset = 0; offset < size; offset += allocation._blockSize) {
+					size_t length = std::min(allocation._blockSize, size - offset);
+					size_t block = offset / allocation._blockSize;
+					numa_tonode_memory((char *) address + offset, length, getOSNode(block % nodeCount));
+				}
+				break;
+		}
+	}
+	
+	_lock.writeLock();
+	_allocations[(char *) address] = allocation;
+	_lock.writeUnlock();
+	
+	return address;
+}
+
+void NUMAMemoryManagement::free(void *ptr)
+{
+	if (ptr == nullptr) {
+		return;
+	}
+	
+	_lock.writeLock();
+	auto it = _allocations.find((char *) ptr);
+	FatalErrorHandler::failIf(
+		it == _allocations.end(),
+		"nanos6_numa_free called with an address that does not match an allocation"
+	);
+	
+	size_t size = it->second._size;
+	_allocations.erase(it);
+	_lock.writeUnlock();
+	
+	munmap(ptr, size);
+}
+
+int NUMAMemoryManagement::getHomeNode(void const *address)
+{
+	_lock.readLock();
+	
+	auto it = _allocations.upper_bound((char *) address);
+	if (it == _allocations.begin()) {
+		_lock.readUnlock();
+		return -1;
+	}
+	--it;
+	
+	allocation_t const &allocation = it->second;
+	size_t offset = (char const *) address - it->first;
+	if (offset >= allocation._size) {
+		_lock.readUnlock();
+		return -1;
+	}
+	
+	size_t nodeCount = HardwareInfo::getMemoryPlaceCount(nanos6_device_t::nanos6_host_device);
+	int homeNode;
+	switch (allocation._policy) {
+		case nanos6_numa_interleaved_policy:
+			//! The kernel interleaves the anonymous memory by the page number of the address among the nodes in increasing order
+			homeNode = ((size_t) address / allocation._blockSize) % nodeCount;
+			break;
+		case nanos6_numa_block_policy:
+			homeNode = (offset / allocation._blockSize) % nodeCount;
+			break;
+		default:
+			homeNode = allocation._node;
+			break;
+	}
+	
+	_lock.readUnlock();
+	
+	return homeNode;
+}
+
+#if HAVE_DATA_ACCESS_TRAVERSAL
+int NUMAMemoryManagement::getHomeNode(Task *task)
+{
+	size_t nodeCount = HardwareInfo::getMemoryPlaceCount(nanos6_device_t::nanos6_host_device);
+	std::vector<size_t> bytesPerNode(nodeCount, 0);
+	bool found = false;
+	
+	DataAccessRegistration::processAllDataAccesses(
+		task,
+		[&](DataAccessRegion const &region, __attribute__((unused)) DataAccessType type, bool weak) -> bool {
+			// Weak accesses are not accessed by the task itself
+			if (weak) {
+				return true;
+			}
+			
+			int homeNode = getHomeNode(region.getStartAddress());
+			if (homeNode != -1) {
+				bytesPerNode[homeNode] += region.getSize();
+				found = true;
+			}
+			return true;
+		}
+	);
+	
+	if (!found) {
+		return -1;
+	}
+	
+	size_t best = 0;
+	for (size_t i = 1; i < nodeCount; ++i) {
+		if (bytesPerNode[i] > bytesPerNode[best]) {
+			best = i;
+		}
+	}
+	
+	return best;
+}
+#else
+int NUMAMemoryManagement::getHomeNode(__attribute__((unused)) Task *task)
+{
+	return -1;
+}
+#endif
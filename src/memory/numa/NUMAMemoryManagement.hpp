@@ -0,0 +1,74 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __NUMA_MEMORY_MANAGEMENT_HPP__
+#define __NUMA_MEMORY_MANAGEMENT_HPP__
+
+#include <map>
+#include <vector>
+
+#include <nanos6/numa.h>
+
+#include "lowlevel/RWSpinLock.hpp"
+
+class Task;
+
+//! Allocations of application memory placed in the NUMA nodes by the runtime
+class NUMAMemoryManagement {
+private:
+	struct allocation_t {
+		size_t _size;
+		
+		nanos6_numa_policy_t _policy;
+		
+		//! NUMA node of the local and node policies
+		size_t _node;
+		
+		//! Size of the blocks of the block policy
+		size_t _blockSize;
+	};
+	
+	//! The live allocations, indexed by their start address
+	static std::map<char *, allocation_t> _allocations;
+	
+	//! The allocations are looked up by the schedulers far more often than they change
+	static RWSpinLock _lock;
+	
+	//! Get the NUMA node of the CPU that runs the current thread
+	static size_t getCurrentNode();
+	
+	//! Get the operating system identifier of a NUMA node
+	static int getOSNode(size_t node);
+
+public:
+	/** Allocate memory placed in the NUMA nodes according to a policy
+	 *
+	 * \param size is the size of the allocation
+	 * \param policy determines the NUMA node of each part
+	 * \param node is the NUMA node of the node policy
+	 * \param blockSize is the block size of the block policy
+	 */
+	static void *alloc(size_t size, nanos6_numa_policy_t policy, size_t node, size_t blockSize);
+	static void free(void *ptr);
+	
+	/** Get the NUMA node that holds an address
+	 *
+	 * \returns the NUMA node, or -1 if the address does not belong to an
+	 * allocation of the runtime
+	 */
+	static int getHomeNode(void const *address);
+	
+	/** Get the NUMA node that holds most of the data accessed by a task
+	 *
+	 * \returns the NUMA node, or -1 if none of the data belongs to an
+	 * allocation of the runtime or the accesses of the tasks cannot be
+	 * traversed by the dependency implementation
+	 */
+	static int getHomeNode(Task *task);
+};
+
+
+#endif /* __NUMA_MEMORY_MANAGEMENT_HPP__ */
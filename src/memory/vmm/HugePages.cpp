@@ -0,0 +1,125 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "HugePages.hpp"
+
+#include "hardware/HardwareInfo.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "system/RuntimeInfo.hpp"
+
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+
+
+HugePages::backing_t HugePages::_requested = base_pages_backing;
+size_t HugePages::_alignment = 0;
+std::atomic<size_t> HugePages::_explicitBytes(0);
+std::atomic<size_t> HugePages::_transparentBytes(0);
+std::atomic<size_t> HugePages::_basePageBytes(0);
+bool HugePages::_initialized = false;
+
+
+size_t HugePages::getDefaultHugePageSize()
+{
+	// The size of the pages that MAP_HUGETLB maps when no size is given
+	std::ifstream meminfo("/proc/meminfo");
+	std::string field;
+	while (meminfo >> field) {
+		if (field == "Hugepagesize:") {
+			size_t kilobytes;
+			if (meminfo >> kilobytes) {
+				return kilobytes * 1024;
+			}
+			break;
+		}
+	}
+	
+	return 2UL << 20;
+}
+
+
+void HugePages::initialize()
+{
+	if (_initialized) {
+		return;
+	}
+	_initialized = true;
+	
+	EnvironmentVariable<std::string> requested("NANOS6_HUGE_PAGES", "none");
+	if (requested.getValue() == "none") {
+		_requested = base_pages_backing;
+	} else if (requested.getValue() == "transparent") {
+		_requested = transparent_backing;
+	} else if (requested.getValue() == "explicit") {
+		_requested = explicit_backing;
+	} else {
+		FatalErrorHandler::failIf(true, "Invalid value for NANOS6_HUGE_PAGES: '", requested.getValue(), "'. Valid values are none, transparent and explicit");
+	}
+	
+	_alignment = HardwareInfo::getPageSize();
+	if (_requested != base_pages_backing) {
+		size_t hugePageSize = getDefaultHugePageSize();
+		if (hugePageSize > _alignment) {
+			_alignment = hugePageSize;
+		}
+	}
+	
+	RuntimeInfo::addEntry("huge_pages", "Huge pages requested for the runtime memory pools", requested.getValue());
+	if (_requested != base_pages_backing) {
+		RuntimeInfo::addEntry("huge_page_size", "Size of the huge pages", _alignment, "bytes");
+		RuntimeInfo::addCounterEntry("huge_pages_explicit", "Runtime memory backed by explicit huge pages", _explicitBytes, "bytes");
+		RuntimeInfo::addCounterEntry("huge_pages_transparent", "Runtime memory backed by transparent huge pages", _transparentBytes, "bytes");
+		RuntimeInfo::addCounterEntry("huge_pages_fallback", "Runtime memory that could not be backed by huge pages", _basePageBytes, "bytes");
+	}
+}
+
+
+HugePages::backing_t HugePages::back(void *address, size_t size, bool allowExplicit)
+{
+	if (_requested == base_pages_backing) {
+		return base_pages_backing;
+	}
+	
+	// Only whole huge pages can be backed
+	size_t start = ((size_t) address + _alignment - 1) & ~(_alignment - 1);
+	size_t end = ((size_t) address + size) & ~(_alignment - 1);
+	if (start >= end) {
+		_basePageBytes += size;
+		return base_pages_backing;
+	}
+	
+	void *alignedAddress = (void *) start;
+	size_t alignedSize = end - start;
+
+#ifdef MAP_HUGETLB
+	if ((_requested == explicit_backing) && allowExplicit) {
+		// Without MAP_NORESERVE the huge pages are reserved now, so the mapping fails instead of the page faults
+		void *result = mmap(alignedAddress, alignedSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_FIXED|MAP_HUGETLB, -1, 0);
+		if (result != MAP_FAILED) {
+			_explicitBytes += alignedSize;
+			_basePageBytes += size - alignedSize;
+			return explicit_backing;
+		}
+		
+		// Some kernels unmap the range before failing, so map it again as it was
+		result = mmap(alignedAddress, alignedSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_FIXED|MAP_NORESERVE, -1, 0);
+		FatalErrorHandler::check(result != MAP_FAILED, "restoring the mapping of a range that could not be backed by huge pages");
+	}
+#endif
+
+#ifdef MADV_HUGEPAGE
+	if (madvise(alignedAddress, alignedSize, MADV_HUGEPAGE) == 0) {
+		_transparentBytes += alignedSize;
+		_basePageBytes += size - alignedSize;
+		return transparent_backing;
+	}
+#endif
+
+	_basePageBytes += size;
+	return base_pages_backing;
+}
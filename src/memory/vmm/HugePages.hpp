@@ -0,0 +1,79 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef __HUGE_PAGES_HPP__
+#define __HUGE_PAGES_HPP__
+
+#include <atomic>
+#include <cstddef>
+
+
+//! \brief Backing of the memory of the runtime pools with huge pages
+//!
+//! The NANOS6_HUGE_PAGES envar selects the kind of huge pages that are
+//! requested: "none" (the default), "transparent" to ask the kernel to use
+//! transparent huge pages through madvise, or "explicit" to map pages from
+//! the reserved huge page pool with MAP_HUGETLB. Each request falls back to
+//! the next weaker kind when it cannot be satisfied, and the number of bytes
+//! that have actually been obtained with each kind is reported in the
+//! runtime information.
+class HugePages {
+public:
+	enum backing_t {
+		base_pages_backing = 0,
+		transparent_backing,
+		explicit_backing
+	};
+
+private:
+	//! The kind of pages requested by the user
+	static backing_t _requested;
+	
+	//! The size of the huge pages, or the base page size if they have not been requested
+	static size_t _alignment;
+	
+	//! Bytes that have been obtained with each kind of pages
+	static std::atomic<size_t> _explicitBytes;
+	static std::atomic<size_t> _transparentBytes;
+	static std::atomic<size_t> _basePageBytes;
+	
+	static bool _initialized;
+	
+	static size_t getDefaultHugePageSize();
+
+public:
+	//! \brief Read the configuration and register the runtime information entries
+	//!
+	//! Calling it more than once has no effect
+	static void initialize();
+	
+	//! \brief Get the alignment that the memory regions should have to be backed by huge pages
+	static inline size_t getAlignment()
+	{
+		return _alignment;
+	}
+	
+	static inline bool enabled()
+	{
+		return (_requested != base_pages_backing);
+	}
+	
+	//! \brief Back the huge page aligned part of a range of fresh memory with huge pages
+	//!
+	//! The range must be part of a private anonymous mapping and its contents
+	//! are discarded. The NUMA memory policy must be set afterwards, since
+	//! the explicit huge pages replace the existing mapping.
+	//!
+	//! \param[in] address the start of the range
+	//! \param[in] size the size of the range
+	//! \param[in] allowExplicit whether the mapping may be replaced by one of explicit huge pages
+	//!
+	//! \returns the kind of pages that back the aligned part of the range
+	static backing_t back(void *address, size_t size, bool allowExplicit = true);
+};
+
+
+#endif /* __HUGE_PAGES_HPP__ */
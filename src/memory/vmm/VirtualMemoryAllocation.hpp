@@ -29,7 +29,14 @@ class VirtualMemoryAllocation {
 	}
 	
 public:
-	VirtualMemoryAllocation(void *address, size_t size)
+	/** Map a range of virtual addresses.
+	 *
+	 * \param address the start of the range, or nullptr to let the OS choose it
+	 * \param size the size of the range
+	 * \param alignment the alignment of the range when the OS chooses it,
+	 * 	  which is used to place it at huge page boundaries
+	 */
+	VirtualMemoryAllocation(void *address, size_t size, size_t alignment = 0)
 		: _address(address), _size(size)
 	{
 		/** For the moment we are using fixed memory protection and
@@ -39,13 +46,29 @@ public:
 		int flags = MAP_ANONYMOUS|MAP_PRIVATE|MAP_NORESERVE;
 		if (_address != nullptr) {
 			flags |= MAP_FIXED;
+			alignment = 0;
 		}
-		void *ret = mmap(_address, _size, prot, flags, -1, 0);
+		
+		//! Reserve enough to find an aligned range and unmap the rest
+		size_t extra = alignment;
+		void *ret = mmap(_address, _size + extra, prot, flags, -1, 0);
 		FatalErrorHandler::check(
 			ret != MAP_FAILED,
 			"mapping virtual address space failed"
 		);
 		
+		if (extra != 0) {
+			char *start = (char *)ret;
+			char *aligned = (char *)(((size_t)start + alignment - 1) & ~(alignment - 1));
+			if (aligned != start) {
+				unmap(start, aligned - start);
+			}
+			if (aligned + _size != start + _size + extra) {
+				unmap(aligned + _size, (start + _size + extra) - (aligned + _size));
+			}
+			ret = aligned;
+		}
+		
 		_address = ret;
 	}
 	
@@ -8,6 +8,7 @@
 #include "hardware/cluster/ClusterNode.hpp"
 #include "lowlevel/EnvironmentVariable.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
+#include "memory/vmm/HugePages.hpp"
 #include "memory/vmm/VirtualMemoryAllocation.hpp"
 #include "memory/vmm/VirtualMemoryArea.hpp"
 #include "VirtualMemoryManagement.hpp"
@@ -20,19 +21,24 @@
 std::vector<VirtualMemoryAllocation *> VirtualMemoryManagement::_allocations;
 std::vector<VirtualMemoryArea *> VirtualMemoryManagement::_localNUMAVMA;
 VirtualMemoryArea *VirtualMemoryManagement::_genericVMA;
+VirtualMemoryManagement::vmm_lock_t VirtualMemoryManagement::_lock;
 
 void VirtualMemoryManagement::initialize()
 {
 	size_t totalPhysicalMemory = HardwareInfo::getPhysicalMemorySize();
 	size_t distribSize = 0;
 	
+	//! The areas are placed at huge page boundaries if huge pages have been requested
+	HugePages::initialize();
+	size_t pageSize = HugePages::getAlignment();
+	
 	/* NANOS6_DISTRIBUTED_MEMORY determines the total address space to be
 	 * used for distributed allocations across the cluster.
 	 * Default value: 2GB */
 	EnvironmentVariable<StringifiedMemorySize> distribSizeEnv("NANOS6_DISTRIBUTED_MEMORY", (2UL << 30));
 	distribSize = distribSizeEnv.getValue();
 	assert(distribSize > 0);
-	distribSize = ROUND_UP(distribSize, HardwareInfo::getPageSize());
+	distribSize = ROUND_UP(distribSize, pageSize);
 	
 	/* NANOS6_LOCAL_MEMORY determines the size of the local address space
 	 * per cluster node.
@@ -42,7 +48,7 @@ void VirtualMemoryManagement::initialize()
 	EnvironmentVariable<StringifiedMemorySize> localSizeEnv("NANOS6_LOCAL_MEMORY", localSize);
 	localSize = localSizeEnv.getValue();
 	assert(localSize > 0);
-	localSize = ROUND_UP(localSize, HardwareInfo::getPageSize());
+	localSize = ROUND_UP(localSize, pageSize);
 	
 	/* At the moment we use as default value for start address 256MB,
 	 * because it seems to be working (lower values not always succeed).
@@ -50,6 +56,10 @@ void VirtualMemoryManagement::initialize()
 	 * failing. */
 	EnvironmentVariable<void *> startAddress("NANOS6_VA_START", (void *)(2UL << 27));
 	void *address = startAddress.getValue();
+	FatalErrorHandler::failIf(
+		((size_t)address % pageSize) != 0,
+		"NANOS6_VA_START must be aligned to ", pageSize, " bytes"
+	);
 	
 	size_t size = distribSize + localSize * ClusterManager::clusterSize();
 	
@@ -92,16 +102,17 @@ void VirtualMemoryManagement::setupMemoryLayout(void *address, size_t distribSiz
 	
 	/** Divide the address space between the NUMA nodes and the
 	 * making sure that all areas have a size that is multiple
-	 * of PAGE_SIZE */
-	size_t localPages = localSize / HardwareInfo::getPageSize();
+	 * of PAGE_SIZE, or of the huge page size if they are used */
+	size_t pageSize = HugePages::getAlignment();
+	size_t localPages = localSize / pageSize;
 	size_t pagesPerNUMA = localPages / numaNodeCount;
 	size_t extraPages = localPages % numaNodeCount;
-	size_t sizePerNUMA = pagesPerNUMA * HardwareInfo::getPageSize();
+	size_t sizePerNUMA = pagesPerNUMA * pageSize;
 	char *ptr = (char *)localAddress;
 	for (size_t i = 0; i < numaNodeCount; ++i) {
 		size_t numaSize = sizePerNUMA;
 		if (extraPages > 0) {
-			numaSize += HardwareInfo::getPageSize();
+			numaSize += pageSize;
 			extraPages--;
 		}
 		_localNUMAVMA[i] = new VirtualMemoryArea(ptr, numaSize);
@@ -7,12 +7,13 @@
 #ifndef __VIRTUAL_MEMORY_MANAGEMENT_HPP__
 #define __VIRTUAL_MEMORY_MANAGEMENT_HPP__
 
+#include "lowlevel/PaddedSpinLock.hpp"
+#include "memory/vmm/VirtualMemoryAllocation.hpp"
 #include "memory/vmm/VirtualMemoryArea.hpp"
 
+#include <mutex>
 #include <vector>
 
-class VirtualMemoryAllocation;
-
 class VirtualMemoryManagement {
 private:
 	//! memory allocations from OS
@@ -24,6 +25,10 @@ private:
 	//! addresses for generic allocations
 	static VirtualMemoryArea *_genericVMA;
 	
+	//! The areas are shared by the runtime allocator and the user allocations
+	typedef PaddedSpinLock<64> vmm_lock_t;
+	static vmm_lock_t _lock;
+	
 	//! Setting up the memory layout
 	static void setupMemoryLayout(void *address, size_t distribSize, size_t localSize);
 	
@@ -43,6 +48,7 @@ public:
 	 */
 	static inline void *allocDistrib(size_t size)
 	{
+		std::lock_guard<vmm_lock_t> guard(_lock);
 		return _genericVMA->allocBlock(size);
 	}
 	
@@ -54,6 +60,8 @@ public:
 	static inline void *allocLocalNUMA(size_t size, size_t NUMAId)
 	{
 		VirtualMemoryArea *vma = _localNUMAVMA.at(NUMAId);
+		
+		std::lock_guard<vmm_lock_t> guard(_lock);
 		return vma->allocBlock(size);
 	}
 	
@@ -70,6 +78,26 @@ public:
 		//! Non-NUMA allocation
 		return _localNUMAVMA.size();
 	}
+	
+	/** check whether a memory range lies within the address space
+	 * that is mapped at the same addresses in all the cluster nodes.
+	 *
+	 * \param address is the start of the range
+	 * \param size is the size of the range
+	 */
+	static inline bool isClusterMemory(void *address, size_t size)
+	{
+		for (auto &allocation : _allocations) {
+			char *start = (char *)allocation->getAddress();
+			char *end = start + allocation->getSize();
+			
+			if (((char *)address >= start) && ((char *)address + size <= end)) {
+				return true;
+			}
+		}
+		
+		return false;
+	}
 };
 
 
@@ -7,6 +7,7 @@
 #include "hardware/HardwareInfo.hpp"
 #include "lowlevel/EnvironmentVariable.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
+#include "memory/vmm/HugePages.hpp"
 #include "memory/vmm/VirtualMemoryArea.hpp"
 #include "VirtualMemoryManagement.hpp"
 #include "system/RuntimeInfo.hpp"
@@ -22,6 +23,9 @@ void VirtualMemoryManagement::initialize()
 {
 	size_t totalPhysicalMemory = HardwareInfo::getPhysicalMemorySize();
 	
+	//! The areas are placed at huge page boundaries if huge pages have been requested
+	HugePages::initialize();
+	
 	/* NANOS6_LOCAL_MEMORY determines the size of the local address space
 	 * per cluster node.
 	 * Default value: Trying to map the minimum between 2GB and the 5% of
@@ -30,10 +34,10 @@ void VirtualMemoryManagement::initialize()
 	EnvironmentVariable<StringifiedMemorySize> _sizeEnv("NANOS6_LOCAL_MEMORY", _size);
 	_size = _sizeEnv.getValue();
 	assert(_size > 0);
-	_size = ROUND_UP(_size, HardwareInfo::getPageSize());
+	_size = ROUND_UP(_size, HugePages::getAlignment());
 	
 	_allocations.resize(1);
-	_allocations[0] = new VirtualMemoryAllocation(nullptr, _size);
+	_allocations[0] = new VirtualMemoryAllocation(nullptr, _size, HugePages::getAlignment());
 	
 	_localNUMAVMA.resize(HardwareInfo::getMemoryPlaceCount(nanos6_device_t::nanos6_host_device));
 	HostInfo *deviceInfo = (HostInfo *)HardwareInfo::getDeviceInfo(nanos6_device_t::nanos6_host_device);
@@ -65,17 +69,18 @@ void VirtualMemoryManagement::setupMemoryLayout(
 	
 	/** Divide the address space between the NUMA nodes and the
 	 * making sure that all areas have a size that is multiple
-	 * of PAGE_SIZE */
-	size_t localPages = size / HardwareInfo::getPageSize();
+	 * of PAGE_SIZE, or of the huge page size if they are used */
+	size_t pageSize = HugePages::getAlignment();
+	size_t localPages = size / pageSize;
 	size_t pagesPerNUMA = localPages / numaNodeCount;
 	size_t extraPages = localPages % numaNodeCount;
-	size_t sizePerNUMA = pagesPerNUMA * HardwareInfo::getPageSize();
+	size_t sizePerNUMA = pagesPerNUMA * pageSize;
 	char *ptr = (char *)address;
 	for (size_t i = 0; i < numaNodeCount; ++i) {
 		size_t nodeId = numaNodes[i]->getIndex();
 		size_t numaSize = sizePerNUMA;
 		if (extraPages > 0) {
-			numaSize += HardwareInfo::getPageSize();
+			numaSize += pageSize;
 			extraPages--;
 		}
 		_localNUMAVMA[nodeId].push_back(new VirtualMemoryArea(ptr, numaSize));
@@ -8,6 +8,7 @@
 #define __VIRTUAL_MEMORY_MANAGEMENT_HPP__
 
 #include "lowlevel/PaddedSpinLock.hpp"
+#include "memory/vmm/HugePages.hpp"
 #include "memory/vmm/VirtualMemoryAllocation.hpp"
 #include "memory/vmm/VirtualMemoryArea.hpp"
 
@@ -80,10 +81,10 @@ public:
 		size_t allocation_size = (size < _size) ? _size : 2 * size;
 		
 		//! We need the size of allocations to be a multiple of page size
-		allocation_size = ROUND_UP(allocation_size, HardwareInfo::getPageSize());
+		allocation_size = ROUND_UP(allocation_size, HugePages::getAlignment());
 		
 		VirtualMemoryAllocation *alloc = new VirtualMemoryAllocation(
-				nullptr, allocation_size);
+				nullptr, allocation_size, HugePages::getAlignment());
 		
 		_allocations.push_back(alloc);
 		_localNUMAVMA[numaNodeId].push_back(
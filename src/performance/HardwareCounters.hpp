@@ -16,7 +16,8 @@
 namespace HardwareCounters {
 	enum counter_types_t {
 		no_counters_counters_type = 0,
-		papi_counters_type
+		papi_counters_type,
+		perf_counters_type
 	};
 	
 	enum preset_counter_t {
@@ -76,6 +77,8 @@ namespace HardwareCounters {
 
 #if HAVE_PAPI
 #include "PAPI/PAPIHardwareCounters.hpp"
+#elif HAVE_PERF_EVENT
+#include "perf/PerfHardwareCounters.hpp"
 #else
 #include "no-HC/NoHardwareCounters.hpp"
 #endif
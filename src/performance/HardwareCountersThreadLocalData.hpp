@@ -10,6 +10,8 @@
 
 #if HAVE_PAPI
 #include "PAPI/PAPIHardwareCountersThreadLocalData.hpp"
+#elif HAVE_PERF_EVENT
+#include "perf/PerfHardwareCountersThreadLocalData.hpp"
 #else
 #include "no-HC/NoHardwareCountersThreadLocalData.hpp"
 #endif
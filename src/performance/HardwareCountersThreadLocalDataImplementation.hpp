@@ -10,6 +10,8 @@
 
 #if HAVE_PAPI
 #include "PAPI/PAPIHardwareCountersThreadLocalDataImplementation.hpp"
+#elif HAVE_PERF_EVENT
+#include "perf/PerfHardwareCountersThreadLocalDataImplementation.hpp"
 #else
 #include "no-HC/NoHardwareCountersThreadLocalDataImplementation.hpp"
 #endif
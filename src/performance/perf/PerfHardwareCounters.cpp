@@ -0,0 +1,260 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "PerfHardwareCounters.hpp"
+#include "PerfHardwareCountersThreadLocalDataImplementation.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "system/RuntimeInfo.hpp"
+
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace HardwareCounters {
+	namespace Perf {
+		int _initializationCount = 0;
+		
+		event_description_t _events[max_events];
+		event_index_t _totalEvents = 0;
+		
+		event_index_t _cyclesEventIndex = -1;
+		event_index_t _instructionsEventIndex = -1;
+		event_index_t _l1CacheEventIndex = -1;
+		event_index_t _llcEventIndex = -1;
+		
+		
+		static inline uint64_t cacheEventConfig(uint64_t cache, uint64_t operation, uint64_t result)
+		{
+			return cache | (operation << 8) | (result << 16);
+		}
+		
+		
+		static int openEvent(event_description_t const &event, int groupLeader)
+		{
+			struct perf_event_attr attributes;
+			memset(&attributes, 0, sizeof(attributes));
+			
+			attributes.size = sizeof(attributes);
+			attributes.type = event._type;
+			attributes.config = event._config;
+			attributes.disabled = (groupLeader == -1);
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			
+			// Count the calling thread on any CPU
+			return syscall(__NR_perf_event_open, &attributes, 0, -1, groupLeader, PERF_FLAG_FD_CLOEXEC);
+		}
+		
+		
+		//! \brief Open the events as a group and return the number of events that could be opened
+		static int openGroup(event_description_t const *events, int count, int *fds)
+		{
+			int opened = 0;
+			
+			for (int event = 0; event < count; event++) {
+				fds[event] = openEvent(events[event], (event == 0 ? -1 : fds[0]));
+				if (fds[event] == -1) {
+					break;
+				}
+				opened++;
+			}
+			
+			return opened;
+		}
+		
+		
+		static void closeGroup(int *fds, int count)
+		{
+			// Close the members before the leader
+			for (int event = count - 1; event >= 0; event--) {
+				if (fds[event] != -1) {
+					close(fds[event]);
+					fds[event] = -1;
+				}
+			}
+		}
+		
+		
+		//! \brief Add a set of events if the group that has been chosen so far can be scheduled with them
+		static bool tryToAddEvents(std::vector<event_description_t> const &events, /* OUT */ event_index_t &startEventIndex)
+		{
+			if (_totalEvents + (int) events.size() > max_events) {
+				return false;
+			}
+			
+			event_description_t candidates[max_events];
+			for (int event = 0; event < _totalEvents; event++) {
+				candidates[event] = _events[event];
+			}
+			for (size_t event = 0; event < events.size(); event++) {
+				candidates[_totalEvents + event] = events[event];
+			}
+			int count = _totalEvents + events.size();
+			
+			int fds[max_events];
+			int opened = openGroup(candidates, count, fds);
+			
+			bool works = (opened == count);
+			if (works) {
+				// The group must also be schedulable as a whole, otherwise it would never count
+				ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+				
+				uint64_t values[1 + max_events];
+				works = (read(fds[0], values, sizeof(values)) > 0);
+				
+				ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+			}
+			
+			closeGroup(fds, opened);
+			
+			if (works) {
+				startEventIndex = _totalEvents;
+				for (size_t event = 0; event < events.size(); event++) {
+					_events[_totalEvents++] = events[event];
+				}
+			}
+			
+			return works;
+		}
+		
+		
+		static void chooseEvents()
+		{
+			assert(_totalEvents == 0);
+			
+			bool worked = tryToAddEvents(
+				{ { "PERF_COUNT_HW_CPU_CYCLES", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES } },
+				_cyclesEventIndex
+			);
+			if (!worked) {
+				FatalErrorHandler::warnIf(true,
+					"Cannot count cycles with perf_event_open (", strerror(errno), "). Hardware counters will be disabled");
+				return;
+			}
+			
+			tryToAddEvents(
+				{ { "PERF_COUNT_HW_INSTRUCTIONS", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS } },
+				_instructionsEventIndex
+			);
+			
+			// The miss ratios are computed from pairs of accesses and misses
+			tryToAddEvents(
+				{
+					{
+						"L1D_READ_ACCESS", PERF_TYPE_HW_CACHE,
+						cacheEventConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS)
+					},
+					{
+						"L1D_READ_MISS", PERF_TYPE_HW_CACHE,
+						cacheEventConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)
+					}
+				},
+				_l1CacheEventIndex
+			);
+			tryToAddEvents(
+				{
+					{ "PERF_COUNT_HW_CACHE_REFERENCES", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+					{ "PERF_COUNT_HW_CACHE_MISSES", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES }
+				},
+				_llcEventIndex
+			);
+		}
+		
+		
+		void openThreadEvents(ThreadLocal &threadLocal)
+		{
+			assert(!threadLocal._valid);
+			
+			if (_totalEvents == 0) {
+				return;
+			}
+			
+			int opened = openGroup(_events, _totalEvents, threadLocal._fds);
+			if (opened != _totalEvents) {
+				FatalErrorHandler::warnIf(true, "Cannot open the hardware counters of a thread: ", strerror(errno));
+				closeGroup(threadLocal._fds, opened);
+				return;
+			}
+			
+			long pageSize = sysconf(_SC_PAGESIZE);
+			for (int event = 0; event < _totalEvents; event++) {
+				// Only the first page is needed to read the counter from user space
+				void *page = mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, threadLocal._fds[event], 0);
+				if (page != MAP_FAILED) {
+					threadLocal._pages[event] = (struct perf_event_mmap_page *) page;
+				}
+			}
+			
+			int rc = ioctl(threadLocal._fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+			if (rc != 0) {
+				FatalErrorHandler::warnIf(true, "Cannot start the hardware counters of a thread: ", strerror(errno));
+				closeThreadEvents(threadLocal);
+				return;
+			}
+			
+			threadLocal._valid = true;
+		}
+		
+		
+		void closeThreadEvents(ThreadLocal &threadLocal)
+		{
+			threadLocal._valid = false;
+			
+			long pageSize = sysconf(_SC_PAGESIZE);
+			for (int event = 0; event < max_events; event++) {
+				if (threadLocal._pages[event] != nullptr) {
+					munmap(threadLocal._pages[event], pageSize);
+					threadLocal._pages[event] = nullptr;
+				}
+			}
+			
+			closeGroup(threadLocal._fds, max_events);
+		}
+	} // HardwareCounters::Perf
+	
+	
+	void initialize()
+	{
+		assert(Perf::_initializationCount >= 0);
+		Perf::_initializationCount++;
+		
+		if (Perf::_initializationCount > 1) {
+			// Only really initialize once
+			return;
+		}
+		
+		RuntimeInfo::addEntry("hardware_counters", "Hardware Counters", "perf_event");
+		
+		Perf::chooseEvents();
+		
+		{
+			std::vector<std::string> eventNames;
+			eventNames.reserve(Perf::_totalEvents);
+			
+			for (int event = 0; event < Perf::_totalEvents; event++) {
+				eventNames.emplace_back(Perf::_events[event]._name);
+			}
+			
+			RuntimeInfo::addListEntry("perf_events", "perf_event Event Names", eventNames.begin(), eventNames.end());
+		}
+	}
+	
+	
+	void shutdown()
+	{
+		assert(Perf::_initializationCount > 0);
+		Perf::_initializationCount--;
+	}
+
+} // HardwareCounters
+
@@ -0,0 +1,513 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PERF_HARDWARE_COUNTERS_HPP
+#define PERF_HARDWARE_COUNTERS_HPP
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/perf_event.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../HardwareCounters.hpp"
+#include "PerfHardwareCountersThreadLocalData.hpp"
+
+
+namespace HardwareCounters {
+	namespace Perf {
+		enum perf_constants_t {
+			max_events = 8
+		};
+		
+		typedef signed char event_index_t;
+		typedef uint64_t event_value_t;
+		
+		struct event_description_t {
+			char const *_name;
+			uint32_t _type;
+			uint64_t _config;
+		};
+		
+		extern int _initializationCount;
+		
+		//! \brief The events that could be opened together, in the order of the group
+		extern event_description_t _events[max_events];
+		extern event_index_t _totalEvents;
+		
+		extern event_index_t _cyclesEventIndex;
+		extern event_index_t _instructionsEventIndex;
+		extern event_index_t _l1CacheEventIndex;
+		extern event_index_t _llcEventIndex;
+		
+		struct ThreadLocal {
+			int _initializationCount;
+			int _fds[max_events];
+			
+			//! \brief The pages through which the counters can be read without system calls
+			struct perf_event_mmap_page *_pages[max_events];
+			
+			bool _valid;
+			
+			ThreadLocal()
+				: _initializationCount(0), _valid(false)
+			{
+				for (int event = 0; event < max_events; event++) {
+					_fds[event] = -1;
+					_pages[event] = nullptr;
+				}
+			}
+		};
+		
+		//! \brief Open the group of events for the current thread
+		void openThreadEvents(ThreadLocal &threadLocal);
+		
+		//! \brief Close the group of events of the current thread
+		void closeThreadEvents(ThreadLocal &threadLocal);
+
+
+#if defined(__x86_64__) || defined(__i386__)
+		inline uint64_t rdpmc(uint32_t counter)
+		{
+			uint32_t low, high;
+			__asm__ volatile("rdpmc" : "=a" (low), "=d" (high) : "c" (counter));
+			
+			return ((uint64_t) high << 32) | low;
+		}
+#endif
+
+		//! \brief Read a counter of the current thread, if possible from user space
+		inline bool readCounter(ThreadLocal const &threadLocal, int event, event_value_t &value)
+		{
+#if defined(__x86_64__) || defined(__i386__)
+			struct perf_event_mmap_page *page = threadLocal._pages[event];
+			if (page != nullptr) {
+				uint32_t sequence;
+				uint32_t index;
+				int64_t count;
+				
+				do {
+					sequence = page->lock;
+					std::atomic_signal_fence(std::memory_order_acquire);
+					
+					index = page->index;
+					count = page->offset;
+					if (page->cap_user_rdpmc && (index != 0)) {
+						// Sign extend the counter to the width of the hardware register
+						uint16_t width = page->pmc_width;
+						int64_t pmc = rdpmc(index - 1);
+						pmc <<= 64 - width;
+						pmc >>= 64 - width;
+						
+						count += pmc;
+					}
+					
+					std::atomic_signal_fence(std::memory_order_acquire);
+				} while (page->lock != sequence);
+				
+				if (page->cap_user_rdpmc && (index != 0)) {
+					value = count;
+					return true;
+				}
+			}
+#endif
+
+			// The counter is not currently on a hardware register or user space reads are not supported
+			return (read(threadLocal._fds[event], &value, sizeof(value)) == sizeof(value));
+		}
+		
+		inline bool readCounters(ThreadLocal const &threadLocal, event_value_t *values)
+		{
+			for (int event = 0; event < _totalEvents; event++) {
+				if (!readCounter(threadLocal, event, values[event])) {
+					return false;
+				}
+			}
+			
+			return true;
+		}
+		
+		inline event_value_t getRealNsecs()
+		{
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			
+			return ((event_value_t) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+		}
+	}
+	
+	
+	enum implementation_type_t {
+		counters_type = perf_counters_type
+	};
+	
+	
+	inline void initializeThread()
+	{
+		assert(Perf::_initializationCount > 0);
+		Perf::ThreadLocal &threadLocal = Perf::getCurrentThreadHardwareCounters();
+		
+		assert(threadLocal._initializationCount >= 0);
+		
+		threadLocal._initializationCount++;
+		
+		if (threadLocal._initializationCount > 1) {
+			return;
+		}
+		
+		Perf::openThreadEvents(threadLocal);
+	}
+	
+	inline void shutdownThread()
+	{
+		Perf::ThreadLocal &threadLocal = Perf::getCurrentThreadHardwareCounters();
+		
+		assert(threadLocal._initializationCount > 0);
+		
+		threadLocal._initializationCount--;
+		if (threadLocal._initializationCount > 0) {
+			return;
+		}
+		
+		Perf::closeThreadEvents(threadLocal);
+	}
+	
+	
+	class CounterSetReference {
+	protected:
+		Perf::event_value_t &_realNsecs;
+		Perf::event_value_t *_counterSet;
+	
+	public:
+		CounterSetReference(Perf::event_value_t &realNsecs, Perf::event_value_t *counterSet)
+			: _realNsecs(realNsecs), _counterSet(counterSet)
+		{
+		}
+		
+		CounterSetReference &operator+=(CounterSetReference const &other)
+		{
+			_realNsecs += other._realNsecs;
+			
+			for (int i = 0; i < Perf::_totalEvents; i++) {
+				_counterSet[i] += other._counterSet[i];
+			}
+			
+			return *this;
+		}
+		
+		CounterSetReference &operator/=(size_t divider)
+		{
+			_realNsecs /= divider;
+			
+			for (int i = 0; i < Perf::_totalEvents; i++) {
+				_counterSet[i] /= divider;
+			}
+			
+			return *this;
+		}
+		
+		
+		class iterator {
+		protected:
+			friend class HardwareCounters::CounterSetReference;
+			
+			CounterSetReference const &_counterSetReference;
+			int _index;
+			
+			bool inValidIndex() const
+			{
+				switch (_index) {
+					case real_frequency_counter:
+					case real_nsecs_counter:
+						return (Perf::_cyclesEventIndex != -1);
+					case ipc_counter:
+						return ((Perf::_cyclesEventIndex != -1) && (Perf::_instructionsEventIndex != -1));
+					case l1_miss_ratio_counter:
+						return (Perf::_l1CacheEventIndex != -1);
+					case l3_miss_ratio_count:
+						return (Perf::_llcEventIndex != -1);
+					case total_instructions:
+						return (Perf::_instructionsEventIndex != -1);
+					case virtual_frequency_counter:
+					case virtual_nsecs_counter:
+						// Measuring the thread CPU time would need a system call per reading
+					case l2_miss_ratio_counter:
+					case fpc_counter:
+						return false;
+					default:
+						return (_index < ((int) total_preset_counter + Perf::_totalEvents));
+				}
+				
+				return false;
+			}
+			
+			void advanceOnce()
+			{
+				_index++;
+			}
+			
+			void advanceUntilValidOrEnd()
+			{
+				while ((_index < total_preset_counter) && !inValidIndex()) {
+					advanceOnce();
+				}
+			}
+			
+			iterator(CounterSetReference const &counterSetReference, int index = 0)
+				: _counterSetReference(counterSetReference), _index(index)
+			{
+				advanceUntilValidOrEnd();
+			}
+			
+			double getMissRatio(Perf::event_index_t eventIndex) const
+			{
+				assert(eventIndex != -1);
+				
+				// The events are opened as pairs of accesses and misses
+				return (double) _counterSetReference._counterSet[eventIndex+1]
+					/ _counterSetReference._counterSet[eventIndex];
+			}
+		
+		
+		public:
+			counter_value_t operator*() const
+			{
+				assert(_index < ((int) total_preset_counter + Perf::_totalEvents));
+				assert(_index >= 0);
+				
+				switch (_index) {
+					case real_frequency_counter:
+						return counter_value_t(
+							_presetCounterNames[_index],
+							_counterSetReference._counterSet[Perf::_cyclesEventIndex] / (double) _counterSetReference._realNsecs,
+							"GHz"
+						);
+						break;
+					case ipc_counter:
+						return counter_value_t(
+							_presetCounterNames[_index],
+							_counterSetReference._counterSet[Perf::_instructionsEventIndex]
+								/ (double) _counterSetReference._counterSet[Perf::_cyclesEventIndex]
+						);
+						break;
+					case l1_miss_ratio_counter:
+						return counter_value_t(
+							_presetCounterNames[_index],
+							getMissRatio(Perf::_l1CacheEventIndex)
+						);
+						break;
+					case l3_miss_ratio_count:
+						return counter_value_t(
+							"Last level cache miss ratio",
+							getMissRatio(Perf::_llcEventIndex)
+						);
+						break;
+					case real_nsecs_counter:
+						return counter_value_t(
+							_presetCounterNames[_index],
+							(long) _counterSetReference._realNsecs,
+							"nsecs"
+						);
+						break;
+					case total_instructions:
+						return counter_value_t(
+							_presetCounterNames[_index],
+							(long) _counterSetReference._counterSet[Perf::_instructionsEventIndex],
+							"instructions"
+						);
+						break;
+					
+					default:
+					{
+						int eventIndex = _index - total_preset_counter;
+						
+						return counter_value_t(
+							Perf::_events[eventIndex]._name,
+							(long) _counterSetReference._counterSet[eventIndex]
+						);
+					}
+				}
+				
+				return counter_value_t("", (long) 0);
+			}
+			
+			iterator &operator++()
+			{
+				advanceOnce();
+				advanceUntilValidOrEnd();
+				
+				return *this;
+			}
+			
+			iterator operator++(int)
+			{
+				int initialIndex = _index;
+				
+				advanceOnce();
+				advanceUntilValidOrEnd();
+				
+				return iterator(_counterSetReference, initialIndex);
+			}
+			
+			bool operator==(iterator const &other) const
+			{
+				return (_index == other._index);
+			}
+			
+			bool operator!=(iterator const &other) const
+			{
+				return (_index != other._index);
+			}
+		
+		}; // iterator
+		
+		
+		iterator begin()
+		{
+			return iterator(*this);
+		}
+		
+		iterator end()
+		{
+			return iterator(*this, ((int) total_preset_counter + Perf::_totalEvents));
+		}
+	};
+	
+	
+	//! \brief Counters that are kept inline, since an instance is created for each task
+	template <int NUM_SETS>
+	class Counters {
+	protected:
+		Perf::event_value_t _realNsecs[NUM_SETS];
+		Perf::event_value_t _counterSets[NUM_SETS][Perf::max_events];
+	
+	public:
+		Counters()
+		{
+			for (int set = 0; set < NUM_SETS; set++) {
+				_realNsecs[set] = 0;
+				for (int i = 0; i < Perf::max_events; i++) {
+					_counterSets[set][i] = 0;
+				}
+			}
+		}
+		
+		CounterSetReference operator[](int set)
+		{
+			assert(set < NUM_SETS);
+			return CounterSetReference(_realNsecs[set], _counterSets[set]);
+		}
+		
+		Counters &operator+=(Counters const &other)
+		{
+			for (int set = 0; set < NUM_SETS; set++) {
+				_realNsecs[set] += other._realNsecs[set];
+				for (int i = 0; i < Perf::_totalEvents; i++) {
+					_counterSets[set][i] += other._counterSets[set][i];
+				}
+			}
+			
+			return *this;
+		}
+	};
+	
+	
+	//! \brief Counters of a task
+	//!
+	//! The counters of each thread run continuously. Each task reads them when
+	//! it starts running and accumulates the difference when it stops, so
+	//! tasks that block and resume in another thread are counted correctly.
+	template <int NUM_SETS>
+	class ThreadCounters : public Counters<NUM_SETS> {
+	protected:
+		Perf::event_value_t _realStart;
+		Perf::event_value_t _startValues[Perf::max_events];
+		bool _valid;
+		
+		inline bool accumulate(int set)
+		{
+			Perf::ThreadLocal &threadLocal = Perf::getCurrentThreadHardwareCounters();
+			if (!threadLocal._valid) {
+				return false;
+			}
+			
+			Perf::event_value_t currentValues[Perf::max_events];
+			if (!Perf::readCounters(threadLocal, currentValues)) {
+				return false;
+			}
+			Perf::event_value_t realStop = Perf::getRealNsecs();
+			
+			for (int i = 0; i < Perf::_totalEvents; i++) {
+				Counters<NUM_SETS>::_counterSets[set][i] += currentValues[i] - _startValues[i];
+				_startValues[i] = currentValues[i];
+			}
+			Counters<NUM_SETS>::_realNsecs[set] += realStop - _realStart;
+			_realStart = realStop;
+			
+			return true;
+		}
+	
+	public:
+		ThreadCounters()
+			: Counters<NUM_SETS>(),
+			_realStart(0),
+			_valid(false)
+		{
+		}
+		
+		ThreadCounters(ThreadCounters const &other) = delete;
+		ThreadCounters &operator=(ThreadCounters const &other) = delete;
+		
+		//! \brief Start the hardware counters
+		inline bool start()
+		{
+			Perf::ThreadLocal &threadLocal = Perf::getCurrentThreadHardwareCounters();
+			
+			_valid = threadLocal._valid && Perf::readCounters(threadLocal, _startValues);
+			_realStart = Perf::getRealNsecs();
+			
+			return _valid;
+		}
+		
+		//! \brief Get the current counter values, accumulate them to a set and restart counting from zero
+		inline bool accumulateAndRestart(int set = 0)
+		{
+			if (_valid) {
+				_valid = accumulate(set);
+			}
+			
+			return _valid;
+		}
+		
+		//! \brief Get the current counter values, accumulate them and stop the counters
+		inline bool accumulateAndStop(int set = 0)
+		{
+			if (_valid) {
+				bool result = accumulate(set);
+				_valid = false;
+				
+				return result;
+			} else {
+				return false;
+			}
+		}
+		
+		//! \brief Stop the counters
+		inline void stop(__attribute__((unused)) int set = 0)
+		{
+			_valid = false;
+		}
+	
+	
+	};
+
+};
+
+
+#endif // PERF_HARDWARE_COUNTERS_HPP
@@ -0,0 +1,29 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PERF_HARDWARE_COUNTERS_THREAD_LOCAL_DATA_HPP
+#define PERF_HARDWARE_COUNTERS_THREAD_LOCAL_DATA_HPP
+
+
+namespace HardwareCounters {
+	namespace Perf {
+		struct ThreadLocal;
+	}
+}
+
+
+typedef HardwareCounters::Perf::ThreadLocal HardwareCountersThreadLocalData;
+
+
+namespace HardwareCounters {
+	namespace Perf {
+		struct ThreadLocal;
+		inline HardwareCountersThreadLocalData &getCurrentThreadHardwareCounters();
+	}
+}
+
+
+#endif // PERF_HARDWARE_COUNTERS_THREAD_LOCAL_DATA_HPP
@@ -0,0 +1,36 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef PERF_HARDWARE_COUNTERS_THREAD_LOCAL_DATA_IMPLEMENTATION_HPP
+#define PERF_HARDWARE_COUNTERS_THREAD_LOCAL_DATA_IMPLEMENTATION_HPP
+
+
+
+#include "PerfHardwareCountersThreadLocalData.hpp"
+
+#include "PerfHardwareCounters.hpp"
+
+#include "executors/threads/WorkerThread.hpp"
+#include "executors/threads/WorkerThreadImplementation.hpp"
+
+
+namespace HardwareCounters {
+	namespace Perf {
+		inline HardwareCountersThreadLocalData &getCurrentThreadHardwareCounters()
+		{
+			WorkerThread *currentWorkerThread = WorkerThread::getCurrentWorkerThread();
+			if (currentWorkerThread != nullptr) {
+				return currentWorkerThread->getHardwareCounters();
+			} else {
+				static thread_local HardwareCountersThreadLocalData nonWorkerHardwareCounters;
+				return nonWorkerHardwareCounters;
+			}
+		}
+	}
+}
+
+
+#endif // PERF_HARDWARE_COUNTERS_THREAD_LOCAL_DATA_IMPLEMENTATION_HPP
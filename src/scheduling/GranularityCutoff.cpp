@@ -0,0 +1,43 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "GranularityCutoff.hpp"
+
+#include "executors/threads/CPUManager.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+#include "system/RuntimeInfo.hpp"
+
+#include <ClusterManager.hpp>
+
+
+bool GranularityCutoff::_enabled = false;
+long GranularityCutoff::_maxReadyTasks;
+uint64_t GranularityCutoff::_minDuration;
+std::atomic<long> GranularityCutoff::_readyTasks(0);
+std::atomic<size_t> GranularityCutoff::_inlinedByLoad(0);
+std::atomic<size_t> GranularityCutoff::_inlinedByDuration(0);
+GranularityCutoff::TaskTypeDuration GranularityCutoff::_durations[TaskTypeRegistry::max_task_types];
+
+
+void GranularityCutoff::initialize()
+{
+	EnvironmentVariable<bool> enabled("NANOS6_CUTOFF", true);
+	EnvironmentVariable<long> readyTasksPerCPU("NANOS6_CUTOFF_READY_TASKS", 64);
+	EnvironmentVariable<uint64_t> minDuration("NANOS6_CUTOFF_DURATION", 2000);
+	
+	// The tasks must be offloaded to the other nodes instead of being run inline
+	_enabled = enabled.getValue() && !ClusterManager::inClusterMode();
+	_maxReadyTasks = readyTasksPerCPU.getValue() * CPUManager::getTotalCPUs();
+	_minDuration = minDuration.getValue();
+	
+	RuntimeInfo::addEntry("cutoff", "Inline execution of tasks decided by the runtime", (_enabled ? "enabled" : "disabled"));
+	if (_enabled) {
+		RuntimeInfo::addEntry("cutoff_ready_tasks", "Ready tasks from which new tasks are run inline", _maxReadyTasks);
+		RuntimeInfo::addEntry("cutoff_duration", "Mean execution time under which tasks are run inline", (long) _minDuration, "ns");
+		RuntimeInfo::addCounterEntry("cutoff_inlined_by_load", "Tasks run inline because there were enough ready tasks", _inlinedByLoad);
+		RuntimeInfo::addCounterEntry("cutoff_inlined_by_duration", "Tasks run inline because their type is too short", _inlinedByDuration);
+	}
+}
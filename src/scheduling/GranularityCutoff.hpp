@@ -0,0 +1,141 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef GRANULARITY_CUTOFF_HPP
+#define GRANULARITY_CUTOFF_HPP
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <nanos6.h>
+
+#include "tasks/Task.hpp"
+#include "tasks/TaskTypeRegistry.hpp"
+
+
+//! \brief Decides when the runtime runs a ready task inline instead of queueing it
+//!
+//! A ready child is executed inline by its parent, as if it were an if0 task,
+//! when there are already enough ready tasks to keep all the CPUs busy, or
+//! when the tasks of its type are known to be too short to amortize the cost
+//! of scheduling them.
+class GranularityCutoff {
+	struct TaskTypeDuration {
+		//! \brief Exponentially weighted moving average of the execution time in nanoseconds
+		std::atomic<uint64_t> _mean;
+		std::atomic<size_t> _samples;
+	};
+	
+	enum cutoff_constants_t {
+		//! \brief Executions required before the mean of a task type is trusted
+		min_samples = 16,
+		
+		//! \brief Weight of the previous mean as a power of two
+		mean_weight_shift = 3
+	};
+	
+	static bool _enabled;
+	static long _maxReadyTasks;
+	static uint64_t _minDuration;
+	
+	//! \brief The ready tasks that have not been picked by any thread
+	//!
+	//! It may become negative temporarily, since a task can be picked before it is counted
+	static std::atomic<long> _readyTasks;
+	
+	static std::atomic<size_t> _inlinedByLoad;
+	static std::atomic<size_t> _inlinedByDuration;
+	
+	static TaskTypeDuration _durations[TaskTypeRegistry::max_task_types];
+	
+	static inline bool isShortTaskType(nanos6_task_info_t const *taskInfo)
+	{
+		size_t typeIndex = TaskTypeRegistry::getIndex(taskInfo);
+		if (typeIndex == TaskTypeRegistry::invalid_index) {
+			return false;
+		}
+		
+		TaskTypeDuration &duration = _durations[typeIndex];
+		return (duration._samples.load(std::memory_order_relaxed) >= min_samples)
+			&& (duration._mean.load(std::memory_order_relaxed) < _minDuration);
+	}
+
+public:
+	//! \brief Read the configuration, which must happen after the CPUs have been discovered
+	static void initialize();
+	
+	static inline bool isEnabled()
+	{
+		return _enabled;
+	}
+	
+	//! \brief Account for a task that has been added to the scheduler as ready
+	static inline void taskBecomesReady()
+	{
+		if (_enabled) {
+			_readyTasks.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	
+	//! \brief Account for a ready task that the scheduler has returned
+	static inline void readyTaskHasBeenPicked()
+	{
+		if (_enabled) {
+			_readyTasks.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+	
+	//! \brief Check if a ready child task must be run inline by its parent
+	//!
+	//! \param[in] task a host task that is ready, is not if0 and whose parent is running
+	static inline bool mustRunInline(Task *task)
+	{
+		if (!_enabled || task->isTaskloop() || !task->hasCode()) {
+			return false;
+		}
+		
+		nanos6_task_info_t const *taskInfo = task->getTaskInfo();
+		if (taskInfo->implementations[0].device_type_id != nanos6_host_device) {
+			return false;
+		}
+		
+		if (_readyTasks.load(std::memory_order_relaxed) >= _maxReadyTasks) {
+			_inlinedByLoad.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+		
+		if (isShortTaskType(taskInfo)) {
+			_inlinedByDuration.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+		
+		return false;
+	}
+	
+	//! \brief Update the mean execution time of the type of a task that has run
+	static inline void taskHasRun(Task *task, uint64_t duration)
+	{
+		size_t typeIndex = TaskTypeRegistry::getIndex(task->getTaskInfo());
+		if (typeIndex == TaskTypeRegistry::invalid_index) {
+			return;
+		}
+		
+		// Concurrent updates may lose a sample, which does not matter for an estimate
+		TaskTypeDuration &entry = _durations[typeIndex];
+		if (entry._samples.fetch_add(1, std::memory_order_relaxed) == 0) {
+			entry._mean.store(duration, std::memory_order_relaxed);
+		} else {
+			int64_t mean = entry._mean.load(std::memory_order_relaxed);
+			mean += ((int64_t) duration - mean) >> mean_weight_shift;
+			entry._mean.store(mean, std::memory_order_relaxed);
+		}
+	}
+};
+
+
+#endif // GRANULARITY_CUTOFF_HPP
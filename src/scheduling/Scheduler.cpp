@@ -21,6 +21,8 @@ void Scheduler::initialize()
 {
 	_scheduler = SchedulerGenerator::createHostScheduler();
 	RuntimeInfo::addEntry("scheduler", "Scheduler", _scheduler->getName());
+	
+	GranularityCutoff::initialize();
 }
 
 void Scheduler::shutdown() 
@@ -65,6 +67,11 @@ Task *Scheduler::getReadyTask(ComputePlace *computePlace, Task *currentTask, boo
 		}
 	}
 	
+	// Unblocked tasks already have a thread and are not accounted as ready
+	if ((task != nullptr) && (task->getThread() == nullptr) && !task->isTaskloop()) {
+		GranularityCutoff::readyTaskHasBeenPicked();
+	}
+	
 	return task;
 }
 
@@ -8,6 +8,7 @@
 #define SCHEDULER_HPP
 
 
+#include "GranularityCutoff.hpp"
 #include "SchedulerInterface.hpp"
 
 #include "hardware/places/ComputePlace.hpp"
@@ -69,6 +70,7 @@ public:
 			
 			return nullptr;
 		} else {
+			GranularityCutoff::taskBecomesReady();
 			return _scheduler->addReadyTask(task, computePlace, hint);
 		}
 	}
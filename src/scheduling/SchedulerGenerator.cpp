@@ -24,6 +24,11 @@
 #include "schedulers/cuda/CUDANaiveScheduler.hpp"
 #endif
 
+#if defined(USE_CLUSTER)
+#include "cluster/ClusterManager.hpp"
+#include "schedulers/cluster/ClusterScheduler.hpp"
+#endif
+
 #include "SchedulerGenerator.hpp"
 
 
@@ -81,6 +86,19 @@ SchedulerInterface *SchedulerGenerator::createCUDAScheduler(
 // Get the Host scheduler
 // This is the scheduler that is called through the Scheduler class. Therefor, this is the initializer
 SchedulerInterface *SchedulerGenerator::createHostScheduler()
+{
+#if defined(USE_CLUSTER)
+	if (ClusterManager::inClusterMode()) {
+		return new ClusterScheduler();
+	}
+#endif
+	
+	return createLocalHostScheduler();
+}
+
+
+// Get the scheduler of the tasks that run on this node
+SchedulerInterface *SchedulerGenerator::createLocalHostScheduler()
 {
 	EnvironmentVariable<std::string> schedulerName("NANOS6_SCHEDULER", "default");
 	
@@ -29,6 +29,9 @@ public:
 	// This is the scheduler that is called through the Scheduler class. Therefor, this is the initializer
 	static SchedulerInterface *createHostScheduler();
 	
+	// Get the scheduler of the tasks that run on this node
+	static SchedulerInterface *createLocalHostScheduler();
+	
 	// Get the scheduler for the NUMA nodes
 	static SchedulerInterface *createNUMAScheduler();
 	
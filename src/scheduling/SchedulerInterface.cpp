@@ -31,7 +31,8 @@ bool SchedulerInterface::requestPolling(ComputePlace *computePlace, polling_slot
 	assert(pollingSlot->_task == nullptr);
 	
 	// Default implementation: attempt to get a ready task and fail if not possible
-	Task *task = Scheduler::getReadyTask(computePlace);
+	// The task is accounted as picked once it is returned through the Scheduler
+	Task *task = getReadyTask(computePlace);
 	
 	if (task != nullptr) {
 		Task *expected = nullptr;
@@ -107,7 +107,7 @@ ComputePlace * FIFOImmediateSuccessorWithPollingScheduler::addReadyTask(Task *ta
 	
 	// Attempt to get a CPU to resume the task
 	if (doGetIdle) {
-		return CPUManager::getIdleCPU();
+		return CPUManager::getIdleCPU(computePlace);
 	} else {
 		return nullptr;
 	}
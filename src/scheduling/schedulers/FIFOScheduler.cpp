@@ -46,7 +46,7 @@ Task *FIFOScheduler::getReplacementTask(__attribute__((unused)) CPU *computePlac
 }
 
 
-ComputePlace * FIFOScheduler::addReadyTask(Task *task, __attribute__((unused)) ComputePlace *computePlace, __attribute__((unused)) ReadyTaskHint hint, bool doGetIdle)
+ComputePlace * FIFOScheduler::addReadyTask(Task *task, ComputePlace *computePlace, __attribute__((unused)) ReadyTaskHint hint, bool doGetIdle)
 {
 	FatalErrorHandler::failIf(task->getDeviceType() != nanos6_device_t::nanos6_host_device, "Device tasks not supported by this scheduler");
 	
@@ -59,7 +59,7 @@ ComputePlace * FIFOScheduler::addReadyTask(Task *task, __attribute__((unused)) C
 	}
 	
 	if (doGetIdle) {
-		return CPUManager::getIdleCPU();
+		return CPUManager::getIdleCPU(computePlace);
 	} else {
 		return nullptr;
 	}
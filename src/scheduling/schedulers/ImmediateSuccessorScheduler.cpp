@@ -64,7 +64,7 @@ ComputePlace * ImmediateSuccessorScheduler::addReadyTask(Task *task, ComputePlac
 	}
 	
 	if (doGetIdle) {
-		return CPUManager::getIdleCPU();
+		return CPUManager::getIdleCPU(computePlace);
 	} else {
 		return nullptr;
 	}
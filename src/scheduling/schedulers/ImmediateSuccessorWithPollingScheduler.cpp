@@ -106,7 +106,7 @@ ComputePlace * ImmediateSuccessorWithPollingScheduler::addReadyTask(Task *task,
 	
 	// Attempt to get a CPU to resume the task
 	if (doGetIdle) {
-		return CPUManager::getIdleCPU();
+		return CPUManager::getIdleCPU(computePlace);
 	} else {
 		return nullptr;
 	}
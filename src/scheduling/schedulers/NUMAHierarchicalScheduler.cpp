@@ -95,7 +95,7 @@ ComputePlace * NUMAHierarchicalScheduler::addReadyTask(Task *task, ComputePlace
 			cp = CPUManager::getIdleNUMANodeCPU(min_idx);
 			if (cp == nullptr) {
 				// If this NUMA node does not have any idle CPUs, get any other idle CPU
-				cp = CPUManager::getIdleCPU();
+				cp = CPUManager::getIdleCPU(computePlace);
 			}
 		
 			return cp;
@@ -46,7 +46,7 @@ Task *NaiveScheduler::getReplacementTask(__attribute__((unused)) CPU *computePla
 }
 
 
-ComputePlace * NaiveScheduler::addReadyTask(Task *task, __attribute__((unused)) ComputePlace *computePlace, ReadyTaskHint hint, bool doGetIdle)
+ComputePlace * NaiveScheduler::addReadyTask(Task *task, ComputePlace *computePlace, ReadyTaskHint hint, bool doGetIdle)
 {
 	FatalErrorHandler::failIf(task->getDeviceType() != nanos6_device_t::nanos6_host_device, "Device tasks not supported by this scheduler");
 	
@@ -58,7 +58,7 @@ ComputePlace * NaiveScheduler::addReadyTask(Task *task, __attribute__((unused))
 	}
 	
 	if (doGetIdle) {
-		return CPUManager::getIdleCPU();
+		return CPUManager::getIdleCPU(computePlace);
 	} else {
 		return nullptr;
 	}
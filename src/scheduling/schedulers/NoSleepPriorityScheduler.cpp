@@ -83,7 +83,7 @@ ComputePlace * NoSleepPriorityScheduler::addReadyTask(Task *task, ComputePlace *
 	
 	// Attempt to get a CPU to resume the task
 	if (doGetIdle) {
-		return CPUManager::getIdleCPU();
+		return CPUManager::getIdleCPU(computePlace);
 	} else {
 		return nullptr;
 	}
@@ -111,7 +111,7 @@ ComputePlace * PriorityScheduler1::addReadyTask(Task *task, ComputePlace *comput
 	
 	// Attempt to get a CPU to resume the task
 	if (doGetIdle) {
-		return CPUManager::getIdleCPU();
+		return CPUManager::getIdleCPU(computePlace);
 	} else {
 		return nullptr;
 	}
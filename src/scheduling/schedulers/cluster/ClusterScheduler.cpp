@@ -0,0 +1,128 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "ClusterScheduler.hpp"
+
+#include "cluster/ClusterManager.hpp"
+#include "cluster/ClusterMemoryManagement.hpp"
+#include "cluster/offloading/TaskOffloading.hpp"
+#include "scheduling/SchedulerGenerator.hpp"
+#include "system/RuntimeInfo.hpp"
+
+#include <ClusterNode.hpp>
+#include <DataAccessRegistration.hpp>
+
+#include <vector>
+
+
+ClusterScheduler::ClusterScheduler()
+	: _nextNode(0)
+{
+	_localScheduler = SchedulerGenerator::createLocalHostScheduler();
+	RuntimeInfo::addEntry("cluster-local-scheduler", "Cluster Local Scheduler", _localScheduler->getName());
+}
+
+ClusterScheduler::~ClusterScheduler()
+{
+	delete _localScheduler;
+}
+
+
+//! The node that is the home of most of the data of a task, or nullptr if it is not known
+static ClusterNode *getDataHomeNode(Task *task)
+{
+	std::vector<size_t> bytesPerNode(ClusterManager::clusterSize(), 0);
+	bool found = false;
+	
+	DataAccessRegistration::processAllDataAccesses(
+		task,
+		[&](DataAccessRegion const &region, __attribute__((unused)) DataAccessType type, __attribute__((unused)) bool weak) -> bool {
+			ClusterNode *homeNode = ClusterMemoryManagement::getHomeNode(region.getStartAddress());
+			if (homeNode != nullptr) {
+				bytesPerNode[homeNode->getIndex()] += region.getSize();
+				found = true;
+			}
+			return true;
+		}
+	);
+	
+	if (!found) {
+		return nullptr;
+	}
+	
+	size_t best = 0;
+	for (size_t i = 1; i < bytesPerNode.size(); ++i) {
+		if (bytesPerNode[i] > bytesPerNode[best]) {
+			best = i;
+		}
+	}
+	
+	return ClusterManager::getClusterNode(best);
+}
+
+
+ComputePlace *ClusterScheduler::addReadyTask(Task *task, ComputePlace *computePlace, ReadyTaskHint hint, bool doGetIdle)
+{
+	// Only the master node distributes tasks, and only those that have not started yet
+	if (ClusterManager::isMasterNode() && (hint != UNBLOCKED_TASK_HINT) && TaskOffloading::canBeOffloaded(task)) {
+		// Tasks go where their data lives, and the rest are spread evenly
+		ClusterNode *targetNode = getDataHomeNode(task);
+		if (targetNode == nullptr) {
+			targetNode = ClusterManager::getClusterNode(_nextNode++ % ClusterManager::clusterSize());
+		}
+		
+		if (targetNode != ClusterManager::getClusterNode()) {
+			TaskOffloading::offloadTask(task, targetNode);
+			return nullptr;
+		}
+	}
+	
+	return _localScheduler->addReadyTask(task, computePlace, hint, doGetIdle);
+}
+
+
+Task *ClusterScheduler::getReadyTask(ComputePlace *computePlace, Task *currentTask, bool canMarkAsIdle, bool doWait)
+{
+	return _localScheduler->getReadyTask(computePlace, currentTask, canMarkAsIdle, doWait);
+}
+
+
+bool ClusterScheduler::canWait()
+{
+	return _localScheduler->canWait();
+}
+
+
+ComputePlace *ClusterScheduler::getIdleComputePlace(bool force)
+{
+	return _localScheduler->getIdleComputePlace(force);
+}
+
+void ClusterScheduler::disableComputePlace(ComputePlace *computePlace)
+{
+	_localScheduler->disableComputePlace(computePlace);
+}
+
+void ClusterScheduler::enableComputePlace(ComputePlace *computePlace)
+{
+	_localScheduler->enableComputePlace(computePlace);
+}
+
+bool ClusterScheduler::requestPolling(ComputePlace *computePlace, polling_slot_t *pollingSlot)
+{
+	return _localScheduler->requestPolling(computePlace, pollingSlot);
+}
+
+bool ClusterScheduler::releasePolling(ComputePlace *computePlace, polling_slot_t *pollingSlot)
+{
+	return _localScheduler->releasePolling(computePlace, pollingSlot);
+}
+
+
+std::string ClusterScheduler::getName() const
+{
+	return "cluster";
+}
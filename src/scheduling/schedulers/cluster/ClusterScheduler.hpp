@@ -0,0 +1,52 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef CLUSTER_SCHEDULER_HPP
+#define CLUSTER_SCHEDULER_HPP
+
+#include "scheduling/SchedulerInterface.hpp"
+
+#include <atomic>
+
+
+class Task;
+
+
+//! \brief Scheduler that distributes the ready tasks among the cluster nodes
+//!
+//! The tasks that are not offloaded, and all the tasks of the nodes that are not the
+//! master, are handled by the scheduler of the local node.
+class ClusterScheduler: public SchedulerInterface {
+	SchedulerInterface *_localScheduler;
+	
+	//! Node that receives the next offloadable task
+	std::atomic<unsigned int> _nextNode;
+	
+public:
+	ClusterScheduler();
+	~ClusterScheduler();
+	
+	ComputePlace *addReadyTask(Task *task, ComputePlace *computePlace, ReadyTaskHint hint, bool doGetIdle = true);
+	
+	Task *getReadyTask(ComputePlace *computePlace, Task *currentTask = nullptr, bool canMarkAsIdle = true, bool doWait = false);
+	
+	bool canWait();
+	
+	ComputePlace *getIdleComputePlace(bool force=false);
+	
+	void disableComputePlace(ComputePlace *computePlace);
+	
+	void enableComputePlace(ComputePlace *computePlace);
+	
+	bool requestPolling(ComputePlace *computePlace, polling_slot_t *pollingSlot);
+	
+	bool releasePolling(ComputePlace *computePlace, polling_slot_t *pollingSlot);
+	
+	std::string getName() const;
+};
+
+
+#endif // CLUSTER_SCHEDULER_HPP
@@ -19,9 +19,11 @@
 #include "executors/threads/ThreadManager.hpp"
 #include "executors/threads/CPUManager.hpp"
 #include "lowlevel/EnvironmentVariable.hpp"
+#include "lowlevel/LockProfiling.hpp"
 #include "lowlevel/threads/ExternalThread.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/APICheck.hpp"
+#include "system/IOAPI.hpp"
 #include "system/RuntimeInfoEssentials.hpp"
 #include "system/ompss/SpawnFunction.hpp"
 #include "hardware/HardwareInfo.hpp"
@@ -132,8 +134,10 @@ void nanos6_shutdown(void) {
 	
 	LeaderThread::shutdown();
 	ThreadManager::shutdown();
+	IOAPI::shutdown();
 	
 	Instrument::shutdown();
+	LockProfiling::report();
 	delete mainThread;
 	
 	if (shutdownDueToSignalNumber.load() != 0) {
@@ -146,3 +150,13 @@ void nanos6_shutdown(void) {
 	RuntimeInfoEssentials::shutdown();
 }
 
+
+int nanos6_can_run_main(void) {
+	return ClusterManager::isMasterNode();
+}
+
+
+void nanos6_register_completion_callback(void (*completion_callback)(void *), void *completion_args) {
+	ClusterManager::setCompletionCallback(completion_callback, completion_args);
+}
+
@@ -0,0 +1,33 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/cluster.h>
+
+#include <ClusterMemoryManagement.hpp>
+
+
+extern "C" void *nanos6_dmalloc(size_t size, nanos6_data_distribution_t policy, size_t block_size)
+{
+	return ClusterMemoryManagement::dmalloc(size, policy, block_size);
+}
+
+
+extern "C" void nanos6_dfree(void *ptr, size_t size)
+{
+	ClusterMemoryManagement::dfree(ptr, size);
+}
+
+
+extern "C" void *nanos6_lmalloc(size_t size)
+{
+	return ClusterMemoryManagement::lmalloc(size);
+}
+
+
+extern "C" void nanos6_lfree(void *ptr, size_t size)
+{
+	ClusterMemoryManagement::lfree(ptr, size);
+}
@@ -0,0 +1,336 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <nanos6/events.h>
+#include <nanos6/io.h>
+#include <nanos6/polling.h>
+
+#include "IOAPI.hpp"
+#include "executors/threads/WorkerThread.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/SpinLock.hpp"
+#include "tasks/Task.hpp"
+
+#include <config.h>
+
+#if HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+
+namespace IOAPI {
+#if HAVE_IO_URING
+	//! \brief An operation submitted to the kernel on behalf of a task
+	struct IORequest {
+		Task *_task;
+		struct iovec _iovec;
+		ssize_t *_result;
+	};
+	
+	
+	//! \brief The submission and completion queues shared with the kernel
+	class IORing {
+		int _fd;
+		
+		//! \brief Signaled by the kernel when there are completions, which wakes up the leader thread
+		int _eventFd;
+		
+		void *_sqRing;
+		size_t _sqRingSize;
+		void *_cqRing;
+		size_t _cqRingSize;
+		struct io_uring_sqe *_sqes;
+		size_t _sqesSize;
+		
+		unsigned *_sqHead;
+		unsigned *_sqTail;
+		unsigned _sqMask;
+		unsigned *_sqArray;
+		unsigned _sqEntries;
+		
+		unsigned *_cqHead;
+		unsigned *_cqTail;
+		unsigned _cqMask;
+		struct io_uring_cqe *_cqes;
+		
+		//! \brief Requests that have not been reaped yet, which must fit in the completion queue
+		std::atomic<unsigned> _inFlight;
+		unsigned _maxInFlight;
+		
+		SpinLock _submissionLock;
+		
+		static inline int enter(int fd, unsigned toSubmit)
+		{
+			return syscall(__NR_io_uring_enter, fd, toSubmit, 0, 0, nullptr, 0);
+		}
+	
+	public:
+		IORing()
+			: _fd(-1), _eventFd(-1), _sqRing(MAP_FAILED), _cqRing(MAP_FAILED), _sqes((struct io_uring_sqe *) MAP_FAILED),
+			_inFlight(0)
+		{
+		}
+		
+		//! \brief Create the queues
+		//!
+		//! \returns false if the kernel does not allow it, for instance because of a seccomp filter
+		bool initialize(unsigned entries)
+		{
+			struct io_uring_params params;
+			memset(&params, 0, sizeof(params));
+			
+			_fd = syscall(__NR_io_uring_setup, entries, &params);
+			if (_fd == -1) {
+				return false;
+			}
+			
+			_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+			bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP);
+			if (singleMapping) {
+				_sqRingSize = std::max(_sqRingSize, _cqRingSize);
+				_cqRingSize = _sqRingSize;
+			}
+			
+			_sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+			FatalErrorHandler::failIf(_sqRing == MAP_FAILED, "Cannot map the submission queue of the asynchronous I/O");
+			
+			if (singleMapping) {
+				_cqRing = _sqRing;
+			} else {
+				_cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+				FatalErrorHandler::failIf(_cqRing == MAP_FAILED, "Cannot map the completion queue of the asynchronous I/O");
+			}
+			
+			_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+			_sqes = (struct io_uring_sqe *) mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+			FatalErrorHandler::failIf(_sqes == MAP_FAILED, "Cannot map the submission entries of the asynchronous I/O");
+			
+			char *sqRing = (char *) _sqRing;
+			_sqHead = (unsigned *) (sqRing + params.sq_off.head);
+			_sqTail = (unsigned *) (sqRing + params.sq_off.tail);
+			_sqMask = *(unsigned *) (sqRing + params.sq_off.ring_mask);
+			_sqArray = (unsigned *) (sqRing + params.sq_off.array);
+			_sqEntries = params.sq_entries;
+			
+			char *cqRing = (char *) _cqRing;
+			_cqHead = (unsigned *) (cqRing + params.cq_off.head);
+			_cqTail = (unsigned *) (cqRing + params.cq_off.tail);
+			_cqMask = *(unsigned *) (cqRing + params.cq_off.ring_mask);
+			_cqes = (struct io_uring_cqe *) (cqRing + params.cq_off.cqes);
+			_maxInFlight = params.cq_entries;
+			
+			_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			FatalErrorHandler::failIf(_eventFd == -1, "Cannot create the completion event of the asynchronous I/O");
+			
+			int rc = syscall(__NR_io_uring_register, _fd, IORING_REGISTER_EVENTFD, &_eventFd, 1);
+			FatalErrorHandler::handle((rc == -1) ? errno : 0, " when registering the completion event of the asynchronous I/O");
+			
+			nanos6_register_fd_polling_service("asynchronous I/O", &IORing::reapHelper, this, _eventFd);
+			
+			return true;
+		}
+		
+		void shutdown()
+		{
+			assert(_inFlight == 0);
+			
+			nanos6_unregister_polling_service("asynchronous I/O", &IORing::reapHelper, this);
+			
+			munmap(_sqes, _sqesSize);
+			if (_cqRing != _sqRing) {
+				munmap(_cqRing, _cqRingSize);
+			}
+			munmap(_sqRing, _sqRingSize);
+			close(_eventFd);
+			close(_fd);
+		}
+		
+		//! \brief Submit an operation on behalf of a task, whose dependencies are not released until it completes
+		//!
+		//! \returns false if the queues are full, and then the operation has not been submitted
+		bool submit(uint8_t opcode, int fd, void *buffer, size_t size, off_t offset, Task *task, ssize_t *result)
+		{
+			std::lock_guard<SpinLock> guard(_submissionLock);
+			
+			unsigned tail = *_sqTail;
+			unsigned head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+			if ((tail - head == _sqEntries) || (_inFlight == _maxInFlight)) {
+				return false;
+			}
+			
+			IORequest *request = new IORequest();
+			request->_task = task;
+			request->_iovec.iov_base = buffer;
+			request->_iovec.iov_len = size;
+			request->_result = result;
+			
+			unsigned index = tail & _sqMask;
+			struct io_uring_sqe *sqe = &_sqes[index];
+			memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = opcode;
+			sqe->fd = fd;
+			sqe->off = offset;
+			sqe->addr = (uint64_t) &request->_iovec;
+			sqe->len = 1;
+			sqe->user_data = (uint64_t) request;
+			_sqArray[index] = index;
+			
+			// The completion may arrive before returning from the system call
+			task->increaseReleaseCount();
+			_inFlight++;
+			
+			__atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+			
+			int rc;
+			do {
+				rc = enter(_fd, 1);
+			} while ((rc == -1) && ((errno == EINTR) || (errno == EAGAIN)));
+			FatalErrorHandler::handle((rc == -1) ? errno : 0, " when submitting an asynchronous I/O operation");
+			
+			return true;
+		}
+		
+		//! \brief Complete the operations that have finished
+		bool reap()
+		{
+			uint64_t events;
+			__attribute__((unused)) ssize_t rc = read(_eventFd, &events, sizeof(events));
+			
+			unsigned head = *_cqHead;
+			unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+			
+			while (head != tail) {
+				struct io_uring_cqe *cqe = &_cqes[head & _cqMask];
+				IORequest *request = (IORequest *) cqe->user_data;
+				int result = cqe->res;
+				
+				head++;
+				__atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+				_inFlight--;
+				
+				if (request->_result != nullptr) {
+					*request->_result = result;
+				}
+				nanos6_decrease_task_event_counter(request->_task, 1);
+				delete request;
+				
+				tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+			}
+			
+			return false;
+		}
+		
+		static int reapHelper(void *ring)
+		{
+			return ((IORing *) ring)->reap();
+		}
+	};
+	
+	
+	enum ring_state_t {
+		UNINITIALIZED_RING = 0,
+		AVAILABLE_RING,
+		UNAVAILABLE_RING
+	};
+	
+	//! \brief The queues are created when the first operation is issued
+	std::atomic<int> _ringState(UNINITIALIZED_RING);
+	SpinLock _ringInitializationLock;
+	IORing _ring;
+	
+	EnvironmentVariable<unsigned> _queueDepth("NANOS6_IO_QUEUE_DEPTH", 256);
+	
+	
+	inline bool ringIsAvailable()
+	{
+		int state = _ringState.load(std::memory_order_acquire);
+		if (state == UNINITIALIZED_RING) {
+			std::lock_guard<SpinLock> guard(_ringInitializationLock);
+			
+			state = _ringState.load(std::memory_order_relaxed);
+			if (state == UNINITIALIZED_RING) {
+				state = (_ring.initialize(_queueDepth) ? AVAILABLE_RING : UNAVAILABLE_RING);
+				_ringState.store(state, std::memory_order_release);
+			}
+		}
+		
+		return (state == AVAILABLE_RING);
+	}
+	
+	
+	//! \brief Submit an operation if it is issued from a task and the queues accept it
+	inline bool submit(uint8_t opcode, int fd, void *buffer, size_t size, off_t offset, ssize_t *result)
+	{
+		WorkerThread *currentThread = WorkerThread::getCurrentWorkerThread();
+		if ((currentThread == nullptr) || (currentThread->getTask() == nullptr)) {
+			return false;
+		}
+		
+		if (!ringIsAvailable()) {
+			return false;
+		}
+		
+		return _ring.submit(opcode, fd, buffer, size, offset, currentThread->getTask(), result);
+	}
+#endif
+}
+
+
+void IOAPI::shutdown()
+{
+#if HAVE_IO_URING
+	if (_ringState.load() == AVAILABLE_RING) {
+		_ring.shutdown();
+		_ringState.store(UNINITIALIZED_RING);
+	}
+#endif
+}
+
+
+extern "C" void nanos6_io_read(int fd, void *buffer, size_t size, off_t offset, ssize_t *result)
+{
+#if HAVE_IO_URING
+	if (IOAPI::submit(IORING_OP_READV, fd, buffer, size, offset, result)) {
+		return;
+	}
+#endif
+
+	ssize_t rc = pread(fd, buffer, size, offset);
+	if (result != nullptr) {
+		*result = (rc == -1) ? -errno : rc;
+	}
+}
+
+
+extern "C" void nanos6_io_write(int fd, void const *buffer, size_t size, off_t offset, ssize_t *result)
+{
+#if HAVE_IO_URING
+	if (IOAPI::submit(IORING_OP_WRITEV, fd, const_cast<void *>(buffer), size, offset, result)) {
+		return;
+	}
+#endif
+
+	ssize_t rc = pwrite(fd, buffer, size, offset);
+	if (result != nullptr) {
+		*result = (rc == -1) ? -errno : rc;
+	}
+}
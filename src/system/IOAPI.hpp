@@ -0,0 +1,19 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef IO_API_HPP
+#define IO_API_HPP
+
+
+namespace IOAPI {
+	//! \brief Release the queues of the asynchronous I/O, if they have been created
+	//!
+	//! All the requests must have completed, which is the case once all the tasks have finished
+	void shutdown();
+}
+
+
+#endif // IO_API_HPP
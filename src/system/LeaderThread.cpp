@@ -5,10 +5,7 @@
 */
 
 #include <cassert>
-#include <ctime>
-#include <iostream>
-
-#include <time.h>
+#include <cstdint>
 
 #include "LeaderThread.hpp"
 #include "PollingAPI.hpp"
@@ -39,6 +36,7 @@ void LeaderThread::shutdown()
 	bool expected = false;
 	_singleton->_mustExit.compare_exchange_strong(expected, true);
 	assert(!expected);
+	PollingAPI::wakeUp();
 	
 	_singleton->join();
 	
@@ -58,16 +56,13 @@ void LeaderThread::body()
 	initializeHelperThread();
 	
 	while (!std::atomic_load_explicit(&_mustExit, std::memory_order_relaxed)) {
-		struct timespec delay = { 0, 1000000}; // 1000 Hz
+		uint64_t deadline = PollingAPI::handleDueServices();
 		
-		// The loop repeats the call with the remaining time in the event that the thread received a signal with a handler that has SA_RESTART set
+		// Sleep until a service is due or has an event, or the thread must exit
 		Instrument::threadWillSuspend(getInstrumentationId());
-		while (nanosleep(&delay, &delay)) {
-		}
+		PollingAPI::waitForServices(deadline);
 		Instrument::threadHasResumed(getInstrumentationId());
 		
-		PollingAPI::handleServices();
-		
 		Instrument::leaderThreadSpin();
 	}
 	
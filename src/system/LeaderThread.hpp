@@ -29,6 +29,9 @@ public:
 	}
 	
 	//! \brief A loop that takes care of maintenance duties
+	//!
+	//! It calls the polling services when they are due or their file
+	//! descriptors have events, and sleeps in between
 	void body();
 	
 	static bool isExiting()
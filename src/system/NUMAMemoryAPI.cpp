@@ -0,0 +1,34 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6/numa.h>
+
+#include "hardware/HardwareInfo.hpp"
+#include "memory/numa/NUMAMemoryManagement.hpp"
+
+
+extern "C" void *nanos6_numa_alloc(size_t size, nanos6_numa_policy_t policy, size_t node, size_t block_size)
+{
+	return NUMAMemoryManagement::alloc(size, policy, node, block_size);
+}
+
+
+extern "C" void nanos6_numa_free(void *ptr)
+{
+	NUMAMemoryManagement::free(ptr);
+}
+
+
+extern "C" int nanos6_numa_get_home_node(void const *address)
+{
+	return NUMAMemoryManagement::getHomeNode(address);
+}
+
+
+extern "C" unsigned int nanos6_numa_get_node_count(void)
+{
+	return HardwareInfo::getMemoryPlaceCount(nanos6_device_t::nanos6_host_device);
+}
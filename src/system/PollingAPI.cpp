@@ -4,215 +4,491 @@
 	Copyright (C) 2015-2017 Barcelona Supercomputing Center (BSC)
 */
 
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
 
 #include <nanos6/polling.h>
 
 #include "PollingAPI.hpp"
-#include "lowlevel/PaddedSpinLock.hpp"
+#include "lowlevel/EnvironmentVariable.hpp"
+#include "lowlevel/FatalErrorHandler.hpp"
+#include "lowlevel/SpinLock.hpp"
 #include "system/RuntimeInfo.hpp"
 
 
 namespace PollingAPI {
-	typedef PaddedSpinLock<128> lock_t;
+	//! \brief The lifecycle of the slot of a service
+	enum service_state_t {
+		//! \brief The slot can be taken by a new registration
+		FREE_SERVICE = 0,
+		//! \brief The slot is being filled by a registration
+		REGISTERING_SERVICE,
+		//! \brief The service can be called
+		ACTIVE_SERVICE,
+		//! \brief The service is being called
+		RUNNING_SERVICE,
+		//! \brief The service is being called and it has been asked to unregister
+		RUNNING_UNREGISTERING_SERVICE,
+		//! \brief The last call of the service has finished and its unregistration can complete
+		UNREGISTERED_SERVICE
+	};
 	
 	
-	//! \brief the parameters of the nanos6_register_polling_service function
-	struct ServiceKey {
-		std::string _name;
+	//! \brief A registered service
+	struct ServiceSlot {
+		std::atomic<int> _state;
+		
 		nanos6_polling_service_t _function;
 		void *_functionData;
 		
-		ServiceKey(char const *name, nanos6_polling_service_t function, void *functionData)
-			: _name(name), _function(function), _functionData(functionData)
-		{
-		}
+		//! \brief File descriptor whose events trigger the service, or -1
+		int _fd;
 		
-		ServiceKey(ServiceKey &&other)
-			: _name(std::move(other._name)), _function(other._function), _functionData(other._functionData)
+		//! \brief Minimum time between calls in nanoseconds, or 0 to call it whenever possible
+		uint64_t _period;
+		
+		//! \brief Time of the next call of a periodic service
+		std::atomic<uint64_t> _nextRun;
+		
+		ServiceSlot()
+			: _state(FREE_SERVICE), _function(nullptr), _functionData(nullptr), _fd(-1), _period(0), _nextRun(0)
 		{
 		}
 	};
 	
 	
-	//! \brief the status of a service
-	struct ServiceData {
-		//! \brief Indicates whether the service is being processed at that moment
-		bool _processing;
+	enum {
+		SLOTS_PER_CHUNK = 64,
+		MAX_CHUNKS = 1024
+	};
+		
+		
+	//! \brief The slots are allocated in chunks that never move, so that they can be traversed without locking
+	std::atomic<ServiceSlot *> _chunks[MAX_CHUNKS];
+	
+	//! \brief Number of slots that have ever been used, which bounds the traversals
+	std::atomic<size_t> _usedSlots(0);
+	
+	//! \brief This is held during the registrations and the unregistrations but not while processing a service
+	SpinLock _registrationLock;
+	
+	//! \brief Number of services that are neither periodic nor triggered by a file descriptor
+	std::atomic<size_t> _plainServices(0);
+	
+	//! \brief Period in microseconds at which the leader thread calls the services that are neither periodic nor triggered by a file descriptor
+	EnvironmentVariable<uint64_t> _plainServicesPeriod("NANOS6_POLLING_PERIOD", 1000);
+	
+	//! \brief Time of the next call of the services that are neither periodic nor triggered by a file descriptor by the leader thread
+	uint64_t _nextPlainRun = 0;
+	
+	
+	//! \brief The file descriptors that the leader thread waits on
+	struct EventSources {
+		//! \brief Values of the epoll data that do not correspond to a slot
+		enum {
+			TIMER_EVENT = ~0U,
+			WAKE_UP_EVENT = ~1U
+		};
+		
+		int _epoll;
+		int _timer;
+		int _wakeUp;
 		
-		//! \brief A pointer to an area that is set when the service has been marked for removal and that will be set to true once the service has been unregistered
-		std::atomic<bool> *_discard;
+		EventSources()
+		{
+			_epoll = epoll_create1(EPOLL_CLOEXEC);
+			FatalErrorHandler::failIf(_epoll == -1, "Cannot create the epoll instance of the polling services");
+			
+			_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+			FatalErrorHandler::failIf(_timer == -1, "Cannot create the timer of the polling services");
+			
+			_wakeUp = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			FatalErrorHandler::failIf(_wakeUp == -1, "Cannot create the wake up event of the polling services");
+			
+			add(_timer, TIMER_EVENT);
+			add(_wakeUp, WAKE_UP_EVENT);
+		}
+		
+		~EventSources()
+		{
+			close(_wakeUp);
+			close(_timer);
+			close(_epoll);
+		}
+		
+		void add(int fd, uint32_t data)
+		{
+			struct epoll_event event;
+			event.events = EPOLLIN;
+			event.data.u64 = data;
+			
+			if (epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+				FatalErrorHandler::handle(errno, " when adding a file descriptor to the polling services");
+			}
+		}
 		
-		ServiceData()
-			: _processing(false), _discard(nullptr)
+		void remove(int fd)
 		{
+			// The descriptor may have already been closed, which removes it too
+			epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
 		}
 	};
 	
+	EventSources _eventSources;
+	
+	//! \brief Slots of the services whose file descriptors have events, which only the leader thread accesses
+	std::vector<uint32_t> _readySlots;
 	
-	// Container type for the services
-	typedef std::map<ServiceKey, ServiceData> services_t;
+	//! \brief The service that the current thread is calling, so that it can unregister itself
+	thread_local ServiceSlot *_currentSlot = nullptr;
+	
+	
+	inline uint64_t getCurrentTime()
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ((uint64_t) ts.tv_sec) * 1000000000UL + ts.tv_nsec;
+	}
 	
 	
-	//! \brief This is held during traversal and modification operations but not while processing a service
-	lock_t _lock;
+	inline ServiceSlot &getSlot(size_t index)
+	{
+		ServiceSlot *chunk = _chunks[index / SLOTS_PER_CHUNK].load(std::memory_order_acquire);
+		assert(chunk != nullptr);
+		
+		return chunk[index % SLOTS_PER_CHUNK];
+	}
+		
 	
-	//! \brief Services in the system
-	services_t _services;
+	inline bool isPlain(ServiceSlot const &slot)
+	{
+		return (slot._fd == -1) && (slot._period == 0);
+	}
+		
 	
+	//! \brief Undo the bookkeeping of a service before its slot is freed
+	inline void retire(ServiceSlot const &slot)
+	{
+		if (isPlain(slot)) {
+			_plainServices--;
+		}
+		if (slot._fd != -1) {
+			_eventSources.remove(slot._fd);
+		}
+	}
+		
 	
-	inline bool operator<(ServiceKey const &a, ServiceKey const &b)
+	//! \brief Call a service if no other thread is calling it and update its state
+	void runService(ServiceSlot &slot, uint64_t currentTime)
 	{
-		if (a._function < b._function) {
-			return true;
-		} else if (a._function > b._function) {
-			return false;
+		int expected = ACTIVE_SERVICE;
+		if (!slot._state.compare_exchange_strong(expected, RUNNING_SERVICE, std::memory_order_acquire)) {
+			return;
 		}
 		
-		if (a._functionData < b._functionData) {
-			return true;
-		} else if (a._functionData > b._functionData) {
-			return false;
+		if (slot._period != 0) {
+			slot._nextRun.store(currentTime + slot._period, std::memory_order_relaxed);
 		}
 		
-#if 0
-		if (a._name < b._name) {
-			return true;
-		} else if (a._name > b._name) {
-			return false;
+		_currentSlot = &slot;
+		bool unregister = slot._function(slot._functionData);
+		_currentSlot = nullptr;
+		
+		expected = RUNNING_SERVICE;
+		if (slot._state.compare_exchange_strong(expected, (unregister ? UNREGISTERED_SERVICE : ACTIVE_SERVICE), std::memory_order_release)) {
+			if (unregister) {
+				retire(slot);
+				slot._state.store(FREE_SERVICE, std::memory_order_release);
+			}
+			return;
 		}
-#endif
 		
-		return false; // Equal
+		// An unregistration is waiting for this call to finish, and it completes the removal
+		assert(expected == RUNNING_UNREGISTERING_SERVICE);
+		slot._state.store(UNREGISTERED_SERVICE, std::memory_order_release);
+		
+		// Unless the service has unregistered itself
+		if (slot._function == nullptr) {
+			retire(slot);
+			slot._state.store(FREE_SERVICE, std::memory_order_release);
+		}
 	}
-}
-
-
-using namespace PollingAPI;
-
-
-extern "C" void nanos6_register_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data)
-{
-	std::lock_guard<PollingAPI::lock_t> guard(PollingAPI::_lock);
-	
-	static std::map<nanos6_polling_service_t, std::string> uniqueRegisteredServices;
 	
-	auto result = PollingAPI::_services.emplace(
-		ServiceKey(service_name, service_function, service_data),
-		ServiceData()
-	);
 	
-	if (!result.second) {
-		// The node was already added
-		ServiceData &serviceData = result.first->second;
+	void registerService(char const *name, nanos6_polling_service_t function, void *functionData, int fd, uint64_t period)
+	{
+		std::lock_guard<SpinLock> guard(_registrationLock);
+		
+		static std::map<nanos6_polling_service_t, std::string> uniqueRegisteredServices;
+		
+		size_t usedSlots = _usedSlots.load(std::memory_order_relaxed);
+		size_t index = usedSlots;
+		for (size_t candidate = 0; candidate < usedSlots; candidate++) {
+			ServiceSlot &slot = getSlot(candidate);
+			int state = slot._state.load(std::memory_order_acquire);
+			
+			if (state == FREE_SERVICE) {
+				if (index == usedSlots) {
+					index = candidate;
+				}
+			} else {
+				assert(((state == UNREGISTERED_SERVICE) || (slot._function != function) || (slot._functionData != functionData))
+					&& "Attempt to register a polling service twice");
+			}
+		}
+		
+		if (index == usedSlots) {
+			size_t chunk = index / SLOTS_PER_CHUNK;
+			FatalErrorHandler::failIf(chunk >= MAX_CHUNKS, "Too many polling services");
+			
+			if (_chunks[chunk].load(std::memory_order_relaxed) == nullptr) {
+				_chunks[chunk].store(new ServiceSlot[SLOTS_PER_CHUNK], std::memory_order_release);
+			}
+		}
+		
+		ServiceSlot &slot = getSlot(index);
+		slot._state.store(REGISTERING_SERVICE, std::memory_order_relaxed);
+		slot._function = function;
+		slot._functionData = functionData;
+		slot._fd = fd;
+		slot._period = period;
+		slot._nextRun.store(0, std::memory_order_relaxed);
 		
-		// So it must have been marked as discarded
-		assert(serviceData._discard != nullptr);
+		if (index == usedSlots) {
+			_usedSlots.store(usedSlots + 1, std::memory_order_release);
+		}
+		
+		if (fd != -1) {
+			_eventSources.add(fd, index);
+		} else if (period == 0) {
+			_plainServices++;
+		}
 		
-		// Remove the mark
-		serviceData._discard = nullptr;
-	} else {
-		auto it = uniqueRegisteredServices.find(service_function);
+		slot._state.store(ACTIVE_SERVICE, std::memory_order_release);
+		
+		auto it = uniqueRegisteredServices.find(function);
 		if (it == uniqueRegisteredServices.end()) {
-			uniqueRegisteredServices[service_function] = service_name;
+			uniqueRegisteredServices[function] = name;
 			std::ostringstream oss, oss2;
 			oss << "registered_service_" << uniqueRegisteredServices.size();
 			oss2 << "Registered Service " << uniqueRegisteredServices.size();
 			
-			RuntimeInfo::addEntry(oss.str(), oss2.str(), service_name);
+			RuntimeInfo::addEntry(oss.str(), oss2.str(), name);
 		}
 	}
 }
 
 
-extern "C" void nanos6_unregister_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data)
+using namespace PollingAPI;
+
+
+extern "C" void nanos6_register_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data)
+{
+	PollingAPI::registerService(service_name, service_function, service_data, -1, 0);
+	
+	// The leader thread may have to start calling the service
+	PollingAPI::wakeUp();
+}
+	
+
+extern "C" void nanos6_register_periodic_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data, unsigned long period)
+{
+	PollingAPI::registerService(service_name, service_function, service_data, -1, ((uint64_t) period) * 1000);
+	PollingAPI::wakeUp();
+}
+
+
+extern "C" void nanos6_register_fd_polling_service(char const *service_name, nanos6_polling_service_t service_function, void *service_data, int fd)
 {
-	std::atomic<bool> unregistered(false);
+	FatalErrorHandler::failIf(fd < 0, "Invalid file descriptor passed to nanos6_register_fd_polling_service for service ", service_name);
 	
-	ServiceKey key(service_name, service_function, service_data);
+	PollingAPI::registerService(service_name, service_function, service_data, fd, 0);
+}
+
+
+extern "C" void nanos6_unregister_polling_service(__attribute__((unused)) char const *service_name, nanos6_polling_service_t service_function, void *service_data)
+{
+	ServiceSlot *slot = nullptr;
 	
 	{
-		std::lock_guard<PollingAPI::lock_t> guard(PollingAPI::_lock);
-		auto it = PollingAPI::_services.find(key);
+		std::lock_guard<SpinLock> guard(_registrationLock);
 		
-		assert((it != PollingAPI::_services.end()) && "Attempt to unregister a non-existing polling service");
-		ServiceData &serviceData = it->second;
+		size_t usedSlots = _usedSlots.load(std::memory_order_relaxed);
+		for (size_t index = 0; index < usedSlots; index++) {
+			ServiceSlot &candidate = getSlot(index);
+			int state = candidate._state.load(std::memory_order_acquire);
+			
+			if ((state != FREE_SERVICE) && (state != UNREGISTERED_SERVICE)
+				&& (candidate._function == service_function) && (candidate._functionData == service_data)
+			) {
+				slot = &candidate;
+				break;
+			}
+		}
+		
+		assert((slot != nullptr) && "Attempt to unregister a non-existing polling service");
 		
-		assert((serviceData._discard == nullptr) && "Attempt to unregister an already unregistered polling service");
+		// A service that is not running is removed right away
+		int expected = ACTIVE_SERVICE;
+		while (!slot->_state.compare_exchange_strong(expected, UNREGISTERED_SERVICE, std::memory_order_acquire)) {
+			assert(expected == RUNNING_SERVICE);
+			if (slot->_state.compare_exchange_strong(expected, RUNNING_UNREGISTERING_SERVICE, std::memory_order_acquire)) {
+				break;
+			}
+			assert(expected == ACTIVE_SERVICE);
+		}
 		
-		// Set up unregistering protocol
-		serviceData._discard = &unregistered;
+		// The service is unregistering itself, so its call completes the removal when it returns
+		if (slot == _currentSlot) {
+			slot->_function = nullptr;
+			return;
+		}
 	}
 	
-	// Wait until fully unregistered
-	while (unregistered.load() == false) {
-		// Try to speed up the unregistration
-		PollingAPI::handleServices();
+	// Wait until its current call has finished, without blocking the rest of the services
+	while (slot->_state.load(std::memory_order_acquire) != UNREGISTERED_SERVICE) {
 	}
+	
+	retire(*slot);
+	slot->_state.store(FREE_SERVICE, std::memory_order_release);
 }
 
 
 void PollingAPI::handleServices()
 {
-	bool locked = PollingAPI::_lock.tryLock();
-	if (!locked) {
-		return;
-	}
+	size_t usedSlots = _usedSlots.load(std::memory_order_acquire);
+	uint64_t currentTime = 0;
 	
-	auto it = _services.begin();
-	while (it != _services.end()) {
-		ServiceKey const &serviceKey = it->first;
-		ServiceData &serviceData = it->second;
+	for (size_t index = 0; index < usedSlots; index++) {
+		ServiceSlot &slot = getSlot(index);
+		if (slot._state.load(std::memory_order_acquire) != ACTIVE_SERVICE) {
+			continue;
+		}
 		
-		if (serviceData._processing) {
-			// Somebody else processing it?
-			it++;
+		// The leader thread calls the services that wait for their file descriptors
+		if (slot._fd != -1) {
 			continue;
 		}
 		
-		if (serviceData._discard != nullptr) {
-			if (serviceData._discard != nullptr) {
-				// Signal the unregistration
-				serviceData._discard->store(true);
+		if (slot._period != 0) {
+			if (currentTime == 0) {
+				currentTime = getCurrentTime();
 			}
-			
-			it = _services.erase(it);
+			if (currentTime < slot._nextRun.load(std::memory_order_relaxed)) {
+				continue;
+			}
+		}
+		
+		runService(slot, currentTime);
+	}
+}
+
+
+uint64_t PollingAPI::handleDueServices()
+{
+	size_t usedSlots = _usedSlots.load(std::memory_order_acquire);
+	
+	// The services whose file descriptors have events
+	for (uint32_t index : _readySlots) {
+		if (index >= usedSlots) {
 			continue;
 		}
 		
-		// Set the processing flag
-		assert(!serviceData._processing);
-		serviceData._processing = true;
+		ServiceSlot &slot = getSlot(index);
+		if ((slot._state.load(std::memory_order_acquire) == ACTIVE_SERVICE) && (slot._fd != -1)) {
+			runService(slot, 0);
+		}
+	}
+	_readySlots.clear();
+	
+	uint64_t currentTime = getCurrentTime();
+	bool runPlain = (_plainServices > 0) && (currentTime >= _nextPlainRun);
+	uint64_t deadline = 0;
+	
+	for (size_t index = 0; index < usedSlots; index++) {
+		ServiceSlot &slot = getSlot(index);
+		if ((slot._state.load(std::memory_order_acquire) != ACTIVE_SERVICE) || (slot._fd != -1)) {
+			continue;
+		}
 		
-		// Execute the callback without locking
-		PollingAPI::_lock.unlock();
-		bool unregister = serviceKey._function(serviceKey._functionData);
-		PollingAPI::_lock.lock();
+		if (slot._period == 0) {
+			if (runPlain) {
+				runService(slot, currentTime);
+			}
+			continue;
+		}
 		
-		// Unset the processing flag
-		assert(serviceData._processing);
-		serviceData._processing = false;
+		uint64_t nextRun = slot._nextRun.load(std::memory_order_relaxed);
+		if (currentTime >= nextRun) {
+			runService(slot, currentTime);
+			nextRun = currentTime + slot._period;
+		}
 		
-		// By construction, even in the presence of concurrent calls to this method, the iterator remains valid
+		if ((deadline == 0) || (nextRun < deadline)) {
+			deadline = nextRun;
+		}
+	}
+	
+	if (runPlain) {
+		_nextPlainRun = currentTime + _plainServicesPeriod.getValue() * 1000;
+	}
+	if ((_plainServices > 0) && ((deadline == 0) || (_nextPlainRun < deadline))) {
+		deadline = _nextPlainRun;
+	}
+	
+	return deadline;
+}
+
+
+void PollingAPI::waitForServices(uint64_t deadline)
+{
+	// An absolute expiration time of zero disarms the timer
+	struct itimerspec expiration = {};
+	expiration.it_value.tv_sec = deadline / 1000000000UL;
+	expiration.it_value.tv_nsec = deadline % 1000000000UL;
+	timerfd_settime(_eventSources._timer, TFD_TIMER_ABSTIME, &expiration, nullptr);
+	
+	struct epoll_event events[16];
+	int count;
+	do {
+		count = epoll_wait(_eventSources._epoll, events, 16, -1);
+	} while ((count == -1) && (errno == EINTR));
+	
+	FatalErrorHandler::handle((count == -1) ? errno : 0, " when waiting for the polling services");
+	
+	for (int i = 0; i < count; i++) {
+		uint32_t data = (uint32_t) events[i].data.u64;
 		
-		// If the function returns true or the service had been marked for unregistration, remove the service
-		if (unregister || (serviceData._discard != nullptr)) {
-			
-			if (serviceData._discard != nullptr) {
-				// Signal the unregistration
-				serviceData._discard->store(true);
-			}
-			
-			it = _services.erase(it);
+		if ((data == EventSources::TIMER_EVENT) || (data == EventSources::WAKE_UP_EVENT)) {
+			// Consume the event, since the descriptors are level triggered
+			uint64_t value;
+			__attribute__((unused)) ssize_t rc = read(
+				(data == EventSources::TIMER_EVENT) ? _eventSources._timer : _eventSources._wakeUp,
+				&value, sizeof(value)
+			);
 		} else {
-			it++;
+			_readySlots.push_back(data);
 		}
 	}
-	
-	PollingAPI::_lock.unlock();
 }
 
+
+void PollingAPI::wakeUp()
+{
+	uint64_t value = 1;
+	__attribute__((unused)) ssize_t rc = write(_eventSources._wakeUp, &value, sizeof(value));
+}
+	
\ No newline at end of file
@@ -8,9 +8,27 @@
 #define POLLING_API_HPP
 
 
+#include <cstdint>
+
+
 namespace PollingAPI {
-	//! \brief Process the current list of services once
+	//! \brief Process the services once, skipping the ones that are not due and the ones triggered by file descriptors
+	//!
+	//! It does not block, so idle workers can call it repeatedly
 	void handleServices();
+	
+	//! \brief Process the services that are due and the ones whose file descriptors have events
+	//!
+	//! \returns the time of CLOCK_MONOTONIC in nanoseconds when the next service is due, or 0 if none is
+	uint64_t handleDueServices();
+	
+	//! \brief Block until a given time or until a file descriptor of a service has an event
+	//!
+	//! \param[in] deadline the time returned by handleDueServices
+	void waitForServices(uint64_t deadline);
+	
+	//! \brief Make waitForServices return right away
+	void wakeUp();
 }
 
 
@@ -10,4 +10,5 @@
 
 SpinLock RuntimeInfo::_lock;
 std::vector<nanos6_runtime_info_entry_t> RuntimeInfo::_contents;
+std::vector<std::atomic<size_t> const *> RuntimeInfo::_counters;
 
@@ -8,6 +8,7 @@
 #define RUNTIME_INFO_HPP
 
 
+#include <atomic>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -27,6 +28,9 @@ private:
 	static SpinLock _lock;
 	static std::vector<nanos6_runtime_info_entry_t> _contents;
 	
+	//! \brief The counter that backs each entry, or null if its value does not change
+	static std::vector<std::atomic<size_t> const *> _counters;
+	
 	template <typename T, bool INT_CONVERTIBLE, bool DOUBLE_CONVERTIBLE, bool STRING_CONVERTIBLE, bool INTEGER, bool DOUBLE, bool C_STRING>
 	struct EntryValueSetter {
 		static void setEntryValue(nanos6_runtime_info_entry_t &entry, T const &value);
@@ -94,6 +98,7 @@ public:
 		_lock.lock();
 		
 		_contents.emplace_back();
+		_counters.push_back(nullptr);
 		nanos6_runtime_info_entry_t &entry = _contents.back();
 		
 		entry.name = strdup(name.c_str());
@@ -136,6 +141,19 @@ public:
 	}
 	
 	
+	//! \brief Add an entry whose value is read from a counter each time it is queried
+	//!
+	//! The counter must outlive the runtime
+	static void addCounterEntry(std::string const &name, std::string const &description, std::atomic<size_t> const &counter, std::string const &units = "")
+	{
+		addEntry(name, description, (size_t) 0, units);
+		
+		_lock.lock();
+		_counters.back() = &counter;
+		_lock.unlock();
+	}
+	
+	
 	static size_t size()
 	{
 		_lock.lock();
@@ -150,6 +168,9 @@ public:
 	{
 		_lock.lock();
 		*entry = _contents[index];
+		if (_counters[index] != nullptr) {
+			entry->integer = _counters[index]->load(std::memory_order_relaxed);
+		}
 		_lock.unlock();
 	}
 };
@@ -15,6 +15,7 @@
 #include "hardware/places/ComputePlace.hpp"
 #include "lowlevel/FatalErrorHandler.hpp"
 #include "MemoryAllocator.hpp"
+#include "scheduling/GranularityCutoff.hpp"
 #include "scheduling/Scheduler.hpp"
 #include "system/If0Task.hpp"
 #include "tasks/Task.hpp"
@@ -87,8 +88,8 @@ void nanos6_submit_task(void *taskHandle)
 	WorkerThread *currentWorkerThread = WorkerThread::getCurrentWorkerThread();
 	ComputePlace *computePlace = nullptr;
 	
-	if (currentWorkerThread != nullptr) {
-		assert(currentWorkerThread->getTask() != nullptr);
+	// Worker threads also run the polling services while they are idle, and those may spawn functions
+	if ((currentWorkerThread != nullptr) && (currentWorkerThread->getTask() != nullptr)) {
 		parent = currentWorkerThread->getTask();
 		assert(parent != nullptr);
 		
@@ -110,11 +111,17 @@ void nanos6_submit_task(void *taskHandle)
 	
 	bool isIf0 = task->isIf0();
 	
+	// The runtime may also decide to run a ready child inline, as if it were an if0 task
+	if (ready && !isIf0 && (parent != nullptr) && GranularityCutoff::mustRunInline(task)) {
+		task->setIf0(true);
+		isIf0 = true;
+	}
+	
 	if (ready && !isIf0) {
 		// Queue the task if ready but not if0
 		SchedulerInterface::ReadyTaskHint schedulingHint = SchedulerInterface::NO_HINT;
 		
-		if (currentWorkerThread != nullptr) {
+		if (parent != nullptr) {
 			schedulingHint = SchedulerInterface::CHILD_TASK_HINT;
 		}
 		
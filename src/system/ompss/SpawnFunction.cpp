@@ -92,6 +92,8 @@ void nanos6_spawn_function(void (*function)(void *), void *args, void (*completi
 			taskInfo->implementations[0].task_label = it->first.second.c_str();
 			taskInfo->implementations[0].declaration_source = "Spawned Task";
 			taskInfo->implementations[0].get_constraints = nullptr;
+			
+			nanos6_register_task_info(taskInfo);
 		}
 	}
 	
@@ -0,0 +1,19 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include <nanos6.h>
+
+#include <InstrumentAddTask.hpp>
+
+#include <cassert>
+
+
+void nanos6_register_task_info(nanos6_task_info_t *task_info)
+{
+	assert(task_info != nullptr);
+	
+	Instrument::registeredNewTaskType(task_info);
+}
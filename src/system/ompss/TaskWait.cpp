@@ -14,11 +14,54 @@
 #include "tasks/TaskImplementation.hpp"
 
 #include "hardware/HardwareInfo.hpp"
+#include "lowlevel/SpinLock.hpp"
+
+#include <ClusterDirectory.hpp>
 
 #include <InstrumentTaskWait.hpp>
 #include <InstrumentTaskStatus.hpp>
 
 #include <cassert>
+#include <map>
+#include <mutex>
+#include <string>
+
+
+//! The partial taskwaits are if0 children without code whose accesses are the ones to wait for
+struct TaskwaitOnArgsBlock {
+	void (*_registerDepinfo)(void *, void *);
+	void *_args;
+};
+
+static void nanos6_taskwait_on_register_depinfo(void *args, void *handler)
+{
+	TaskwaitOnArgsBlock *argsBlock = (TaskwaitOnArgsBlock *) args;
+	assert(argsBlock != nullptr);
+	
+	argsBlock->_registerDepinfo(argsBlock->_args, handler);
+}
+
+static nanos6_task_info_t *createTaskwaitOnInfo()
+{
+	nanos6_task_info_t *taskInfo = new nanos6_task_info_t();
+	taskInfo->implementations = new nanos6_task_implementation_info_t();
+	taskInfo->implementation_count = 1;
+	taskInfo->implementations[0].run = nullptr;
+	taskInfo->implementations[0].device_type_id = nanos6_device_t::nanos6_host_device;
+	taskInfo->implementations[0].task_label = "taskwait on";
+	taskInfo->implementations[0].declaration_source = "Partial taskwait";
+	taskInfo->implementations[0].get_constraints = nullptr;
+	taskInfo->register_depinfo = nanos6_taskwait_on_register_depinfo;
+	taskInfo->destroy_args_block = nullptr;
+	
+	nanos6_register_task_info(taskInfo);
+	
+	return taskInfo;
+}
+
+//! The invocation information must outlive the tasks, so it is kept for each invocation source
+static SpinLock _taskwaitOnInvocationInfosLock;
+static std::map<std::string, nanos6_task_invocation_info_t> _taskwaitOnInvocationInfos;
 
 
 
@@ -40,6 +83,10 @@ void nanos6_taskwait(__attribute__((unused)) char const *invocationSource)
 		// This in combination with a release from the children makes their changes visible to this thread
 		std::atomic_thread_fence(std::memory_order_acquire);
 		
+		if (currentTask->getParent() == nullptr) {
+			ClusterDirectory::invalidateAll();
+		}
+		
 		Instrument::exitTaskWait(currentTask->getInstrumentationTaskId());
 		
 		return;
@@ -78,9 +125,66 @@ void nanos6_taskwait(__attribute__((unused)) char const *invocationSource)
 	
 	DataAccessRegistration::handleExitTaskwait(currentTask, currentThread->getComputePlace());
 	
+	// Top level tasks may write the data of the cluster after a taskwait without any task
+	if (currentTask->getParent() == nullptr) {
+		ClusterDirectory::invalidateAll();
+	}
+	
 	if (!done && (currentThread != nullptr)) {
 		// The instrumentation was notified that the task had been blocked
 		Instrument::taskIsExecuting(currentTask->getInstrumentationTaskId());
 	}
 }
 
+
+void nanos6_taskwait_on(void (*register_depinfo)(void *args_block, void *handler), void *args_block, char const *invocationSource)
+{
+	assert(register_depinfo != nullptr);
+	
+	WorkerThread *currentThread = WorkerThread::getCurrentWorkerThread();
+	assert(currentThread != nullptr);
+	
+	Task *currentTask = currentThread->getTask();
+	assert(currentTask != nullptr);
+	
+	// Without children there is nothing to wait for
+	if (currentTask->doesNotNeedToBlockForChildren()) {
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return;
+	}
+	
+	static nanos6_task_info_t *taskInfo = createTaskwaitOnInfo();
+	
+	nanos6_task_invocation_info_t *invocationInfo;
+	{
+		std::string source(invocationSource != nullptr ? invocationSource : "");
+		
+		std::lock_guard<SpinLock> guard(_taskwaitOnInvocationInfosLock);
+		auto itAndBool = _taskwaitOnInvocationInfos.emplace(source, nanos6_task_invocation_info_t());
+		invocationInfo = &itAndBool.first->second;
+		if (itAndBool.second) {
+			invocationInfo->invocation_source = itAndBool.first->first.c_str();
+		}
+	}
+	
+	TaskwaitOnArgsBlock *argsBlock = nullptr;
+	Task *task = nullptr;
+	
+	nanos6_create_task(taskInfo, invocationInfo, sizeof(TaskwaitOnArgsBlock), (void **) &argsBlock, (void **) &task, nanos6_if_0_task);
+	assert(argsBlock != nullptr);
+	assert(task != nullptr);
+	
+	argsBlock->_registerDepinfo = register_depinfo;
+	argsBlock->_args = args_block;
+	
+	// The submission returns once the accesses of the task are satisfied
+	nanos6_submit_task(task);
+	
+	// This in combination with a release from the children makes their changes visible to this thread
+	std::atomic_thread_fence(std::memory_order_acquire);
+	
+	// Top level tasks may write the data of the cluster after a taskwait without any task
+	if (currentTask->getParent() == nullptr) {
+		ClusterDirectory::invalidateAll();
+	}
+}
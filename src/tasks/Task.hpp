@@ -25,6 +25,7 @@ struct DataAccess;
 struct DataAccessBase;
 class WorkerThread;
 class ComputePlace;
+class ClusterNode;
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic error "-Wunused-result"
@@ -90,6 +91,9 @@ private:
 	//! Number of internal and external events that prevent the release of dependencies
 	std::atomic<int> _countdownToRelease;
 	
+	//! Cluster node where the task has been offloaded, nullptr if it runs locally
+	ClusterNode *_clusterNode;
+	
 public:
 	inline Task(
 		void *argsBlock,
@@ -305,7 +309,7 @@ public:
 	//! \brief Indicates whether it has finished
 	inline bool hasFinished()
 	{
-		if (_taskInfo->implementations[0].device_type_id) {
+		if (_taskInfo->implementations[0].device_type_id || isOffloaded()) {
 			return (_computePlace == nullptr);
 		} else {
 			return (_thread == nullptr);
@@ -496,6 +500,25 @@ public:
 	{
 		_deviceData = deviceData;	
 	}
+	
+	//! \brief Mark the task as executed by a remote cluster node
+	//!
+	//! Offloaded tasks keep the remote node as their compute place until they finish
+	inline void setOffloaded(ClusterNode *clusterNode)
+	{
+		_clusterNode = clusterNode;
+	}
+	
+	//! \brief Indicates whether the task is executed by a remote cluster node
+	inline bool isOffloaded() const
+	{
+		return (_clusterNode != nullptr);
+	}
+	
+	inline ClusterNode *getClusterNode() const
+	{
+		return _clusterNode;
+	}
 };
 
 
@@ -38,7 +38,8 @@ inline Task::Task(
 	_instrumentationTaskId(instrumentationTaskId),
 	_schedulerInfo(nullptr),
 	_computePlace(nullptr),
-	_countdownToRelease(1)
+	_countdownToRelease(1),
+	_clusterNode(nullptr)
 {
 	if (parent != nullptr) {
 		parent->addChild(this);
@@ -51,7 +52,7 @@ inline bool Task::markAsFinished(ComputePlace *computePlace)
 	
 	// Non-runnable taskloops should avoid these checks
 	if (isRunnable()) {
-		if (_taskInfo->implementations[0].device_type_id == nanos6_device_t::nanos6_host_device) {
+		if ((_taskInfo->implementations[0].device_type_id == nanos6_device_t::nanos6_host_device) && !isOffloaded()) {
 			assert(_thread != nullptr);
 			_thread = nullptr;
 		} else {
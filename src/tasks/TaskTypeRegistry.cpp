@@ -0,0 +1,27 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "TaskTypeRegistry.hpp"
+
+
+TaskTypeRegistry::Slot TaskTypeRegistry::_table[table_size];
+std::atomic<nanos6_task_info_t const *> TaskTypeRegistry::_taskInfos[max_task_types];
+std::atomic<size_t> TaskTypeRegistry::_count(0);
+
+
+size_t TaskTypeRegistry::assignIndex(Slot &slot, nanos6_task_info_t const *taskInfo)
+{
+	size_t index = _count.fetch_add(1, std::memory_order_relaxed);
+	if (index >= max_task_types) {
+		slot._indexPlusOne.store(invalid_index + 1, std::memory_order_release);
+		return invalid_index;
+	}
+	
+	_taskInfos[index].store(taskInfo, std::memory_order_release);
+	slot._indexPlusOne.store(index + 1, std::memory_order_release);
+	
+	return index;
+}
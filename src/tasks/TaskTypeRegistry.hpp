@@ -0,0 +1,112 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#ifndef TASK_TYPE_REGISTRY_HPP
+#define TASK_TYPE_REGISTRY_HPP
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <nanos6.h>
+
+
+//! \brief Assigns consecutive indexes to the task types
+//!
+//! Task types are normally registered through nanos6_register_task_info,
+//! but any type that reaches the runtime without having been registered is
+//! added on its first lookup. Both operations are lock-free. The types that
+//! do not fit get invalid_index.
+class TaskTypeRegistry {
+public:
+	enum registry_constants_t {
+		max_task_types = 4096,
+		invalid_index = max_task_types,
+		table_size = 2 * max_task_types
+	};
+
+private:
+	struct Slot {
+		std::atomic<nanos6_task_info_t const *> _taskInfo;
+		
+		//! \brief The index plus one, or zero if it has not been assigned yet
+		std::atomic<size_t> _indexPlusOne;
+	};
+	
+	static Slot _table[table_size];
+	static std::atomic<nanos6_task_info_t const *> _taskInfos[max_task_types];
+	static std::atomic<size_t> _count;
+	
+	static inline size_t getSlot(nanos6_task_info_t const *taskInfo)
+	{
+		uint64_t value = (uint64_t) (uintptr_t) taskInfo;
+		
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdULL;
+		value ^= value >> 33;
+		
+		return value & (table_size - 1);
+	}
+	
+	static inline size_t waitForIndex(Slot &slot)
+	{
+		size_t indexPlusOne;
+		while ((indexPlusOne = slot._indexPlusOne.load(std::memory_order_acquire)) == 0) {
+			// Another thread is registering the same type
+		}
+		
+		return indexPlusOne - 1;
+	}
+	
+	static size_t assignIndex(Slot &slot, nanos6_task_info_t const *taskInfo);
+
+public:
+	//! \brief Get the index of a task type and register it if necessary
+	static inline size_t getIndex(nanos6_task_info_t const *taskInfo)
+	{
+		size_t position = getSlot(taskInfo);
+		
+		while (true) {
+			Slot &slot = _table[position];
+			
+			nanos6_task_info_t const *current = slot._taskInfo.load(std::memory_order_acquire);
+			if (current == taskInfo) {
+				return waitForIndex(slot);
+			}
+			
+			if (current == nullptr) {
+				if (slot._taskInfo.compare_exchange_strong(current, taskInfo, std::memory_order_acq_rel)) {
+					return assignIndex(slot, taskInfo);
+				} else if (current == taskInfo) {
+					return waitForIndex(slot);
+				}
+			}
+			
+			position = (position + 1) & (table_size - 1);
+		}
+	}
+	
+	//! \brief Get the number of indexes assigned so far
+	static inline size_t getCount()
+	{
+		size_t count = _count.load(std::memory_order_acquire);
+		return (count < max_task_types ? count : (size_t) max_task_types);
+	}
+	
+	//! \brief Get the task type of an index, or null if its registration has not completed
+	static inline nanos6_task_info_t const *getTaskInfo(size_t index)
+	{
+		if (index >= max_task_types) {
+			return nullptr;
+		}
+		
+		return _taskInfos[index].load(std::memory_order_acquire);
+	}
+};
+
+
+#endif // TASK_TYPE_REGISTRY_HPP
@@ -0,0 +1,94 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "TestAnyProtocolProducer.hpp"
+#include "instrument/stats/LatencyHistogram.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+
+using Instrument::Stats::LatencyHistogram;
+
+
+static std::string percentilesToString(LatencyHistogram const &histogram) {
+	std::ostringstream oss;
+	
+	oss << "count " << histogram.getTotalCount()
+		<< " p50 " << histogram.getValueAtPercentile(50.0)
+		<< " p90 " << histogram.getValueAtPercentile(90.0)
+		<< " p99 " << histogram.getValueAtPercentile(99.0)
+		<< " p99.9 " << histogram.getValueAtPercentile(99.9)
+		<< " max " << histogram.getMax();
+	
+	return oss.str();
+}
+
+
+//! \brief Check that the reported value is not below the real one and within the resolution of the histogram
+static bool isWithinResolution(uint64_t reported, uint64_t expected) {
+	return (reported >= expected) && (reported - expected <= expected / LatencyHistogram::sub_buckets);
+}
+
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char **argv) {
+	TestAnyProtocolProducer tap;
+	
+	tap.registerNewTests(11);
+	tap.begin();
+	
+	LatencyHistogram histogram;
+	
+	// 1
+	tap.evaluate((histogram.getTotalCount() == 0) && (histogram.getValueAtPercentile(50.0) == 0), "an empty histogram reports zero");
+	
+	// 2
+	for (uint64_t value = 0; value < LatencyHistogram::sub_buckets; value++) {
+		histogram.record(value);
+	}
+	tap.evaluate(histogram.getValueAtPercentile(50.0) == LatencyHistogram::sub_buckets / 2 - 1, "small values are counted exactly");
+	tap.emitDiagnostic(percentilesToString(histogram));
+	
+	// 3 to 7
+	LatencyHistogram uniform;
+	for (uint64_t value = 1; value <= 100000; value++) {
+		uniform.record(value * 1000);
+	}
+	tap.emitDiagnostic(percentilesToString(uniform));
+	tap.evaluate(uniform.getTotalCount() == 100000, "all the values have been counted");
+	tap.evaluate(isWithinResolution(uniform.getValueAtPercentile(50.0), 50000000), "the median is within the resolution");
+	tap.evaluate(isWithinResolution(uniform.getValueAtPercentile(99.0), 99000000), "the 99th percentile is within the resolution");
+	tap.evaluate(isWithinResolution(uniform.getValueAtPercentile(99.9), 99900000), "the 99.9th percentile is within the resolution");
+	tap.evaluate(uniform.getValueAtPercentile(100.0) == uniform.getMax(), "the 100th percentile is the maximum");
+	
+	// 8
+	LatencyHistogram tail;
+	for (int i = 0; i < 999; i++) {
+		tail.record(1000);
+	}
+	tail.record(5000000);
+	tap.emitDiagnostic(percentilesToString(tail));
+	tap.evaluate((tail.getValueAtPercentile(99.0) < 1100) && (tail.getValueAtPercentile(99.9) < 1100) && (tail.getMax() == 5000000),
+		"a single outlier only shows in the maximum");
+	
+	// 9 and 10
+	LatencyHistogram merged;
+	merged += histogram;
+	merged += tail;
+	tap.emitDiagnostic(percentilesToString(merged));
+	tap.evaluate(merged.getTotalCount() == histogram.getTotalCount() + tail.getTotalCount(), "merging adds the counts");
+	tap.evaluate(merged.getMax() == tail.getMax(), "merging keeps the highest maximum");
+	
+	// 11
+	LatencyHistogram huge;
+	huge.record(UINT64_MAX);
+	tap.evaluate((huge.getTotalCount() == 1) && (huge.getValueAtPercentile(50.0) == UINT64_MAX), "values beyond the range are kept in the last bucket");
+	
+	tap.end();
+	
+	return 0;
+}
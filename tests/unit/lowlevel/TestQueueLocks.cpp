@@ -0,0 +1,116 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "TestAnyProtocolProducer.hpp"
+#include "lowlevel/CohortLock.hpp"
+#include "lowlevel/MCSLock.hpp"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+#ifdef LESS_TEST_THREADS
+static const int num_threads = 2;
+#else
+static const int num_threads = 4;
+#endif
+
+static const long increments_per_thread = 10000;
+
+
+//! \brief Increment a counter that is only protected by the lock from several threads
+template <typename LOCK_T>
+static long incrementConcurrently(LOCK_T &lock)
+{
+	volatile long counter = 0;
+	
+	std::vector<std::thread> threads;
+	for (int i = 0; i < num_threads; i++) {
+		threads.emplace_back(
+			[&]() {
+				for (long j = 0; j < increments_per_thread; j++) {
+					lock.lock();
+					counter = counter + 1;
+					lock.unlock();
+				}
+			}
+		);
+	}
+	
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	
+	return counter;
+}
+
+
+//! \brief Alternate tryLock and lock from several threads
+template <typename LOCK_T>
+static long tryIncrementConcurrently(LOCK_T &lock)
+{
+	volatile long counter = 0;
+	
+	std::vector<std::thread> threads;
+	for (int i = 0; i < num_threads; i++) {
+		threads.emplace_back(
+			[&]() {
+				for (long j = 0; j < increments_per_thread; j++) {
+					if (!lock.tryLock()) {
+						lock.lock();
+					}
+					counter = counter + 1;
+					lock.unlock();
+				}
+			}
+		);
+	}
+	
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	
+	return counter;
+}
+
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char **argv) {
+	TestAnyProtocolProducer tap;
+	
+	tap.registerNewTests(8);
+	tap.begin();
+	
+	std::ostringstream oss;
+	oss << num_threads << " threads increment a counter " << increments_per_thread << " times each";
+	tap.emitDiagnostic(oss.str());
+	
+	long expected = num_threads * increments_per_thread;
+	
+	// 1 to 3
+	MCSLock mcsLock;
+	tap.evaluate(mcsLock.tryLock(), "an MCS lock can be acquired when free");
+	tap.evaluate(!mcsLock.tryLock(), "an MCS lock cannot be acquired twice");
+	mcsLock.unlock();
+	tap.evaluate(incrementConcurrently(mcsLock) == expected, "an MCS lock provides mutual exclusion");
+	
+	// 4
+	tap.evaluate(tryIncrementConcurrently(mcsLock) == expected, "an MCS lock provides mutual exclusion with tryLock");
+	
+	// 5 to 7
+	CohortLock<> cohortLock;
+	tap.evaluate(cohortLock.tryLock(), "a cohort lock can be acquired when free");
+	tap.evaluate(!cohortLock.tryLock(), "a cohort lock cannot be acquired twice");
+	cohortLock.unlock();
+	tap.evaluate(incrementConcurrently(cohortLock) == expected, "a cohort lock provides mutual exclusion");
+	
+	// 8
+	tap.evaluate(tryIncrementConcurrently(cohortLock) == expected, "a cohort lock provides mutual exclusion with tryLock");
+	
+	tap.end();
+	
+	return 0;
+}
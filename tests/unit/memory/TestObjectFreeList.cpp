@@ -0,0 +1,114 @@
+/*
+	This file is part of Nanos6 and is licensed under the terms contained in the COPYING file.
+	
+	Copyright (C) 2018 Barcelona Supercomputing Center (BSC)
+*/
+
+#include "TestAnyProtocolProducer.hpp"
+#include "memory/allocator/pool/ObjectFreeList.hpp"
+
+#include <set>
+
+
+struct Object {
+	void *_contents[4];
+};
+
+
+//! \brief Pop all the objects of a list and check that they are the expected ones
+static bool containsExactly(ObjectFreeList<Object> &list, std::set<Object *> expected)
+{
+	size_t size = list.size();
+	if (size != expected.size()) {
+		return false;
+	}
+	
+	for (size_t i = 0; i < size; i++) {
+		if (expected.erase(list.pop()) != 1) {
+			return false;
+		}
+	}
+	
+	return list.empty();
+}
+
+
+int main(__attribute__((unused)) int argc, __attribute__((unused)) char **argv) {
+	TestAnyProtocolProducer tap;
+	
+	tap.registerNewTests(9);
+	tap.begin();
+	
+	Object objects[16];
+	
+	// 1
+	ObjectFreeList<Object> list;
+	tap.evaluate(list.empty() && (list.size() == 0), "a new list is empty");
+	
+	// 2
+	for (Object &object : objects) {
+		list.push(&object);
+	}
+	tap.evaluate((list.size() == 16) && (list.pop() == &objects[15]), "the objects are reused in LIFO order");
+	list.push(&objects[15]);
+	
+	// 3
+	ObjectFreeList<Object> other;
+	tap.evaluate((list.moveTo(other, 4) == 4) && (list.size() == 12) && (other.size() == 4), "a number of objects can be moved to another list");
+	
+	// 4
+	tap.evaluate((list.moveTo(other, 100) == 12) && list.empty() && (other.size() == 16), "moving more objects than available moves them all");
+	
+	// 5
+	list.splice(other);
+	tap.evaluate((list.size() == 16) && other.empty(), "a list can be spliced into an empty one");
+	
+	// 6 and 7
+	while (!list.empty()) {
+		list.pop();
+	}
+	for (Object &object : objects) {
+		list.push(&object);
+	}
+	ObjectFreeList<Object> rest;
+	list.truncate(10, rest);
+	std::set<Object *> newest;
+	std::set<Object *> oldest;
+	for (int i = 0; i < 16; i++) {
+		if (i < 6) {
+			oldest.insert(&objects[i]);
+		} else {
+			newest.insert(&objects[i]);
+		}
+	}
+	tap.evaluate(containsExactly(list, newest), "truncating keeps the objects at the front");
+	tap.evaluate(containsExactly(rest, oldest), "truncating moves the rest of the objects");
+	
+	// 8
+	for (int i = 0; i < 4; i++) {
+		list.push(&objects[i]);
+	}
+	list.truncate(0, rest);
+	tap.evaluate(list.empty() && containsExactly(rest, {&objects[0], &objects[1], &objects[2], &objects[3]}), "truncating to zero moves the whole list");
+	
+	// 9
+	ObjectFreeList<Object> first;
+	ObjectFreeList<Object> second;
+	ObjectFreeList<Object> third;
+	first.push(&objects[0]);
+	first.push(&objects[1]);
+	second.push(&objects[2]);
+	second.push(&objects[3]);
+	third.push(&objects[4]);
+	first.splice(second);
+	third.splice(first);
+	tap.evaluate(
+		first.empty() && second.empty()
+		&& containsExactly(third, {&objects[0], &objects[1], &objects[2], &objects[3], &objects[4]}),
+		"splicing non-empty lists keeps all the objects"
+	);
+	
+	tap.end();
+	
+	return 0;
+}